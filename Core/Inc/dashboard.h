@@ -0,0 +1,89 @@
+/**
+  ******************************************************************************
+  * @file           : dashboard.h
+  * @brief          : Bố cục và nội dung màn hình OLED (không dùng HAL)
+  * @created        : Oct 18, 2026
+  * @author         : NguyenHoa
+  * @version        : 1.0.1
+  ******************************************************************************
+  * Chỉ vẽ vào screenbuffer của ssd1306 qua các widget, không gửi gì ra bus:
+  * main.c lo nhịp vẽ và flush DMA, tools/host dựng lại đúng màn hình này
+  * trên máy tính để so với ảnh mẫu.
+  ******************************************************************************
+  */
+
+#ifndef INC_DASHBOARD_H_
+#define INC_DASHBOARD_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "ssd1306.h"
+#include "ssd1306_widgets.h"
+
+/* Version defines -----------------------------------------------------------*/
+#define DASH_VER_MAJOR 1
+#define DASH_VER_MINOR 0
+#define DASH_VER_PATCH 1
+
+/* Exported constants --------------------------------------------------------*/
+/* Đồ thị xu hướng: một điểm mỗi 4 giây, 63 cột ~ 4 phút gần nhất */
+#define DASH_TREND_GAS_DECIMATION 4    // MQ2 đọc mỗi 1 giây -> trung bình 4 mẫu
+#define DASH_TREND_TEMP_DECIMATION 2   // DHT11 đọc mỗi 2 giây -> trung bình 2 mẫu
+#define DASH_TREND_GAS_MAX 1000        // Thang đồ thị gas 0..1000 ppm
+#define DASH_TREND_TEMP_MAX 500        // Thang đồ thị nhiệt độ 0..50.0 C (x10)
+
+/* Phần màn hình cần vẽ lại, xem DASH_Render */
+#define DASH_EVENT_CLIMATE 0x01   // DHT11 có kết quả đọc mới (kể cả lỗi)
+#define DASH_EVENT_GAS 0x02       // MQ2 có kết quả đọc mới
+#define DASH_EVENT_ALARM 0x04     // Mức cảnh báo gas hoặc trạng thái MQ2 đổi
+#define DASH_EVENT_ALL (DASH_EVENT_CLIMATE | DASH_EVENT_GAS | DASH_EVENT_ALARM)
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+    DASH_CLIMATE_INIT = 0,      // Chưa có lần đọc DHT11 dùng được
+    DASH_CLIMATE_OK,
+    DASH_CLIMATE_ERROR          // Lần đọc gần nhất lỗi
+} DASH_ClimateState;
+
+/* Giá trị cần hiển thị, main.c lấy từ các biến cảm biến */
+typedef struct {
+    DASH_ClimateState Climate;
+    float Temperature;          // °C
+    float Humidity;             // %
+    uint8_t GasOk;              // 0: MQ2 chưa hiệu chuẩn hoặc lỗi, hiện "Cal..."
+    float Gas;                  // ppm
+    uint8_t GasLevel;           // Theo thứ tự MQ2_GasLevelTypeDef: 0 bình thường, 1 cảnh báo, 2 nguy hiểm
+} DASH_Readings;
+
+typedef struct {
+    SSD1306_Widget_t TempLabel;
+    SSD1306_Widget_t HumLabel;
+    SSD1306_Widget_t GasLabel;
+    SSD1306_ValueWidget_t TempValue;
+    SSD1306_ValueWidget_t HumValue;
+    SSD1306_ValueWidget_t GasValue;
+    SSD1306_MarkerWidget_t GasMarker;
+
+    /* Lịch sử và đồ thị xu hướng ở y = 40..63: gas bên trái, nhiệt độ bên phải */
+    SSD1306_History_t GasHistory;
+    SSD1306_History_t TempHistory;
+    SSD1306_PlotWidget_t GasPlot;
+    SSD1306_PlotWidget_t TempPlot;
+} DASH_Data;
+
+/* Exported functions prototypes ---------------------------------------------*/
+void DASH_Init(DASH_Data *dash);
+uint8_t DASH_Render(DASH_Data *dash, uint8_t events, const DASH_Readings *readings);
+
+// Trend history
+void DASH_PushTemperature(DASH_Data *dash, float temperature);
+void DASH_PushGas(DASH_Data *dash, float gas);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_DASHBOARD_H_ */
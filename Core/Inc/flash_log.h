@@ -0,0 +1,121 @@
+/**
+  ******************************************************************************
+  * @file           : flash_log.h
+  * @brief          : Nhật ký bản ghi cảm biến trong flash nội, giữ qua mất điện
+  * @created        : Oct 18, 2026
+  * @author         : NguyenHoa
+  * @version        : 1.1.0
+  ******************************************************************************
+  * Firmware chỉ dùng sector 0..6 (STM32F407VGTX_FLASH.ld giới hạn FLASH còn
+  * 384 KB), phần còn lại dành cho nhật ký:
+  *
+  *   Sector 7       0x08060000  128 KB  điểm xác nhận (acked) của ESP
+  *   Sector 8..11   0x08080000  512 KB  bản ghi, dùng xoay vòng
+  *
+  * Sector bản ghi: 16 byte đầu sector + FLOG_SLOTS ô 12 byte. Đầu sector ghi
+  * Seq của ô 0 nên Seq của ô i là FirstSeq + i, ô không cần lưu Seq:
+  *   [0]  uint32  TimeMs
+  *   [4]  int16   TempX10,  [6] uint16 GasPpm
+  *   [8]  uint8   Flags,    [9] uint8  Humidity
+  *   [10] uint16  CRC16 của Seq + 10 byte trên, ghi sau cùng
+  * Ô còn 0xFF là ô trống, sai CRC là ô ghi dở khi mất điện (bỏ qua).
+  *
+  * Sector đầy thì xóa sector kế tiếp theo vòng (sector cũ nhất) nên mỗi
+  * sector bị xóa đều nhau; số lần xóa lưu ở đầu sector. Xóa 128 KB làm CPU
+  * dừng ~1-2 giây, vài giây khi flash đã mòn (đọc flash bị chặn khi đang
+  * xóa), khoảng 2 giờ một lần ở 1.5 bản ghi/giây. FLOG_Prepare xóa sẵn
+  * sector kế tiếp khi sector đang ghi đã đầy 90% để vòng lặp chính chọn
+  * lúc dừng (không có cảnh báo gas); FLOG_Append chỉ tự xóa khi chưa có
+  * dịp đó.
+  *
+  * Sector điểm xác nhận: các cặp (Seq, ~Seq) ghi nối tiếp, cặp hợp lệ cuối
+  * cùng là acked. Chỉ ghi khi acked đã tiến FLOG_CHECKPOINT_RECORDS bản ghi
+  * hoặc đã qua FLOG_CHECKPOINT_INTERVAL, nên sau khi khởi động lại có thể
+  * gửi lại một ít bản ghi ESP đã có (ESP bỏ qua bản ghi trùng).
+  ******************************************************************************
+  */
+
+#ifndef INC_FLASH_LOG_H_
+#define INC_FLASH_LOG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "telemetry.h"
+
+/* Version defines -----------------------------------------------------------*/
+#define FLOG_VER_MAJOR 1
+#define FLOG_VER_MINOR 1
+#define FLOG_VER_PATCH 0
+
+/* Exported constants --------------------------------------------------------*/
+#define FLOG_CHECKPOINT_SECTOR FLASH_SECTOR_7
+#define FLOG_CHECKPOINT_BASE 0x08060000u
+#define FLOG_FIRST_SECTOR FLASH_SECTOR_8
+#define FLOG_BASE 0x08080000u
+#define FLOG_SECTOR_COUNT 4
+#define FLOG_SECTOR_SIZE 0x20000u  // 128 KB
+
+#define FLOG_HEADER_SIZE 16
+#define FLOG_SLOT_SIZE 12
+#define FLOG_SLOTS ((FLOG_SECTOR_SIZE - FLOG_HEADER_SIZE) / FLOG_SLOT_SIZE)  // 10921 mỗi sector
+#define FLOG_CAPACITY (FLOG_SLOTS * FLOG_SECTOR_COUNT)  // ~8 giờ ở 1.5 bản ghi/giây
+#define FLOG_CHECKPOINTS (FLOG_SECTOR_SIZE / 8)
+#define FLOG_PREPARE_SLOTS (FLOG_SLOTS * 9 / 10)  // Ô đã ghi thì FLOG_Prepare xóa sẵn sector kế tiếp
+
+#ifndef FLOG_CHECKPOINT_RECORDS
+#define FLOG_CHECKPOINT_RECORDS 256    // Bản ghi xác nhận thêm thì lưu acked
+#endif
+#ifndef FLOG_CHECKPOINT_INTERVAL
+#define FLOG_CHECKPOINT_INTERVAL 60000 // ms, lưu acked ít nhất mỗi phút khi có thay đổi
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    uint32_t Records;           // Bản ghi đã ghi từ khi khởi động
+    uint32_t Erases;            // Sector đã xóa từ khi khởi động
+    uint32_t Checkpoints;       // Lần lưu acked từ khi khởi động
+    uint32_t Overwritten;       // Bản ghi chưa xác nhận mất do xóa sector
+    uint32_t WriteErrors;       // Lỗi ghi/xóa flash
+    uint32_t MaxEraseCount;     // Số lần xóa lớn nhất của một sector bản ghi
+} FLOG_Stats;
+
+typedef struct {
+    FLOG_Stats Stats;
+    // Private members
+    uint32_t _firstSeq[FLOG_SECTOR_COUNT];    // Seq của ô 0 mỗi sector
+    uint32_t _eraseCount[FLOG_SECTOR_COUNT];  // Số lần xóa mỗi sector
+    uint8_t _valid[FLOG_SECTOR_COUNT];        // 1: đầu sector hợp lệ
+    uint8_t _current;                         // Sector đang ghi
+    uint8_t _next;                            // Sector kế tiếp đã xóa sẵn chưa (FLOG_NEXT_*)
+    uint16_t _slot;                           // Ô trống kế tiếp trong sector đang ghi
+    uint32_t _head;                           // Seq của bản ghi kế tiếp
+    uint32_t _acked;                          // Bản ghi đầu ESP chưa xác nhận
+    uint32_t _savedAcked;                     // acked đã lưu trong flash
+    uint32_t _savedTime;                      // HAL_GetTick() lúc lưu acked
+    uint32_t _checkpoint;                     // Cặp trống kế tiếp trong sector điểm xác nhận
+} FLOG_Data;
+
+/* Exported functions prototypes ---------------------------------------------*/
+// Initialization
+void FLOG_Init(FLOG_Data *flog);
+
+// Records
+uint32_t FLOG_Append(FLOG_Data *flog, const TELEM_Record *record);
+uint8_t FLOG_Prepare(FLOG_Data *flog);
+uint8_t FLOG_Read(const FLOG_Data *flog, uint32_t seq, TELEM_Record *record);
+uint32_t FLOG_Head(const FLOG_Data *flog);
+uint32_t FLOG_Oldest(const FLOG_Data *flog);
+
+// Acknowledgement cursor
+void FLOG_SetAcked(FLOG_Data *flog, uint32_t acked, uint32_t currentTime);
+uint32_t FLOG_Acked(const FLOG_Data *flog);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_FLASH_LOG_H_ */
@@ -0,0 +1,55 @@
+/**
+  ******************************************************************************
+  * @file           : fmt.h
+  * @brief          : Định dạng số fixed-point không cấp phát, thay snprintf
+  * @created        : Oct 18, 2026
+  * @author         : NguyenHoa
+  * @version        : 1.0.1
+  ******************************************************************************
+  */
+
+#ifndef INC_FMT_H_
+#define INC_FMT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Version defines -----------------------------------------------------------*/
+#define FMT_VER_MAJOR 1
+#define FMT_VER_MINOR 0
+#define FMT_VER_PATCH 1
+
+/* Exported constants --------------------------------------------------------*/
+#define FMT_MAX_DECIMALS 6         // Số chữ số thập phân tối đa
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    char *Buf;                  // Bộ đệm của người gọi
+    uint16_t Size;              // Kích thước bộ đệm (kể cả '\0')
+    uint16_t Len;               // Số ký tự đã ghi
+    uint8_t Overflow;           // 1 nếu có phần bị cắt vì thiếu chỗ
+} FMT_Buffer;
+
+/* Exported functions prototypes ---------------------------------------------*/
+// Conversion
+int32_t FMT_Scale(float value, uint8_t decimals);
+
+// Single value into a caller buffer
+uint16_t FMT_Fixed(char *buf, uint16_t size, int32_t value, uint8_t decimals, uint8_t width);
+
+// Building a line piece by piece
+void FMT_Init(FMT_Buffer *b, char *buf, uint16_t size);
+void FMT_PutStr(FMT_Buffer *b, const char *str);
+void FMT_PutChar(FMT_Buffer *b, char ch);
+void FMT_PutFixed(FMT_Buffer *b, int32_t value, uint8_t decimals, uint8_t width);
+void FMT_PutUint(FMT_Buffer *b, uint32_t value, uint8_t width);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_FMT_H_ */
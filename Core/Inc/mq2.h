@@ -4,7 +4,7 @@
   * @brief          : Header cho MQ2 gas sensor driver
   * @created        : May 18, 2025
   * @author         : NguyenHoa
-  * @version        : 1.0.0
+  * @version        : 1.2.1
   ******************************************************************************
   */
 
@@ -20,15 +20,16 @@ extern "C" {
 
 /* Version defines -----------------------------------------------------------*/
 #define MQ2_VER_MAJOR 1
-#define MQ2_VER_MINOR 0
-#define MQ2_VER_PATCH 0
+#define MQ2_VER_MINOR 2
+#define MQ2_VER_PATCH 1
 
 /* Exported types ------------------------------------------------------------*/
 typedef enum {
     MQ2_OK = 0,
     MQ2_ERROR,
     MQ2_ADC_TIMEOUT,
-    MQ2_CALIBRATION_ERROR
+    MQ2_CALIBRATION_ERROR,
+    MQ2_BUSY               // Đang hiệu chuẩn (MQ2_CalibrateStart/Step)
 } MQ2_StatusTypeDef;
 
 typedef enum {
@@ -37,6 +38,18 @@ typedef enum {
     MQ2_LEVEL_DANGER       // Mức độ nguy hiểm
 } MQ2_GasLevelTypeDef;
 
+/* Ảnh chụp (snapshot) của mẫu đã xử lý gần nhất */
+typedef struct {
+    float RawValue;              // Giá trị ADC thô của mẫu
+    float Voltage;               // Điện áp (V)
+    float GasConcentration;      // Nồng độ khí gas (ppm)
+    float SmokeConcentration;    // Nồng độ khói (ppm)
+    float LPGConcentration;      // Nồng độ LPG (ppm)
+    MQ2_GasLevelTypeDef Level;   // Mức độ báo động tại thời điểm lấy mẫu
+    uint32_t Timestamp;          // HAL_GetTick() lúc lấy mẫu (ms)
+    uint32_t Sequence;           // Số thứ tự mẫu, 0 = chưa có mẫu nào
+} MQ2_Snapshot;
+
 typedef struct {
     float RawValue;              // Giá trị ADC thô (0-4095)
     float Voltage;               // Điện áp (0-3.3V)
@@ -50,6 +63,12 @@ typedef struct {
     uint32_t _channel;           // Kênh ADC
     float _R0;                   // Giá trị điện trở cảm biến trong không khí sạch
     uint8_t _isCalibrated;       // Trạng thái hiệu chuẩn
+    MQ2_Snapshot _snapshot;      // Mẫu đã xử lý gần nhất
+    uint8_t _isCalibrating;      // Đang hiệu chuẩn từng bước
+    uint8_t _calibSamples;       // Số mẫu hiệu chuẩn đã lấy
+    uint8_t _calibValid;         // Trong đó số mẫu hợp lệ
+    float _calibRsSum;           // Tổng Rs của các mẫu hợp lệ
+    uint32_t _calibLastTime;     // HAL_GetTick() lúc lấy mẫu hiệu chuẩn gần nhất
 } MQ2_Data;
 
 /* Exported constants --------------------------------------------------------*/
@@ -64,6 +83,7 @@ typedef struct {
 #define MQ2_DANGER_THRESHOLD   700         // Ngưỡng nguy hiểm (ppm)
 #define MQ2_RL_VALUE           5.0f        // Giá trị điện trở tải (kΩ)
 #define MQ2_CALIB_SAMPLES      10          // Số mẫu cho hiệu chuẩn
+#define MQ2_CALIB_INTERVAL     100         // Khoảng cách giữa các mẫu hiệu chuẩn (ms)
 #define MQ2_CLEAN_AIR_RATIO    9.83f       // Rs/R0 trong không khí sạch
 
 /* Exported functions prototypes ---------------------------------------------*/
@@ -73,6 +93,8 @@ void MQ2_DeInit(MQ2_Data *mq2);
 
 // Calibration
 MQ2_StatusTypeDef MQ2_Calibrate(MQ2_Data *mq2);
+MQ2_StatusTypeDef MQ2_CalibrateStart(MQ2_Data *mq2, uint32_t currentTime);
+MQ2_StatusTypeDef MQ2_CalibrateStep(MQ2_Data *mq2, uint32_t currentTime);
 void MQ2_SetR0(MQ2_Data *mq2, float r0_value);
 
 // Reading functions
@@ -81,9 +103,10 @@ MQ2_StatusTypeDef MQ2_ReadVoltage(MQ2_Data *mq2);
 MQ2_StatusTypeDef MQ2_ReadGasConcentration(MQ2_Data *mq2);
 MQ2_StatusTypeDef MQ2_ReadAllValues(MQ2_Data *mq2);
 
-// Gas type specific readings
-float MQ2_GetSmokeConcentration(MQ2_Data *mq2);
-float MQ2_GetLPGConcentration(MQ2_Data *mq2);
+// Cached accessors - không chạm ADC, trả về mẫu đã xử lý gần nhất
+MQ2_StatusTypeDef MQ2_GetSnapshot(const MQ2_Data *mq2, MQ2_Snapshot *snapshot);
+float MQ2_GetSmokeConcentration(const MQ2_Data *mq2);
+float MQ2_GetLPGConcentration(const MQ2_Data *mq2);
 
 // Status and control functions
 MQ2_GasLevelTypeDef MQ2_GetGasLevel(MQ2_Data *mq2);
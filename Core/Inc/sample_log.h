@@ -0,0 +1,101 @@
+/**
+  ******************************************************************************
+  * @file           : sample_log.h
+  * @brief          : Bộ đệm vòng lưu mọi lần đọc cảm biến đến khi ESP xác nhận
+  * @created        : Oct 18, 2026
+  * @author         : NguyenHoa
+  * @version        : 1.2.0
+  ******************************************************************************
+  * Mỗi bản ghi có số thứ tự (Seq) tăng dần. Bốn con trỏ trên dãy Seq:
+  *
+  *   acked <= received <= sent <= head
+  *   [acked, received)  ESP đã nhận, chờ ESP đẩy lên server
+  *   [received, sent)   đã gửi, chờ ESP báo đã nhận
+  *   [sent, head)       chưa gửi
+  *
+  * SLOG_NextBatch lấy tối đa TELEM_BATCH_MAX bản ghi từ sent khi đủ một frame
+  * hoặc đã chờ quá chu kỳ gửi. ESP báo bằng SLOG_Ack(NextSeq, ReceivedSeq):
+  * ReceivedSeq ngay khi nhận frame, NextSeq sau khi đã đẩy dữ liệu lên server
+  * (có thể chậm cả phút khi ESP gom điểm trung bình). Chỉ [received, sent)
+  * được gửi lại (go-back-N) khi quá SLOG_RETRY_TIMEOUT không có gì mới được
+  * nhận; bản ghi chỉ được bỏ khi qua acked. Bộ đệm đầy thì ghi đè bản ghi cũ
+  * nhất chưa xác nhận và đếm vào Stats.Overwritten.
+  *
+  * Có nơi lưu lâu dài (reader khác NULL, ví dụ flash_log) thì bộ đệm RAM chỉ
+  * giữ SLOG_CAPACITY bản ghi mới nhất để gửi nhanh, bản ghi cũ hơn đọc lại
+  * qua reader khi gửi bù. Nơi lưu bỏ bản ghi cũ thì báo bằng SLOG_Discard.
+  ******************************************************************************
+  */
+
+#ifndef INC_SAMPLE_LOG_H_
+#define INC_SAMPLE_LOG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "telemetry.h"
+
+/* Version defines -----------------------------------------------------------*/
+#define SLOG_VER_MAJOR 1
+#define SLOG_VER_MINOR 2
+#define SLOG_VER_PATCH 0
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef SLOG_CAPACITY
+#define SLOG_CAPACITY 512          // Bản ghi, lũy thừa của 2; 512 x 12 byte, ~5 phút ở 1.5 bản ghi/giây
+#endif
+#define SLOG_WINDOW (4 * TELEM_BATCH_MAX)  // Bản ghi đã gửi chưa xác nhận tối đa
+#define SLOG_RETRY_TIMEOUT 5000    // ms received không tăng thì gửi lại
+
+#if (SLOG_CAPACITY & (SLOG_CAPACITY - 1)) || SLOG_CAPACITY < SLOG_WINDOW
+#error "SLOG_CAPACITY must be a power of 2, at least SLOG_WINDOW"
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+typedef uint8_t (*SLOG_Reader)(uint32_t seq, TELEM_Record *record);  // 1 nếu đọc được
+
+typedef struct {
+    uint32_t Records;           // Bản ghi đã thêm
+    uint32_t Batches;           // Frame BATCH đã tạo (kể cả gửi lại)
+    uint32_t Retransmits;       // Số lần quá thời gian, gửi lại từ received
+    uint32_t Overwritten;       // Bản ghi chưa xác nhận bị ghi đè vì bộ đệm đầy
+    uint32_t Replayed;          // Bản ghi đã đọc lại qua reader để gửi
+    uint32_t Missing;           // Bản ghi reader không đọc được, gửi bản ghi rỗng
+    uint32_t HighWater;         // Số bản ghi chưa xác nhận lớn nhất từng có
+} SLOG_Stats;
+
+typedef struct {
+    SLOG_Stats Stats;
+    // Private members
+    SLOG_Reader _reader;        // Đọc bản ghi đã rời bộ đệm RAM, NULL nếu không có
+    uint32_t _ramStart;         // Seq của bản ghi cũ nhất trong bộ đệm RAM
+    uint32_t _head;             // Seq của bản ghi kế tiếp
+    uint32_t _sent;             // Seq của bản ghi kế tiếp cần gửi
+    uint32_t _received;         // Seq của bản ghi đầu ESP chưa nhận
+    uint32_t _acked;            // Seq của bản ghi đầu chưa xác nhận
+    uint32_t _lastBatchTime;    // HAL_GetTick() lúc tạo frame gần nhất
+    uint32_t _progressTime;     // Lúc received tăng hoặc bắt đầu chờ ESP nhận
+    TELEM_Record _records[SLOG_CAPACITY];
+} SLOG_Data;
+
+/* Exported functions prototypes ---------------------------------------------*/
+// Initialization
+void SLOG_Init(SLOG_Data *log, uint32_t headSeq, uint32_t ackedSeq, SLOG_Reader reader);
+
+// Recording
+uint32_t SLOG_Append(SLOG_Data *log, const TELEM_Record *record);
+uint32_t SLOG_Pending(const SLOG_Data *log);
+uint32_t SLOG_Oldest(const SLOG_Data *log);
+void SLOG_Discard(SLOG_Data *log, uint32_t oldestSeq);
+
+// Uplink
+uint8_t SLOG_NextBatch(SLOG_Data *log, uint32_t currentTime, uint32_t interval, TELEM_Record *records, uint32_t *firstSeq, uint8_t *batchFlags);
+void SLOG_Ack(SLOG_Data *log, uint32_t nextSeq, uint32_t receivedSeq, uint32_t currentTime);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_SAMPLE_LOG_H_ */
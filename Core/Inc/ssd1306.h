@@ -10,14 +10,28 @@
 
 #include <stddef.h>
 #include <stdint.h>
+
+#if defined(SSD1306_USE_HOST)
+// Host builds use the system C library, which has no newlib <_ansi.h>
+#ifdef __cplusplus
+#define _BEGIN_STD_C extern "C" {
+#define _END_STD_C }
+#else
+#define _BEGIN_STD_C
+#define _END_STD_C
+#endif
+#else
 #include <_ansi.h>
+#endif
 
 _BEGIN_STD_C
 
 #include "ssd1306_conf.h"
 
 
-#if defined(STM32WB)
+#if defined(SSD1306_USE_HOST)
+#include "ssd1306_host.h"
+#elif defined(STM32WB)
 #include "stm32wbxx_hal.h"
 #elif defined(STM32F0)
 #include "stm32f0xx_hal.h"
@@ -69,6 +83,11 @@ _BEGIN_STD_C
 #define SSD1306_I2C_ADDR        (0x3C << 1)
 #endif
 
+// Max time (ms) a blocking call waits for a running DMA flush
+#ifndef SSD1306_DMA_TIMEOUT
+#define SSD1306_DMA_TIMEOUT     100
+#endif
+
 /* ^^^ I2C config ^^^ */
 
 /* vvv SPI config vvv */
@@ -100,12 +119,14 @@ _BEGIN_STD_C
 
 /* ^^^ SPI config ^^^ */
 
-#if defined(SSD1306_USE_I2C)
+#if defined(SSD1306_USE_HOST)
+// No bus handle, writes go to ssd1306_HostWrite
+#elif defined(SSD1306_USE_I2C)
 extern I2C_HandleTypeDef SSD1306_I2C_PORT;
 #elif defined(SSD1306_USE_SPI)
 extern SPI_HandleTypeDef SSD1306_SPI_PORT;
 #else
-#error "You should define SSD1306_USE_SPI or SSD1306_USE_I2C macro!"
+#error "You should define SSD1306_USE_SPI, SSD1306_USE_I2C or SSD1306_USE_HOST macro!"
 #endif
 
 // SSD1306 OLED height in pixels
@@ -130,7 +151,8 @@ typedef enum {
 
 typedef enum {
     SSD1306_OK = 0x00,
-    SSD1306_ERR = 0x01  // Generic error.
+    SSD1306_ERR = 0x01, // Generic error.
+    SSD1306_BUSY = 0x02 // A DMA flush is still in flight.
 } SSD1306_Error_t;
 
 // Struct to store transformations
@@ -146,25 +168,67 @@ typedef struct {
     uint8_t y;
 } SSD1306_VERTEX;
 
+// Struct to store flush statistics
+typedef struct {
+    uint32_t Flushes;           // ssd1306_UpdateScreen calls that sent data
+    uint32_t BytesSent;         // Screenbuffer bytes sent since reset
+    uint32_t BytesAvoided;      // Screenbuffer bytes skipped as unchanged since reset
+    uint16_t LastBytesSent;     // Screenbuffer bytes sent by the last flush
+    uint16_t LastBytesAvoided;  // Screenbuffer bytes skipped by the last flush
+    uint8_t LastSpans;          // Address windows (window + data transfer) of the last flush
+    uint32_t Errors;            // Failed or timed out DMA flushes
+} SSD1306_FlushStats_t;
+
+// Returned by ssd1306_Utf8Next for malformed input (U+FFFD REPLACEMENT CHARACTER)
+#define SSD1306_UTF8_INVALID    0xFFFD
+
 /** Font */
 typedef struct {
 	const uint8_t width;                /**< Font width in pixels */
 	const uint8_t height;               /**< Font height in pixels */
 	const uint16_t *const data;         /**< Pointer to font data array */
     const uint8_t *const char_width;    /**< Proportional character width in pixels (NULL for monospaced) */
+    const uint8_t *const page_data;     /**< Glyphs as page-aligned column bytes (NULL: draw pixel by pixel) */
+    const uint16_t *const codepoints;   /**< Sorted code points of the glyphs (NULL: ASCII 32..126 in order) */
+    const uint16_t glyph_count;         /**< Entries in codepoints */
 } SSD1306_Font_t;
 
 // Procedure definitions
 void ssd1306_Init(void);
 void ssd1306_Fill(SSD1306_COLOR color);
+/**
+ * @brief Sends the changed parts of the screenbuffer to the panel.
+ * @note A full frame (e.g. after ssd1306_Invalidate) is sent as one
+ *       column/page window and a single data transfer.
+ */
 void ssd1306_UpdateScreen(void);
 void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color);
 char ssd1306_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color);
+/**
+ * @brief Draws a UTF-8 string.
+ * @return 0 if all of it was drawn, else the first byte of the character
+ *         that has no glyph in the font or does not fit on the line.
+ */
 char ssd1306_WriteString(char* str, SSD1306_Font_t Font, SSD1306_COLOR color);
+/**
+ * @brief Decodes the next character of a UTF-8 string and steps over it.
+ * @return The code point, 0 at the end of the string (str is not moved),
+ *         SSD1306_UTF8_INVALID for bytes that are not UTF-8 or beyond U+FFFF.
+ */
+uint16_t ssd1306_Utf8Next(const char** str);
 void ssd1306_SetCursor(uint8_t x, uint8_t y);
+uint8_t ssd1306_GetCursorX(void);
 void ssd1306_Line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
 void ssd1306_DrawArc(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color);
 void ssd1306_DrawArcWithRadiusLine(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color);
+
+/**
+ * @brief Point on a circle, without floating point math
+ * @param angle Degrees from the bottom of the circle, as in ssd1306_DrawArc
+ * @param[out] px X coordinate of the point
+ * @param[out] py Y coordinate of the point
+ */
+void ssd1306_GetArcPoint(uint8_t x, uint8_t y, uint8_t radius, uint16_t angle, uint8_t* px, uint8_t* py);
 void ssd1306_DrawCircle(uint8_t par_x, uint8_t par_y, uint8_t par_r, SSD1306_COLOR color);
 void ssd1306_FillCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR par_color);
 void ssd1306_Polyline(const SSD1306_VERTEX *par_vertex, uint16_t par_size, SSD1306_COLOR color);
@@ -182,8 +246,35 @@ void ssd1306_FillRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD13
  */
 SSD1306_Error_t ssd1306_InvertRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
 
+/**
+ * @brief Draw a vertical line from y1 to y2 (inclusive), a page at a time
+ */
+void ssd1306_DrawVLine(uint8_t x, uint8_t y1, uint8_t y2, SSD1306_COLOR color);
+
+/**
+ * @brief Shift a page-aligned region of the screenbuffer to the left
+ *
+ * @param x1 First column of the region
+ * @param x2 Last column of the region
+ * @param page1 First page (8px row) of the region
+ * @param page2 Last page of the region
+ * @param count Number of columns to shift; the freed columns on the right are cleared
+ */
+void ssd1306_ScrollColumnsLeft(uint8_t x1, uint8_t x2, uint8_t page1, uint8_t page2, uint8_t count);
+
 void ssd1306_DrawBitmap(uint8_t x, uint8_t y, const unsigned char* bitmap, uint8_t w, uint8_t h, SSD1306_COLOR color);
 
+/**
+ * @brief Draw a bitmap stored in the panel's page format
+ *
+ * @param pages ceil(h / 8) bands of w column bytes, bit 0 is the top row of
+ *        a band (tools/ssd1306_bitmap_pages.py converts images to it)
+ * @param color White draws the bitmap as is, Black inverted
+ * @note Unlike ssd1306_DrawBitmap the whole w x h box is overwritten.
+ *       With y a multiple of 8 and White every band is a memcpy.
+ */
+void ssd1306_DrawBitmapPaged(uint8_t x, uint8_t y, const uint8_t* pages, uint8_t w, uint8_t h, SSD1306_COLOR color);
+
 /**
  * @brief Sets the contrast of the display.
  * @param[in] value contrast to set.
@@ -205,9 +296,58 @@ void ssd1306_SetDisplayOn(const uint8_t on);
  */
 uint8_t ssd1306_GetDisplayOn();
 
+/**
+ * @brief Marks the whole screenbuffer as changed.
+ * @note ssd1306_UpdateScreen only sends the columns of each page that were
+ *       touched by the drawing procedures and differ from what the panel
+ *       shows; call this to force a full refresh.
+ */
+void ssd1306_Invalidate(void);
+
+/**
+ * @brief Returns the screenbuffer, SSD1306_BUFFER_SIZE bytes in page order.
+ * @note Writes through this pointer are not tracked, call
+ *       ssd1306_Invalidate afterwards.
+ */
+uint8_t* ssd1306_GetBuffer(void);
+
+/**
+ * @brief Reads the flush statistics.
+ * @param[out] stats bytes sent and bytes avoided by dirty tracking.
+ */
+void ssd1306_GetFlushStats(SSD1306_FlushStats_t* stats);
+void ssd1306_ResetFlushStats(void);
+
+#if defined(SSD1306_USE_DMA)
+/**
+ * @brief Starts sending the changed parts of the screenbuffer over DMA.
+ * @return SSD1306_BUSY if the previous flush is still in flight.
+ * @note The changes are copied to a front buffer first, so drawing may
+ *       continue right away. ssd1306_FlushCpltCallback is called from the
+ *       interrupt once the bus is free.
+ */
+SSD1306_Error_t ssd1306_UpdateScreenAsync(void);
+uint8_t ssd1306_IsBusy(void);
+
+/**
+ * @brief Bus event hooks, call them from HAL_I2C_MemTxCpltCallback and
+ *        HAL_I2C_ErrorCallback for the display's I2C handle, or from
+ *        HAL_SPI_TxCpltCallback and HAL_SPI_ErrorCallback on SPI.
+ */
+void ssd1306_DMA_TxCplt(void);
+void ssd1306_DMA_Error(void);
+
+/**
+ * @brief Called from interrupt context when a DMA flush has finished.
+ * @note Weak, override it to get notified.
+ */
+void ssd1306_FlushCpltCallback(void);
+#endif
+
 // Low-level procedures
 void ssd1306_Reset(void);
 void ssd1306_WriteCommand(uint8_t byte);
+void ssd1306_WriteCommands(const uint8_t* cmds, size_t count);
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size);
 SSD1306_Error_t ssd1306_FillBuffer(uint8_t* buf, uint32_t len);
 
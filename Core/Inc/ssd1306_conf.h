@@ -6,6 +6,11 @@
 #ifndef __SSD1306_CONF_H__
 #define __SSD1306_CONF_H__
 
+// Building with -DSSD1306_USE_HOST replaces the MCU and the bus by an
+// emulated panel on the PC (see ssd1306_host.h); the rest of this file
+// still applies.
+#if !defined(SSD1306_USE_HOST)
+
 // Choose a microcontroller family
 //#define STM32F0
 //#define STM32F1
@@ -27,7 +32,20 @@
 #define SSD1306_I2C_PORT        hi2c1
 #define SSD1306_I2C_ADDR        (0x3C << 1)
 
+// Non-blocking flush with ssd1306_UpdateScreenAsync.
+// I2C: needs a TX DMA stream linked to the I2C handle (I2C1_TX: DMA1 Stream6)
+// and the I2C event/error interrupts enabled.
+// SPI: needs a TX DMA stream linked to the SPI handle (SPI1_TX: DMA2 Stream3
+// Channel 3) and the SPI interrupt enabled; CS is driven by software.
+#define SSD1306_USE_DMA
+
+#endif // !SSD1306_USE_HOST
+
 // SPI Configuration
+// 4-wire SPI, mode 0, MSB first, TX only. The SSD1306 takes SCK up to
+// 10 MHz: SPI1 on APB2 = 84 MHz with prescaler 8 gives 10.5 MHz and a
+// full frame in about 0.8 ms. With APB2 = 8 MHz as in this project the
+// maximum is 4 MHz (prescaler 2), about 2.1 ms per frame.
 //#define SSD1306_SPI_PORT        hspi1
 //#define SSD1306_CS_Port         OLED_CS_GPIO_Port
 //#define SSD1306_CS_Pin          OLED_CS_Pin
@@ -53,6 +71,9 @@
 
 #define SSD1306_INCLUDE_FONT_16x15
 
+// Subset fonts from tools/ssd1306_font_subset.py
+#define SSD1306_INCLUDE_FONT_7x10_DASH
+
 // The width of the screen can be set using this
 // define. The default value is 128.
 #define SSD1306_WIDTH           128
@@ -25,5 +25,11 @@ extern const SSD1306_Font_t Font_16x24;
 */
 extern const SSD1306_Font_t Font_16x15;
 #endif
+#ifdef SSD1306_INCLUDE_FONT_7x10_DASH
+/** Font_7x10 cut down to the dashboard characters, with Vietnamese letters.
+ * Generated by tools/ssd1306_font_subset.py from tools/fonts/dashboard.txt
+*/
+extern const SSD1306_Font_t Font_7x10_Dash;
+#endif
 
 #endif // __SSD1306_FONTS_H__
@@ -0,0 +1,71 @@
+/**
+ * Host backend for the SSD1306 library.
+ *
+ * Build ssd1306.c, ssd1306_fonts*.c, ssd1306_host.c (and whatever uses them,
+ * e.g. ssd1306_tests.c or ssd1306_widgets.c) with -DSSD1306_USE_HOST to run
+ * the graphics code on a PC. The bus calls land in an emulated panel RAM
+ * instead of I2C/SPI, and are counted as the I2C bus would carry them.
+ */
+
+#ifndef __SSD1306_HOST_H__
+#define __SSD1306_HOST_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Bytes of framing per transaction: I2C address + control byte
+#ifndef SSD1306_HOST_BUS_OVERHEAD
+#define SSD1306_HOST_BUS_OVERHEAD   2
+#endif
+
+// Stand-ins for the HAL pieces the library uses
+#define __weak __attribute__((weak))
+
+void HAL_Delay(uint32_t Delay);
+uint32_t HAL_GetTick(void);
+
+typedef struct {
+    uint32_t Transactions;      // Bus transactions (one per Write* call)
+    uint32_t CommandBytes;      // Payload bytes sent as commands
+    uint32_t DataBytes;         // Payload bytes sent as display data
+    uint32_t BusBytes;          // Everything on the wire, framing included
+} SSD1306_HostBusStats_t;
+
+/**
+ * @brief Feeds one bus transaction into the emulated panel.
+ * @param control 0x00 for commands, 0x40 for display data.
+ */
+void ssd1306_HostWrite(uint8_t control, const uint8_t* bytes, size_t count);
+
+/**
+ * @brief Clears the emulated panel RAM and state, as after a reset.
+ */
+void ssd1306_HostReset(void);
+
+void ssd1306_HostGetBusStats(SSD1306_HostBusStats_t* stats);
+void ssd1306_HostResetBusStats(void);
+
+/**
+ * @brief Panel RAM as written over the bus, 8 pages of 128 columns.
+ */
+const uint8_t* ssd1306_HostGetRAM(void);
+
+/**
+ * @brief Renders what the panel shows, one byte (0 or 1) per pixel.
+ * @param image SSD1306_WIDTH * SSD1306_HEIGHT bytes, row by row.
+ * @note Display off renders black, inverse mode (0xA7) inverts.
+ */
+void ssd1306_HostRender(uint8_t* image);
+
+/**
+ * @brief Writes what the panel shows as a binary PBM (P4) file.
+ * @return 0 on success, -1 if the file could not be written.
+ */
+int ssd1306_HostWritePBM(const char* path);
+
+/**
+ * @brief Virtual milliseconds added by HAL_Delay, which does not sleep on the host.
+ */
+uint32_t ssd1306_HostDelayed(void);
+
+#endif // __SSD1306_HOST_H__
@@ -1,13 +1,30 @@
 #ifndef __SSD1306_TEST_H__
 #define __SSD1306_TEST_H__
-#include <_ansi.h>
+#include "ssd1306.h"
 
 _BEGIN_STD_C
 
+/** One line of the benchmark report */
+typedef struct {
+    const char* Name;
+    uint32_t Calls;
+    uint32_t CyclesPerCall;     // Timer ticks per call, see "BENCH,begin" for the rate
+    uint32_t BusBytes;          // Bytes a flush puts on the bus for one call
+} SSD1306_BenchResult_t;
+
 void ssd1306_TestBorder(void);
 void ssd1306_TestFonts1(void);
 void ssd1306_TestFonts2(void);
+void ssd1306_TestFonts3(void);
 void ssd1306_TestFPS(void);
+void ssd1306_TestFrameTime(void);
+
+/**
+ * @brief Times every drawing primitive and the flush with the cycle counter.
+ * @note Results go out as CSV lines through ssd1306_BenchmarkOutput.
+ */
+void ssd1306_TestBenchmark(void);
+void ssd1306_BenchmarkOutput(const char* line);
 void ssd1306_TestAll(void);
 void ssd1306_TestLine(void);
 void ssd1306_TestRectangle(void);
@@ -15,6 +32,7 @@ void ssd1306_TestRectangleFill(void);
 void ssd1306_TestRectangleInvert(void);
 void ssd1306_TestCircle(void);
 void ssd1306_TestArc(void);
+void ssd1306_TestGauge(void);
 void ssd1306_TestPolyline(void);
 void ssd1306_TestDrawBitmap(void);
 void ssd1306_TestBehoa(void);
@@ -0,0 +1,221 @@
+/**
+ * Retained-mode widgets on top of the ssd1306 screenbuffer.
+ *
+ * Every widget owns a fixed box of text cells and remembers what it drew
+ * last. Setting a widget to the value it already shows costs a compare;
+ * a change repaints only its own box, so ssd1306_UpdateScreen sends just
+ * those columns.
+ */
+
+#ifndef __SSD1306_WIDGETS_H__
+#define __SSD1306_WIDGETS_H__
+
+#include "ssd1306.h"
+
+_BEGIN_STD_C
+
+// Longest text a widget can hold, in characters
+#ifndef SSD1306_WIDGET_MAX_CHARS
+#define SSD1306_WIDGET_MAX_CHARS    18
+#endif
+
+// Text buffer of a widget in bytes; UTF-8 letters such as "ệ" take up to 3
+#ifndef SSD1306_WIDGET_TEXT_SIZE
+#define SSD1306_WIDGET_TEXT_SIZE    (2 * SSD1306_WIDGET_MAX_CHARS + 1)
+#endif
+
+/** Text field: the common part of all widgets */
+typedef struct {
+    uint8_t X;                          /**< Top left corner */
+    uint8_t Y;
+    uint8_t Chars;                      /**< Box width in font cells */
+    SSD1306_COLOR Color;
+    const SSD1306_Font_t* Font;
+    char Text[SSD1306_WIDGET_TEXT_SIZE];    /**< Text currently on screen, UTF-8 */
+    uint8_t Drawn;                      /**< 0 until the first paint */
+} SSD1306_Widget_t;
+
+/** Fixed-point value with unit, e.g. 253 with 1 decimal and " C" -> "25.3 C" */
+typedef struct {
+    SSD1306_Widget_t Field;
+    const char* Unit;
+    uint8_t Decimals;
+    uint8_t HasValue;                   /**< 0 while a placeholder text is shown */
+    int32_t Value;                      /**< Last value drawn, in 10^-Decimals units */
+} SSD1306_ValueWidget_t;
+
+/** Status marker showing one symbol out of a fixed set */
+typedef struct {
+    SSD1306_Widget_t Field;
+    const char* const* Symbols;
+    uint8_t Count;
+    uint8_t State;
+} SSD1306_MarkerWidget_t;
+
+// Points kept per history ring
+#ifndef SSD1306_HISTORY_LEN
+#define SSD1306_HISTORY_LEN         128
+#endif
+
+/** Ring of decimated samples feeding a plot */
+typedef struct {
+    int16_t Samples[SSD1306_HISTORY_LEN];
+    uint8_t Head;                       /**< Index of the next point */
+    uint8_t Count;                      /**< Points stored, up to SSD1306_HISTORY_LEN */
+    uint8_t Decimation;                 /**< Samples averaged into one point */
+    uint8_t Pending;                    /**< Samples in Sum */
+    int32_t Sum;
+    uint16_t Stored;                    /**< Points ever stored, wraps; plots compare against it */
+} SSD1306_History_t;
+
+typedef enum {
+    SSD1306_PLOT_LINE = 0,              /**< Sparkline, consecutive points joined */
+    SSD1306_PLOT_BARS                   /**< One filled bar per point */
+} SSD1306_PlotStyle_t;
+
+/** Scrolling plot of a history ring, newest point at the right edge */
+typedef struct {
+    uint8_t X;
+    uint8_t Width;
+    uint8_t Page1;                      /**< Plot area in pages (8px rows) */
+    uint8_t Page2;
+    int16_t Min;                        /**< Values mapped to the bottom/top row, clamped */
+    int16_t Max;
+    SSD1306_PlotStyle_t Style;
+    SSD1306_COLOR Color;
+    const SSD1306_History_t* History;
+    uint16_t Shown;                     /**< History->Stored at the last paint */
+    uint8_t LastY;                      /**< Row of the newest point on screen */
+    uint8_t Drawn;
+} SSD1306_PlotWidget_t;
+
+/** Dial with a needle over an arc, angles as in ssd1306_DrawArc */
+typedef struct {
+    uint8_t X;                          /**< Centre */
+    uint8_t Y;
+    uint8_t Radius;
+    uint16_t Start;                     /**< Angle of Min, degrees from the bottom */
+    uint16_t Sweep;                     /**< Degrees from Min to Max, Start + Sweep <= 360 */
+    int16_t Min;                        /**< Values outside Min..Max are clamped */
+    int16_t Max;
+    SSD1306_COLOR Color;
+    uint16_t Angle;                     /**< Needle angle on screen */
+    uint8_t Drawn;
+} SSD1306_GaugeWidget_t;
+
+/**
+ * @brief Sets up a text field. Nothing is drawn until the first Set.
+ * @param chars box width in font cells, at most SSD1306_WIDGET_MAX_CHARS.
+ */
+void ssd1306_WidgetInit(SSD1306_Widget_t* w, uint8_t x, uint8_t y, uint8_t chars,
+                        const SSD1306_Font_t* font, SSD1306_COLOR color);
+
+/**
+ * @brief Shows text in the field, repainting the box only if it changed.
+ * @note Text is UTF-8 and cut to the characters that fit into the box.
+ * @return 1 if the screenbuffer was touched.
+ */
+uint8_t ssd1306_WidgetSetText(SSD1306_Widget_t* w, const char* text);
+
+/**
+ * @brief Paints the field again, e.g. after the screenbuffer was cleared.
+ */
+void ssd1306_WidgetRedraw(SSD1306_Widget_t* w);
+
+/**
+ * @brief Draws a static label sized to its text.
+ */
+void ssd1306_LabelInit(SSD1306_Widget_t* w, uint8_t x, uint8_t y, const char* text,
+                       const SSD1306_Font_t* font, SSD1306_COLOR color);
+
+void ssd1306_ValueInit(SSD1306_ValueWidget_t* w, uint8_t x, uint8_t y, uint8_t chars,
+                       const SSD1306_Font_t* font, SSD1306_COLOR color,
+                       uint8_t decimals, const char* unit);
+
+/**
+ * @brief Shows a fixed-point value; the text is only rebuilt if it changed.
+ * @return 1 if the screenbuffer was touched.
+ */
+uint8_t ssd1306_ValueSet(SSD1306_ValueWidget_t* w, int32_t value);
+
+/**
+ * @brief Shows a placeholder such as "Init..." instead of a value.
+ * @return 1 if the screenbuffer was touched.
+ */
+uint8_t ssd1306_ValueSetText(SSD1306_ValueWidget_t* w, const char* text);
+
+/**
+ * @param symbols one string per state, all fitting into the box.
+ */
+void ssd1306_MarkerInit(SSD1306_MarkerWidget_t* w, uint8_t x, uint8_t y, uint8_t chars,
+                        const SSD1306_Font_t* font, SSD1306_COLOR color,
+                        const char* const* symbols, uint8_t count);
+
+/**
+ * @brief Switches the marker to symbols[state].
+ * @return 1 if the screenbuffer was touched.
+ */
+uint8_t ssd1306_MarkerSet(SSD1306_MarkerWidget_t* w, uint8_t state);
+
+/**
+ * @param decimation number of samples averaged into one stored point.
+ */
+void ssd1306_HistoryInit(SSD1306_History_t* h, uint8_t decimation);
+
+/**
+ * @brief Adds a sample.
+ * @return 1 if it completed a point.
+ */
+uint8_t ssd1306_HistoryPush(SSD1306_History_t* h, int16_t sample);
+
+/**
+ * @brief Returns a stored point, age 0 is the newest.
+ */
+int16_t ssd1306_HistoryGet(const SSD1306_History_t* h, uint8_t age);
+
+/**
+ * @brief Sets up a plot over a page-aligned area.
+ * @param y top row, multiple of 8.
+ * @param height multiple of 8.
+ */
+void ssd1306_PlotInit(SSD1306_PlotWidget_t* w, uint8_t x, uint8_t y, uint8_t width, uint8_t height,
+                      const SSD1306_History_t* history, int16_t min, int16_t max,
+                      SSD1306_PlotStyle_t style, SSD1306_COLOR color);
+
+/**
+ * @brief Brings the plot up to date with its history.
+ * @note New points shift the plot left with ssd1306_ScrollColumnsLeft and
+ *       only the new columns are drawn; the whole plot is redrawn only the
+ *       first time or when it fell a full width behind.
+ * @return 1 if the screenbuffer was touched.
+ */
+uint8_t ssd1306_PlotUpdate(SSD1306_PlotWidget_t* w);
+
+/**
+ * @brief Clears the plot area and draws all points again.
+ */
+void ssd1306_PlotRedraw(SSD1306_PlotWidget_t* w);
+
+/**
+ * @brief Sets up a dial. Nothing is drawn until the first Set.
+ * @note The needle is drawn and erased inside radius - 3, so nothing else
+ *       should be drawn inside the arc.
+ */
+void ssd1306_GaugeInit(SSD1306_GaugeWidget_t* w, uint8_t x, uint8_t y, uint8_t radius,
+                       uint16_t start, uint16_t sweep, int16_t min, int16_t max,
+                       SSD1306_COLOR color);
+
+/**
+ * @brief Moves the needle; only the old and the new needle are drawn.
+ * @return 1 if the screenbuffer was touched.
+ */
+uint8_t ssd1306_GaugeSet(SSD1306_GaugeWidget_t* w, int16_t value);
+
+/**
+ * @brief Draws the arc and the needle again.
+ */
+void ssd1306_GaugeRedraw(SSD1306_GaugeWidget_t* w);
+
+_END_STD_C
+
+#endif // __SSD1306_WIDGETS_H__
@@ -0,0 +1,205 @@
+/**
+  ******************************************************************************
+  * @file           : telemetry.h
+  * @brief          : Frame nhị phân STM32 <-> ESP8266 qua UART5 (COBS + CRC16)
+  * @created        : Oct 18, 2026
+  * @author         : NguyenHoa
+  * @version        : 1.7.0
+  ******************************************************************************
+  * Mỗi frame trên dây:  COBS(payload | CRC16) 0x00
+  *
+  *   payload[0]      header: version (4 bit cao) | type (4 bit thấp)
+  *   payload[1..]    nội dung theo type, số nhiều byte là little-endian
+  *   CRC16           CRC-16/CCITT-FALSE của payload, little-endian
+  *
+  * COBS bỏ hết byte 0x00 trong frame nên 0x00 chỉ là dấu kết thúc frame,
+  * bên nhận mất đồng bộ thì bỏ đến byte 0x00 kế tiếp là bắt lại được.
+  *
+  * TELEM_TYPE_SAMPLE (13 byte payload, bản cũ một mẫu mỗi frame, STM32 không
+  * còn gửi, tools/telemetry_decode.py vẫn đọc được):
+  *   [1]  uint16  Seq, [3] uint32 TimeMs, [7..12] như một bản ghi bên dưới
+  *
+  * TELEM_TYPE_BATCH (7 + 10 x Count byte payload):
+  *   [1]  uint32  FirstSeq  số thứ tự bản ghi đầu, các bản ghi sau tăng 1
+  *   [5]  uint8   Count     1..TELEM_BATCH_MAX
+  *   [6]  uint8   BatchFlags TELEM_BATCH_OLDEST: FirstSeq là bản ghi cũ nhất
+  *                STM32 còn giữ, mọi bản ghi trước đã xác nhận hoặc bị ghi đè;
+  *                TELEM_BATCH_LIVE: frame kết thúc ở bản ghi mới nhất, không
+  *                có thì đây là bản ghi cũ đang gửi bù
+  *   [7]  Count bản ghi TELEM_Record, mỗi bản ghi 10 byte:
+  *        +0 uint32 TimeMs    HAL_GetTick() lúc đọc
+  *        +4 uint8  Flags     TELEM_FLAG_*, mức gas ở bit 4..5
+  *        +5 int16  TempX10   nhiệt độ, 0.1 C
+  *        +7 uint8  Humidity  độ ẩm, % (DHT11 đo theo 1 %)
+  *        +8 uint16 GasPpm    nồng độ gas, ppm
+  *   ESP báo bằng lệnh TELEM_CMD_ACK_SAMPLES khi nhận frame và khi đã đẩy lên
+  *   server, STM32 gửi lại từ bản ghi ESP chưa nhận nếu quá thời gian không
+  *   có ACK.
+  *   Bên nhận thấy FirstSeq vượt quá bản ghi đang chờ mà không có
+  *   TELEM_BATCH_OLDEST thì frame trước bị mất: bỏ frame, chờ gửi lại.
+  *   Seq giữ qua khởi động lại (flash_log.h); FirstSeq = 0 nghĩa là STM32
+  *   bắt đầu nhật ký mới: bên nhận đồng bộ lại.
+  *
+  * TELEM_TYPE_COMMAND (ESP -> STM32):
+  *   [1]  uint8   Seq       số thứ tự lệnh, STM32 trả lại trong ACK/STATS
+  *   [2]  uint8   Opcode    TELEM_CMD_*
+  *   TELEM_CMD_SET_INTERVAL thêm [3] uint8 TELEM_INTERVAL_*, [4] uint16 chu kỳ, ms
+  *   TELEM_CMD_ACK_SAMPLES thêm [3] uint32 NextSeq: đã đẩy lên server mọi bản
+  *   ghi trước NextSeq, STM32 bỏ chúng; [7] uint32 ReceivedSeq (không bắt buộc,
+  *   mặc định bằng NextSeq): đã nhận mọi bản ghi trước ReceivedSeq, STM32 không
+  *   gửi lại chúng. STM32 không trả lời lệnh này
+  *
+  * TELEM_TYPE_ACK (4 byte payload): [1] Seq, [2] Opcode, [3] TELEM_STATUS_*
+  *
+  * TELEM_TYPE_STATS (52 byte payload), trả lời TELEM_CMD_GET_STATS:
+  *   [1]  uint8   Seq
+  *   [2]  uint32  UptimeMs
+  *   [6]  uint16  chu kỳ DHT11, MQ2, gửi mẫu (3 x uint16), ms
+  *   [12] uint32  Dht11Reads, Dht11Errors
+  *   [20] uint32  TxFrames, TxDropped, TxErrors
+  *   [32] uint32  RxFrames, RxErrors
+  *   [40] uint32  BootSeq   Seq của bản ghi đầu tiên từ lần khởi động này.
+  *                Cùng UptimeMs, bên nhận suy ra giờ thực của TimeMs trong
+  *                các bản ghi có Seq >= BootSeq
+  *   [44] uint32  SampleReadings, SampleSuppressed: lần đọc cảm biến và số
+  *                lần không thành bản ghi vì không đổi đáng kể (deadband)
+  *
+  * TELEM_TYPE_TEXT: payload[1..] là chuỗi UTF-8 (không có '\0'), dùng cho log
+  * ------------------------------------------------------------------------------
+  * Bên giải mã: ESP8266 (GenX_ESP8266_Final.ino), máy tính (tools/telemetry_decode.py)
+  ******************************************************************************
+  */
+
+#ifndef INC_TELEMETRY_H_
+#define INC_TELEMETRY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Version defines -----------------------------------------------------------*/
+#define TELEM_VER_MAJOR 1
+#define TELEM_VER_MINOR 7
+#define TELEM_VER_PATCH 0
+
+/* Exported constants --------------------------------------------------------*/
+/* Version giao thức trong header, đổi khi bố cục payload thay đổi:
+ *   1: STATS 40 byte
+ *   2: STATS 52 byte, thêm BootSeq và SampleReadings/SampleSuppressed
+ * Bên nhận bỏ frame khác version và báo ra log, không đoán bố cục theo độ dài */
+#define TELEM_PROTOCOL_VERSION 2
+
+/* Loại frame */
+#define TELEM_TYPE_SAMPLE 0x1      // Một mẫu cảm biến
+#define TELEM_TYPE_COMMAND 0x2     // Lệnh từ ESP
+#define TELEM_TYPE_ACK 0x3         // Kết quả một lệnh
+#define TELEM_TYPE_STATS 0x4       // Thống kê, trả lời TELEM_CMD_GET_STATS
+#define TELEM_TYPE_BATCH 0x5       // Nhiều bản ghi cảm biến liên tiếp
+#define TELEM_TYPE_TEXT 0xF        // Dòng log dạng chữ
+
+/* Flags của frame mẫu */
+#define TELEM_FLAG_DHT11_OK 0x01   // TempX10 và Humidity hợp lệ
+#define TELEM_FLAG_MQ2_OK 0x02     // GasPpm hợp lệ
+#define TELEM_FLAG_MQ2_CAL 0x04    // MQ2 đã hiệu chuẩn
+#define TELEM_FLAG_LEVEL_POS 4     // Mức gas (MQ2_GasLevelTypeDef) ở bit 4..5
+#define TELEM_FLAG_LEVEL_MASK 0x30
+#define TELEM_FLAG_DHT11_NEW 0x40  // Bản ghi có lần đọc DHT11 mới (không thì TempX10/Humidity là giá trị cũ)
+#define TELEM_FLAG_MQ2_NEW 0x80    // Bản ghi có lần đọc MQ2 mới
+
+/* BatchFlags của frame BATCH */
+#define TELEM_BATCH_OLDEST 0x01    // FirstSeq là bản ghi cũ nhất chưa xác nhận
+#define TELEM_BATCH_LIVE 0x02      // Bản ghi cuối là bản ghi mới nhất, không phải gửi bù
+
+/* Lệnh (Opcode của frame COMMAND) */
+#define TELEM_CMD_SET_INTERVAL 0x01  // Đổi chu kỳ đọc/gửi
+#define TELEM_CMD_CALIBRATE 0x02     // Hiệu chuẩn lại MQ2 (không khí sạch)
+#define TELEM_CMD_GET_STATS 0x03     // Yêu cầu frame STATS
+#define TELEM_CMD_ACK_SAMPLES 0x04   // Xác nhận bản ghi của frame BATCH
+
+/* Chu kỳ của TELEM_CMD_SET_INTERVAL */
+#define TELEM_INTERVAL_DHT11 0     // Đọc DHT11
+#define TELEM_INTERVAL_MQ2 1       // Đọc MQ2
+#define TELEM_INTERVAL_UART 2      // Gửi frame mẫu
+
+/* Kết quả trong frame ACK */
+#define TELEM_STATUS_OK 0
+#define TELEM_STATUS_UNKNOWN 1     // Opcode lạ
+#define TELEM_STATUS_BAD_ARG 2     // Sai độ dài hoặc giá trị ngoài giới hạn
+#define TELEM_STATUS_BUSY 3        // Đang thực hiện lệnh trước
+
+#define TELEM_SAMPLE_SIZE 13       // Payload frame mẫu, không kể CRC
+#define TELEM_ACK_SIZE 4
+#define TELEM_STATS_SIZE 52
+#define TELEM_RECORD_SIZE 10       // Một bản ghi trong frame BATCH
+#define TELEM_BATCH_MAX 16         // Số bản ghi tối đa mỗi frame BATCH
+#define TELEM_BATCH_SIZE(n) (7 + (n) * TELEM_RECORD_SIZE)
+#define TELEM_TEXT_MAX 96          // Số byte chữ tối đa của frame TEXT
+#define TELEM_PAYLOAD_MAX TELEM_BATCH_SIZE(TELEM_BATCH_MAX)  // Frame BATCH đầy là payload lớn nhất
+
+#if TELEM_PAYLOAD_MAX < 1 + TELEM_TEXT_MAX || TELEM_PAYLOAD_MAX > 252
+#error "TELEM_PAYLOAD_MAX must hold a TEXT frame and fit one COBS block"
+#endif
+
+/* Số byte tối đa trên dây của frame có n byte payload: CRC, phần thêm của COBS, 0x00 */
+#define TELEM_FRAME_SIZE(n) ((n) + 2 + ((n) + 2) / 254 + 1 + 1)
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+    uint32_t TimeMs;            // Thời điểm đọc (HAL_GetTick)
+    int16_t TempX10;            // Nhiệt độ x10
+    uint16_t GasPpm;            // Nồng độ gas ppm
+    uint8_t Flags;              // TELEM_FLAG_*
+    uint8_t Humidity;           // Độ ẩm %
+} TELEM_Record;
+
+typedef struct {
+    uint8_t Seq;                // Số thứ tự lệnh
+    uint8_t Opcode;             // TELEM_CMD_*
+    uint8_t Target;             // TELEM_INTERVAL_* (SET_INTERVAL)
+    uint16_t Value;             // Chu kỳ ms (SET_INTERVAL)
+    uint32_t NextSeq;           // Bản ghi đầu chưa đẩy lên server (ACK_SAMPLES)
+    uint32_t ReceivedSeq;       // Bản ghi đầu chưa nhận (ACK_SAMPLES)
+} TELEM_Command;
+
+typedef struct {
+    uint32_t UptimeMs;          // HAL_GetTick()
+    uint16_t Dht11IntervalMs;   // Chu kỳ đọc DHT11
+    uint16_t Mq2IntervalMs;     // Chu kỳ đọc MQ2
+    uint16_t UartIntervalMs;    // Chu kỳ gửi frame mẫu
+    uint32_t Dht11Reads;        // Số lần đọc DHT11
+    uint32_t Dht11Errors;       // Trong đó số lần lỗi
+    uint32_t TxFrames;          // Frame đã xếp hàng gửi
+    uint32_t TxDropped;         // Frame bị bỏ vì hàng đợi gửi đầy
+    uint32_t TxErrors;          // Khối gửi bị lỗi/quá thời gian
+    uint32_t RxFrames;          // Frame nhận hợp lệ
+    uint32_t RxErrors;          // Frame nhận hỏng và lỗi UART
+    uint32_t BootSeq;           // Seq của bản ghi đầu tiên từ lần khởi động này
+    uint32_t SampleReadings;    // Lần đọc cảm biến đã xét
+    uint32_t SampleSuppressed;  // Lần đọc không ghi vì nằm trong deadband
+} TELEM_Stats;
+
+/* Exported functions prototypes ---------------------------------------------*/
+// Building blocks
+uint16_t TELEM_Crc16(const uint8_t *data, uint16_t len);
+uint16_t TELEM_CobsEncode(const uint8_t *src, uint16_t len, uint8_t *dst);
+uint16_t TELEM_CobsDecode(const uint8_t *src, uint16_t len, uint8_t *dst);
+
+// Whole frames
+uint16_t TELEM_EncodeFrame(const uint8_t *payload, uint16_t len, uint8_t *frame, uint16_t size);
+uint16_t TELEM_DecodeFrame(const uint8_t *frame, uint16_t len, uint8_t *payload, uint16_t size);
+uint16_t TELEM_EncodeBatch(uint32_t firstSeq, uint8_t batchFlags, const TELEM_Record *records, uint8_t count, uint8_t *frame, uint16_t size);
+uint16_t TELEM_EncodeText(const char *text, uint8_t *frame, uint16_t size);
+
+// Command channel
+uint8_t TELEM_DecodeCommand(const uint8_t *payload, uint16_t len, TELEM_Command *cmd);
+uint16_t TELEM_EncodeAck(const TELEM_Command *cmd, uint8_t status, uint8_t *frame, uint16_t size);
+uint16_t TELEM_EncodeStats(uint8_t seq, const TELEM_Stats *stats, uint8_t *frame, uint16_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_TELEMETRY_H_ */
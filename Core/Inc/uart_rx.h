@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @file           : uart_rx.h
+  * @brief          : Nhận UART bằng DMA vòng + phát hiện IDLE, tách frame theo 0x00
+  * @created        : Oct 18, 2026
+  * @author         : NguyenHoa
+  * @version        : 1.0.0
+  ******************************************************************************
+  * DMA chép liên tục vào bộ đệm vòng, CPU không xử lý từng byte. Ngắt IDLE
+  * (đường truyền rảnh sau một cụm byte), nửa bộ đệm và hết bộ đệm chỉ ghi lại
+  * vị trí DMA. UARTRX_Process trong vòng lặp chính đọc phần mới, cắt theo
+  * byte 0x00 và gọi handler với mỗi frame (chưa giải mã COBS, không có 0x00).
+  *
+  * Cần: UART RX có DMA chế độ DMA_CIRCULAR (__HAL_LINKDMA hdmarx), ngắt DMA
+  * stream và ngắt UART, HAL_UARTEx_RxEventCallback / HAL_UART_ErrorCallback
+  * gọi UARTRX_RxEvent / UARTRX_Error.
+  ******************************************************************************
+  */
+
+#ifndef INC_UART_RX_H_
+#define INC_UART_RX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Version defines -----------------------------------------------------------*/
+#define UARTRX_VER_MAJOR 1
+#define UARTRX_VER_MINOR 0
+#define UARTRX_VER_PATCH 0
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef UARTRX_DMA_SIZE
+#define UARTRX_DMA_SIZE 256        // Byte; phải lớn hơn lượng nhận được giữa hai lần UARTRX_Process
+#endif
+#ifndef UARTRX_FRAME_MAX
+#define UARTRX_FRAME_MAX 128       // Frame dài nhất (không kể 0x00), dài hơn thì bỏ
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+typedef void (*UARTRX_FrameHandler)(const uint8_t *frame, uint16_t len);
+
+typedef struct {
+    uint32_t Bytes;             // Byte đã nhận
+    uint32_t Frames;            // Frame đã giao cho handler
+    uint32_t Overruns;          // Frame dài quá UARTRX_FRAME_MAX, đã bỏ
+    uint32_t Errors;            // Lỗi UART (overrun, noise, framing...) hoặc DMA
+    uint32_t Restarts;          // Số lần khởi động lại DMA nhận sau lỗi
+} UARTRX_Stats;
+
+typedef struct {
+    UARTRX_Stats Stats;
+    // Private members
+    UART_HandleTypeDef *_huart;         // UART đã liên kết DMA RX vòng
+    UARTRX_FrameHandler _handler;       // Nhận từng frame
+    volatile uint16_t _dmaPos;          // Vị trí DMA theo ngắt IDLE/HT/TC gần nhất
+    uint16_t _readPos;                  // Vị trí đã xử lý đến
+    uint16_t _frameLen;                 // Số byte của frame đang ghép
+    uint8_t _discard;                   // 1: frame hiện tại quá dài, bỏ đến 0x00
+    uint8_t _dmaBuffer[UARTRX_DMA_SIZE];
+    uint8_t _frame[UARTRX_FRAME_MAX];
+} UARTRX_Data;
+
+/* Exported functions prototypes ---------------------------------------------*/
+// Initialization
+HAL_StatusTypeDef UARTRX_Init(UARTRX_Data *rx, UART_HandleTypeDef *huart, UARTRX_FrameHandler handler);
+
+// Gọi từ vòng lặp chính
+void UARTRX_Process(UARTRX_Data *rx);
+
+// Interrupt hooks - gọi từ HAL_UARTEx_RxEventCallback / HAL_UART_ErrorCallback
+void UARTRX_RxEvent(UARTRX_Data *rx, uint16_t pos);
+void UARTRX_Error(UARTRX_Data *rx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_UART_RX_H_ */
@@ -0,0 +1,91 @@
+/**
+  ******************************************************************************
+  * @file           : uart_tx.h
+  * @brief          : Hàng đợi gửi UART không chặn (ring buffer + DMA)
+  * @created        : Oct 18, 2026
+  * @author         : NguyenHoa
+  * @version        : 1.0.0
+  ******************************************************************************
+  * UARTTX_Write chép frame vào ring buffer rồi trả về ngay, DMA gửi phần
+  * liền mạch dài nhất từ đầu hàng đợi, ngắt TC của lần gửi trước khởi động
+  * lần gửi kế tiếp. Vòng lặp chính không bao giờ chờ đường truyền.
+  *
+  * Khi hàng đợi đầy: bỏ frame MỚI, nguyên frame (không bao giờ gửi nửa frame),
+  * và đếm vào Stats.Dropped. Frame đã xếp hàng thì giữ nguyên thứ tự.
+  *
+  * Cần: UART TX có DMA (__HAL_LINKDMA hdmatx), ngắt DMA stream và ngắt UART,
+  * HAL_UART_TxCpltCallback / HAL_UART_ErrorCallback gọi UARTTX_TxCplt /
+  * UARTTX_Error, vòng lặp chính gọi UARTTX_Process.
+  ******************************************************************************
+  */
+
+#ifndef INC_UART_TX_H_
+#define INC_UART_TX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Version defines -----------------------------------------------------------*/
+#define UARTTX_VER_MAJOR 1
+#define UARTTX_VER_MINOR 0
+#define UARTTX_VER_PATCH 0
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef UARTTX_BUFFER_SIZE
+#define UARTTX_BUFFER_SIZE 1024    // Byte, lũy thừa của 2; 1024 byte ~ 89 ms ở 115200 baud
+#endif
+#define UARTTX_TIMEOUT_MARGIN 20   // ms cộng thêm vào thời gian gửi lý thuyết của một khối DMA
+
+#if (UARTTX_BUFFER_SIZE & (UARTTX_BUFFER_SIZE - 1)) || UARTTX_BUFFER_SIZE > 32768
+#error "UARTTX_BUFFER_SIZE must be a power of 2, at most 32768"
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+    UARTTX_OK = 0,
+    UARTTX_FULL                 // Không đủ chỗ, frame đã bị bỏ
+} UARTTX_StatusTypeDef;
+
+typedef struct {
+    uint32_t Frames;            // Frame đã nhận vào hàng đợi
+    uint32_t Bytes;             // Byte đã nhận vào hàng đợi
+    uint32_t SentBytes;         // Byte DMA đã gửi xong
+    uint32_t Dropped;           // Frame bị bỏ vì hàng đợi đầy
+    uint32_t DroppedBytes;      // Số byte của các frame đó
+    uint32_t Errors;            // Khối DMA bị lỗi hoặc quá thời gian, đã bỏ
+    uint16_t HighWater;         // Số byte chờ gửi lớn nhất từng có
+} UARTTX_Stats;
+
+typedef struct {
+    UARTTX_Stats Stats;
+    // Private members
+    UART_HandleTypeDef *_huart;         // UART đã liên kết DMA TX
+    volatile uint16_t _head;            // Chỉ số ghi, chỉ UARTTX_Write tăng (không quấn về 0 theo kích thước)
+    volatile uint16_t _tail;            // Chỉ số đọc, tăng khi DMA gửi xong một khối
+    volatile uint16_t _inFlight;        // Số byte DMA đang gửi, 0 = rảnh
+    volatile uint32_t _startTick;       // HAL_GetTick() lúc bắt đầu khối đang gửi
+    uint8_t _buffer[UARTTX_BUFFER_SIZE];
+} UARTTX_Data;
+
+/* Exported functions prototypes ---------------------------------------------*/
+// Initialization
+void UARTTX_Init(UARTTX_Data *tx, UART_HandleTypeDef *huart);
+
+// Queueing - không chặn, gọi từ vòng lặp chính
+UARTTX_StatusTypeDef UARTTX_Write(UARTTX_Data *tx, const uint8_t *data, uint16_t len);
+uint16_t UARTTX_Pending(const UARTTX_Data *tx);
+void UARTTX_Process(UARTTX_Data *tx, uint32_t currentTime);
+
+// Interrupt hooks - gọi từ HAL_UART_TxCpltCallback / HAL_UART_ErrorCallback
+void UARTTX_TxCplt(UARTTX_Data *tx);
+void UARTTX_Error(UARTTX_Data *tx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_UART_TX_H_ */
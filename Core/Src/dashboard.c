@@ -0,0 +1,128 @@
+/**
+  ******************************************************************************
+  * @file           : dashboard.c
+  * @brief          : Bố cục và nội dung màn hình OLED (không dùng HAL)
+  * @created        : Oct 18, 2026
+  * @author         : NguyenHoa
+  * @version        : 1.0.1
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dashboard.h"
+#include "ssd1306_fonts.h"
+#include "fmt.h"
+
+/* Private variables ---------------------------------------------------------*/
+/* Ký hiệu mức gas, theo thứ tự MQ2_GasLevelTypeDef */
+static const char* const GasLevelMarkers[] = { "", "* ", "! " };
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Giới hạn giá trị vào khoảng [min, max]
+  * @param  value: giá trị
+  * @param  min: cận dưới
+  * @param  max: cận trên
+  * @retval Giá trị đã giới hạn
+  */
+static int32_t Clamp(int32_t value, int32_t min, int32_t max) {
+    return value < min ? min : (value > max ? max : value);
+}
+
+/**
+  * @brief  Dựng bố cục OLED: nhãn tĩnh và các ô giá trị
+  * @note   Gọi một lần sau ssd1306_Init, rồi flush cả màn hình. Các dòng giữ vị trí:
+  *         y = 0 (nhiệt độ), 15 (độ ẩm), 30 (gas, marker mức nguy hiểm ở đầu dòng),
+  *         y = 40..63 là đồ thị xu hướng gas (đường) và nhiệt độ (cột).
+  *         Font_7x10_Dash chỉ có các ký tự trong tools/fonts/dashboard.txt,
+  *         đổi chữ trên màn hình thì sinh lại font (tools/ssd1306_font_subset.py)
+  * @param  dash: con trỏ đến DASH_Data
+  * @retval None
+  */
+void DASH_Init(DASH_Data *dash) {
+    ssd1306_Fill(Black);
+
+    ssd1306_LabelInit(&dash->TempLabel, 1, 0, "Nhiệt độ:", &Font_7x10_Dash, White);
+    ssd1306_ValueInit(&dash->TempValue, 1 + 10 * 7, 0, 8, &Font_7x10_Dash, White, 1, " C");
+
+    ssd1306_LabelInit(&dash->HumLabel, 1, 15, "Độ ẩm:", &Font_7x10_Dash, White);
+    ssd1306_ValueInit(&dash->HumValue, 1 + 8 * 7, 15, 8, &Font_7x10_Dash, White, 1, " %");
+
+    ssd1306_MarkerInit(&dash->GasMarker, 1, 30, 2, &Font_7x10_Dash, White,
+                       GasLevelMarkers, sizeof(GasLevelMarkers) / sizeof(GasLevelMarkers[0]));
+    ssd1306_LabelInit(&dash->GasLabel, 1 + 2 * 7, 30, "Gas:", &Font_7x10_Dash, White);
+    ssd1306_ValueInit(&dash->GasValue, 1 + 8 * 7, 30, 10, &Font_7x10_Dash, White, 1, " ppm");
+
+    ssd1306_ValueSetText(&dash->TempValue, "Init...");
+    ssd1306_ValueSetText(&dash->HumValue, "Init...");
+    ssd1306_MarkerSet(&dash->GasMarker, 0);
+    ssd1306_ValueSetText(&dash->GasValue, "Cal...");
+
+    ssd1306_HistoryInit(&dash->GasHistory, DASH_TREND_GAS_DECIMATION);
+    ssd1306_HistoryInit(&dash->TempHistory, DASH_TREND_TEMP_DECIMATION);
+    ssd1306_PlotInit(&dash->GasPlot, 0, 40, 63, 24, &dash->GasHistory,
+                     0, DASH_TREND_GAS_MAX, SSD1306_PLOT_LINE, White);
+    ssd1306_PlotInit(&dash->TempPlot, 65, 40, 63, 24, &dash->TempHistory,
+                     0, DASH_TREND_TEMP_MAX, SSD1306_PLOT_BARS, White);
+}
+
+/**
+  * @brief  Vẽ lại các widget thuộc các sự kiện vào screenbuffer
+  * @param  dash: con trỏ đến DASH_Data
+  * @param  events: các bit DASH_EVENT_*
+  * @param  readings: giá trị cần hiển thị
+  * @retval 1 nếu screenbuffer thay đổi
+  */
+uint8_t DASH_Render(DASH_Data *dash, uint8_t events, const DASH_Readings *readings) {
+    uint8_t changed = 0;
+
+    // Nhiệt độ và độ ẩm - giá trị x10 (một chữ số thập phân)
+    if (events & DASH_EVENT_CLIMATE) {
+        if (readings->Climate == DASH_CLIMATE_OK) {
+            changed |= ssd1306_ValueSet(&dash->TempValue, FMT_Scale(readings->Temperature, 1));
+            changed |= ssd1306_ValueSet(&dash->HumValue, FMT_Scale(readings->Humidity, 1));
+        } else {
+            const char* text = (readings->Climate == DASH_CLIMATE_INIT) ? "Init..." : "Error";
+            changed |= ssd1306_ValueSetText(&dash->TempValue, text);
+            changed |= ssd1306_ValueSetText(&dash->HumValue, text);
+        }
+        // Đồ thị chỉ dịch cột khi có điểm mới
+        changed |= ssd1306_PlotUpdate(&dash->TempPlot);
+    }
+
+    // Gas và marker mức nguy hiểm
+    if (events & (DASH_EVENT_GAS | DASH_EVENT_ALARM)) {
+        if (readings->GasOk) {
+            changed |= ssd1306_MarkerSet(&dash->GasMarker, readings->GasLevel);
+            changed |= ssd1306_ValueSet(&dash->GasValue, FMT_Scale(readings->Gas, 1));
+        } else {
+            changed |= ssd1306_MarkerSet(&dash->GasMarker, 0);
+            changed |= ssd1306_ValueSetText(&dash->GasValue, "Cal...");
+        }
+        changed |= ssd1306_PlotUpdate(&dash->GasPlot);
+    }
+
+    return changed;
+}
+
+/**
+  * @brief  Thêm một lần đọc nhiệt độ vào lịch sử đồ thị (x10)
+  * @param  dash: con trỏ đến DASH_Data
+  * @param  temperature: °C
+  * @retval None
+  */
+void DASH_PushTemperature(DASH_Data *dash, float temperature) {
+    ssd1306_HistoryPush(&dash->TempHistory, (int16_t)Clamp(FMT_Scale(temperature, 1), INT16_MIN, INT16_MAX));
+}
+
+/**
+  * @brief  Thêm một lần đọc gas vào lịch sử đồ thị
+  * @param  dash: con trỏ đến DASH_Data
+  * @param  gas: ppm
+  * @retval None
+  * @note   MQ2_CalculatePPM không có trần: cảm biến chập/bão hòa cho hàng chục nghìn ppm,
+  *         giới hạn ở INT16_MAX để đồ thị nằm ở đỉnh thay vì tràn thành số âm
+  */
+void DASH_PushGas(DASH_Data *dash, float gas) {
+    ssd1306_HistoryPush(&dash->GasHistory, (int16_t)Clamp(FMT_Scale(gas, 0), 0, INT16_MAX));
+}
@@ -0,0 +1,422 @@
+/**
+  ******************************************************************************
+  * @file           : flash_log.c
+  * @brief          : Nhật ký bản ghi cảm biến trong flash nội, giữ qua mất điện
+  * @created        : Oct 18, 2026
+  * @author         : NguyenHoa
+  * @version        : 1.1.0
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "flash_log.h"
+#include <string.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define FLOG_MAGIC 0x474F4C46u     // "FLOG"
+#define FLOG_BLANK 0xFFFFFFFFu
+
+/* Trạng thái sector kế tiếp (FLOG_Prepare) */
+#define FLOG_NEXT_UNKNOWN 0        // Chưa xóa sẵn, FLOG_Append xóa khi chuyển sector
+#define FLOG_NEXT_ERASED 1         // Đã xóa sẵn
+#define FLOG_NEXT_FAILED 2         // Xóa sẵn bị lỗi, FLOG_Append thử lại
+
+/* Private macros ------------------------------------------------------------*/
+#define FLOG_SECTOR_ADDR(s) (FLOG_BASE + (uint32_t)(s) * FLOG_SECTOR_SIZE)
+#define FLOG_SLOT_ADDR(s, i) (FLOG_SECTOR_ADDR(s) + FLOG_HEADER_SIZE + (uint32_t)(i) * FLOG_SLOT_SIZE)
+#define FLOG_WORD(addr) (*(const volatile uint32_t *)(addr))
+
+/* Private function prototypes -----------------------------------------------*/
+static void FLOG_StartSector(FLOG_Data *flog, uint8_t sector);
+static HAL_StatusTypeDef FLOG_ClearSector(FLOG_Data *flog, uint8_t sector);
+static void FLOG_SaveAcked(FLOG_Data *flog, uint32_t currentTime);
+static uint16_t FLOG_SlotCrc(uint32_t seq, const uint8_t *slot);
+static HAL_StatusTypeDef FLOG_Program(uint32_t address, const uint32_t *words, uint8_t count);
+static HAL_StatusTypeDef FLOG_Erase(uint32_t sector, uint32_t address);
+static uint8_t FLOG_IsBlank(uint32_t address, uint32_t size);
+
+/**
+  * @brief  Đọc nhật ký trong flash: tìm sector đang ghi, ô trống kế tiếp
+  *         và điểm xác nhận đã lưu
+  * @note   Chỉ đọc, không xóa hay ghi gì. Flash chưa có nhật ký thì Seq bắt
+  *         đầu từ 0, sector đầu tiên được chuẩn bị ở lần FLOG_Append đầu.
+  * @param  flog: nhật ký
+  * @retval None
+  */
+void FLOG_Init(FLOG_Data *flog) {
+    memset(flog, 0, sizeof(*flog));
+
+    uint8_t found = 0;
+    for (uint8_t s = 0; s < FLOG_SECTOR_COUNT; s++) {
+        const uint32_t base = FLOG_SECTOR_ADDR(s);
+        const uint32_t magic = FLOG_WORD(base);
+        const uint32_t firstSeq = FLOG_WORD(base + 4);
+        const uint32_t eraseCount = FLOG_WORD(base + 8);
+
+        if (magic != FLOG_MAGIC || FLOG_WORD(base + 12) != ~(magic ^ firstSeq ^ eraseCount)) {
+            continue;
+        }
+        flog->_valid[s] = 1;
+        flog->_firstSeq[s] = firstSeq;
+        flog->_eraseCount[s] = eraseCount;
+        if (eraseCount > flog->Stats.MaxEraseCount) {
+            flog->Stats.MaxEraseCount = eraseCount;
+        }
+        // Sector đang ghi là sector có FirstSeq mới nhất
+        if (!found || (int32_t)(firstSeq - flog->_firstSeq[flog->_current]) > 0) {
+            flog->_current = s;
+            found = 1;
+        }
+    }
+
+    if (found) {
+        // Ô trống kế tiếp: sau ô đã ghi cuối cùng (kể cả ô ghi dở)
+        uint16_t slot = FLOG_SLOTS;
+        while (slot > 0 && FLOG_IsBlank(FLOG_SLOT_ADDR(flog->_current, slot - 1), FLOG_SLOT_SIZE)) {
+            slot--;
+        }
+        flog->_slot = slot;
+        flog->_head = flog->_firstSeq[flog->_current] + slot;
+    } else {
+        // Chưa có nhật ký: sector cuối coi như đầy để lần ghi đầu chuyển sang sector 0
+        flog->_current = FLOG_SECTOR_COUNT - 1;
+        flog->_slot = FLOG_SLOTS;
+    }
+
+    // Điểm xác nhận: cặp hợp lệ cuối cùng trước cặp trống đầu tiên
+    flog->_acked = FLOG_Oldest(flog);
+    uint32_t i;
+    for (i = 0; i < FLOG_CHECKPOINTS; i++) {
+        const uint32_t seq = FLOG_WORD(FLOG_CHECKPOINT_BASE + i * 8);
+        const uint32_t check = FLOG_WORD(FLOG_CHECKPOINT_BASE + i * 8 + 4);
+        if (seq == FLOG_BLANK && check == FLOG_BLANK) {
+            break;
+        }
+        if (check == ~seq && seq - flog->_acked <= flog->_head - flog->_acked) {
+            flog->_acked = seq;
+        }
+    }
+    flog->_checkpoint = i;
+    flog->_savedAcked = flog->_acked;
+}
+
+/**
+  * @brief  Ghi một bản ghi vào ô kế tiếp
+  * @note   Ghi 3 word (~50 us). Sector đầy mà sector kế tiếp chưa được
+  *         FLOG_Prepare xóa sẵn thì xóa ngay tại đây (CPU dừng ~1-2 giây),
+  *         bản ghi chưa xác nhận trong đó bị mất, FLOG_Oldest tăng.
+  * @param  flog: nhật ký
+  * @param  record: bản ghi
+  * @retval Seq của bản ghi
+  */
+uint32_t FLOG_Append(FLOG_Data *flog, const TELEM_Record *record) {
+    uint8_t slot[FLOG_SLOT_SIZE];
+    uint32_t words[FLOG_SLOT_SIZE / 4];
+
+    if (flog->_slot >= FLOG_SLOTS) {
+        FLOG_StartSector(flog, (uint8_t)((flog->_current + 1) % FLOG_SECTOR_COUNT));
+    }
+
+    const uint32_t seq = flog->_head;
+    if (flog->_valid[flog->_current]) {
+        memcpy(&slot[0], &record->TimeMs, 4);
+        memcpy(&slot[4], &record->TempX10, 2);
+        memcpy(&slot[6], &record->GasPpm, 2);
+        slot[8] = record->Flags;
+        slot[9] = record->Humidity;
+        const uint16_t crc = FLOG_SlotCrc(seq, slot);
+        slot[10] = (uint8_t)crc;
+        slot[11] = (uint8_t)(crc >> 8);
+        memcpy(words, slot, sizeof(words));
+
+        // Word chứa CRC ghi sau cùng: mất điện giữa chừng thì ô sai CRC
+        if (FLOG_Program(FLOG_SLOT_ADDR(flog->_current, flog->_slot), words, 3) != HAL_OK) {
+            flog->Stats.WriteErrors++;
+        }
+    }
+
+    flog->_slot++;
+    flog->_head++;
+    flog->Stats.Records++;
+    return seq;
+}
+
+/**
+  * @brief  Xóa sẵn sector kế tiếp khi sector đang ghi đã qua FLOG_PREPARE_SLOTS
+  * @note   Xóa làm CPU dừng ~1-2 giây (lâu hơn khi flash đã mòn). Gọi từ vòng
+  *         lặp chính lúc chấp nhận được việc dừng đó để FLOG_Append chỉ còn
+  *         ghi đầu sector. Bản ghi chưa xác nhận trong sector bị xóa mất sớm
+  *         hơn một chút (Stats.Overwritten), FLOG_Oldest tăng.
+  * @param  flog: nhật ký
+  * @retval 1 nếu đã xóa (hoặc thử xóa) ở lần gọi này
+  */
+uint8_t FLOG_Prepare(FLOG_Data *flog) {
+    if (flog->_slot < FLOG_PREPARE_SLOTS || flog->_next != FLOG_NEXT_UNKNOWN) {
+        return 0;
+    }
+    const uint8_t next = (uint8_t)((flog->_current + 1) % FLOG_SECTOR_COUNT);
+    flog->_next = (FLOG_ClearSector(flog, next) == HAL_OK) ? FLOG_NEXT_ERASED : FLOG_NEXT_FAILED;
+    return 1;
+}
+
+/**
+  * @brief  Đọc bản ghi theo Seq
+  * @param  flog: nhật ký
+  * @param  seq: Seq cần đọc
+  * @param  record: bản ghi đọc được
+  * @retval 1 nếu có bản ghi hợp lệ, 0 nếu đã bị xóa, chưa ghi hoặc ghi dở
+  */
+uint8_t FLOG_Read(const FLOG_Data *flog, uint32_t seq, TELEM_Record *record) {
+    uint8_t slot[FLOG_SLOT_SIZE];
+
+    for (uint8_t s = 0; s < FLOG_SECTOR_COUNT; s++) {
+        const uint32_t index = seq - flog->_firstSeq[s];
+        if (!flog->_valid[s] || index >= FLOG_SLOTS || (s == flog->_current && index >= flog->_slot)) {
+            continue;
+        }
+
+        memcpy(slot, (const void *)FLOG_SLOT_ADDR(s, index), sizeof(slot));
+        if (FLOG_SlotCrc(seq, slot) != (uint16_t)(slot[10] | (slot[11] << 8))) {
+            return 0;
+        }
+        memcpy(&record->TimeMs, &slot[0], 4);
+        memcpy(&record->TempX10, &slot[4], 2);
+        memcpy(&record->GasPpm, &slot[6], 2);
+        record->Flags = slot[8];
+        record->Humidity = slot[9];
+        return 1;
+    }
+    return 0;
+}
+
+/**
+  * @brief  Seq của bản ghi kế tiếp
+  * @param  flog: nhật ký
+  * @retval Seq
+  */
+uint32_t FLOG_Head(const FLOG_Data *flog) {
+    return flog->_head;
+}
+
+/**
+  * @brief  Seq của bản ghi cũ nhất còn trong flash
+  * @param  flog: nhật ký
+  * @retval Seq, bằng FLOG_Head nếu nhật ký rỗng
+  */
+uint32_t FLOG_Oldest(const FLOG_Data *flog) {
+    uint32_t oldest = flog->_head;
+
+    for (uint8_t s = 0; s < FLOG_SECTOR_COUNT; s++) {
+        if (flog->_valid[s] && flog->_head - flog->_firstSeq[s] > flog->_head - oldest
+                && flog->_head - flog->_firstSeq[s] <= FLOG_CAPACITY) {
+            oldest = flog->_firstSeq[s];
+        }
+    }
+    return oldest;
+}
+
+/**
+  * @brief  Cập nhật điểm xác nhận của ESP, lưu vào flash khi đủ điều kiện
+  * @param  flog: nhật ký
+  * @param  acked: Seq đầu tiên ESP chưa xác nhận
+  * @param  currentTime: thời gian hiện tại từ HAL_GetTick()
+  * @retval None
+  */
+void FLOG_SetAcked(FLOG_Data *flog, uint32_t acked, uint32_t currentTime) {
+    const uint32_t oldest = FLOG_Oldest(flog);
+
+    if (acked - oldest > flog->_head - oldest) {
+        return;
+    }
+    flog->_acked = acked;
+
+    if (acked != flog->_savedAcked
+            && (acked - flog->_savedAcked >= FLOG_CHECKPOINT_RECORDS
+                || currentTime - flog->_savedTime >= FLOG_CHECKPOINT_INTERVAL)) {
+        FLOG_SaveAcked(flog, currentTime);
+    }
+}
+
+/**
+  * @brief  Seq đầu tiên ESP chưa xác nhận
+  * @param  flog: nhật ký
+  * @retval Seq
+  */
+uint32_t FLOG_Acked(const FLOG_Data *flog) {
+    return flog->_acked;
+}
+
+/**
+  * @brief  Xóa sector (nếu FLOG_Prepare chưa xóa sẵn) và ghi đầu sector,
+  *         bản ghi kế tiếp vào ô 0
+  * @param  flog: nhật ký
+  * @param  sector: chỉ số sector bản ghi, 0..FLOG_SECTOR_COUNT-1
+  * @retval None
+  */
+static void FLOG_StartSector(FLOG_Data *flog, uint8_t sector) {
+    const uint32_t base = FLOG_SECTOR_ADDR(sector);
+    const uint8_t erased = (flog->_next == FLOG_NEXT_ERASED);
+
+    flog->_next = FLOG_NEXT_UNKNOWN;
+    flog->_current = sector;
+    flog->_slot = 0;
+
+    if (!erased && FLOG_ClearSector(flog, sector) != HAL_OK) {
+        // Sector hỏng: bỏ qua đến lần xoay vòng sau, bản ghi chỉ còn trong RAM
+        return;
+    }
+
+    // Magic ghi sau cùng: mất điện giữa chừng thì sector được coi như chưa dùng
+    const uint32_t eraseCount = flog->_eraseCount[sector];
+    const uint32_t header[4] = { FLOG_MAGIC, flog->_head, eraseCount, ~(FLOG_MAGIC ^ flog->_head ^ eraseCount) };
+    if (FLOG_Program(base + 4, &header[1], 3) != HAL_OK || FLOG_Program(base, &header[0], 1) != HAL_OK) {
+        flog->Stats.WriteErrors++;
+        return;
+    }
+    flog->_valid[sector] = 1;
+    flog->_firstSeq[sector] = flog->_head;
+    if (eraseCount > flog->Stats.MaxEraseCount) {
+        flog->Stats.MaxEraseCount = eraseCount;
+    }
+}
+
+/**
+  * @brief  Bỏ bản ghi của sector và xóa sector nếu chưa trống
+  * @note   _eraseCount[sector] là số lần xóa sẽ ghi vào đầu sector
+  * @param  flog: nhật ký
+  * @param  sector: chỉ số sector bản ghi, 0..FLOG_SECTOR_COUNT-1
+  * @retval HAL_OK nếu sector đã trống
+  */
+static HAL_StatusTypeDef FLOG_ClearSector(FLOG_Data *flog, uint8_t sector) {
+    const uint32_t base = FLOG_SECTOR_ADDR(sector);
+
+    if (flog->_valid[sector]) {
+        // Bản ghi chưa xác nhận trong sector sắp xóa
+        const uint32_t end = flog->_firstSeq[sector] + FLOG_SLOTS;
+        if ((int32_t)(end - flog->_acked) > 0) {
+            flog->Stats.Overwritten += end - flog->_acked;
+            flog->_acked = end;
+        }
+        flog->_valid[sector] = 0;
+    } else {
+        flog->_eraseCount[sector] = flog->Stats.MaxEraseCount;
+    }
+
+    if (!FLOG_IsBlank(base, FLOG_SECTOR_SIZE)) {
+        flog->_eraseCount[sector]++;
+        flog->Stats.Erases++;
+        if (FLOG_Erase(FLOG_FIRST_SECTOR + sector, base) != HAL_OK) {
+            flog->Stats.WriteErrors++;
+            return HAL_ERROR;
+        }
+    }
+    return HAL_OK;
+}
+
+/**
+  * @brief  Ghi acked vào sector điểm xác nhận, sector đầy thì xóa và ghi lại từ đầu
+  * @note   Mất điện khi đang xóa thì mất điểm xác nhận: lần khởi động sau
+  *         gửi lại từ bản ghi cũ nhất (trùng chứ không mất)
+  * @param  flog: nhật ký
+  * @param  currentTime: thời gian hiện tại từ HAL_GetTick()
+  * @retval None
+  */
+static void FLOG_SaveAcked(FLOG_Data *flog, uint32_t currentTime) {
+    if (flog->_checkpoint >= FLOG_CHECKPOINTS) {
+        flog->Stats.Erases++;
+        if (FLOG_Erase(FLOG_CHECKPOINT_SECTOR, FLOG_CHECKPOINT_BASE) != HAL_OK) {
+            flog->Stats.WriteErrors++;
+            return;
+        }
+        flog->_checkpoint = 0;
+    }
+
+    const uint32_t pair[2] = { flog->_acked, ~flog->_acked };
+    if (FLOG_Program(FLOG_CHECKPOINT_BASE + flog->_checkpoint * 8, pair, 2) != HAL_OK) {
+        flog->Stats.WriteErrors++;
+    }
+    flog->_checkpoint++;
+    flog->_savedAcked = flog->_acked;
+    flog->_savedTime = currentTime;
+    flog->Stats.Checkpoints++;
+}
+
+/**
+  * @brief  CRC của một ô, tính cả Seq để phát hiện ô của lần ghi trước
+  * @param  seq: Seq của ô
+  * @param  slot: 10 byte dữ liệu của ô
+  * @retval CRC16
+  */
+static uint16_t FLOG_SlotCrc(uint32_t seq, const uint8_t *slot) {
+    uint8_t data[4 + 10];
+
+    data[0] = (uint8_t)seq;
+    data[1] = (uint8_t)(seq >> 8);
+    data[2] = (uint8_t)(seq >> 16);
+    data[3] = (uint8_t)(seq >> 24);
+    memcpy(&data[4], slot, 10);
+    return TELEM_Crc16(data, sizeof(data));
+}
+
+/**
+  * @brief  Ghi các word liên tiếp vào flash đã xóa
+  * @param  address: địa chỉ, chia hết cho 4
+  * @param  words: dữ liệu
+  * @param  count: số word
+  * @retval HAL_OK nếu ghi được hết
+  */
+static HAL_StatusTypeDef FLOG_Program(uint32_t address, const uint32_t *words, uint8_t count) {
+    HAL_StatusTypeDef status = HAL_OK;
+
+    HAL_FLASH_Unlock();
+    for (uint8_t i = 0; i < count && status == HAL_OK; i++) {
+        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address + i * 4u, words[i]);
+    }
+    HAL_FLASH_Lock();
+
+    // Data cache của ART có thể còn giữ giá trị 0xFF cũ của các word vừa ghi
+    __HAL_FLASH_DATA_CACHE_DISABLE();
+    __HAL_FLASH_DATA_CACHE_RESET();
+    __HAL_FLASH_DATA_CACHE_ENABLE();
+    return status;
+}
+
+/**
+  * @brief  Xóa một sector (CPU dừng đến khi xóa xong)
+  * @param  sector: FLASH_SECTOR_x
+  * @param  address: địa chỉ đầu sector, để kiểm tra lại
+  * @retval HAL_OK nếu xóa được
+  */
+static HAL_StatusTypeDef FLOG_Erase(uint32_t sector, uint32_t address) {
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t sectorError = 0;
+
+    erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+    erase.Sector = sector;
+    erase.NbSectors = 1;
+    erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+    HAL_FLASH_Unlock();
+    HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&erase, &sectorError);
+    HAL_FLASH_Lock();
+
+    if (status == HAL_OK && !FLOG_IsBlank(address, FLOG_HEADER_SIZE)) {
+        status = HAL_ERROR;
+    }
+    return status;
+}
+
+/**
+  * @brief  Kiểm tra vùng flash còn trống (toàn 0xFF)
+  * @param  address: địa chỉ, chia hết cho 4
+  * @param  size: số byte, chia hết cho 4
+  * @retval 1 nếu trống
+  */
+static uint8_t FLOG_IsBlank(uint32_t address, uint32_t size) {
+    for (uint32_t i = 0; i < size; i += 4) {
+        if (FLOG_WORD(address + i) != FLOG_BLANK) {
+            return 0;
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,198 @@
+/**
+  ******************************************************************************
+  * @file           : fmt.c
+  * @brief          : Định dạng số fixed-point không cấp phát
+  * @created        : Oct 18, 2026
+  * @author         : NguyenHoa
+  * @version        : 1.0.1
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "fmt.h"
+
+/* Private defines -----------------------------------------------------------*/
+#define FMT_DIGITS_MAX 12          // Đủ cho uint32_t và dấu thập phân
+
+/* Private variables ---------------------------------------------------------*/
+static const uint32_t Pow10[FMT_MAX_DECIMALS + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000
+};
+
+/**
+  * @brief  Đổi float sang số nguyên theo đơn vị 10^-decimals
+  * @param  value: giá trị cần đổi
+  * @param  decimals: số chữ số thập phân
+  * @retval Giá trị đã làm tròn (nửa xa số 0), ví dụ 25.36 với 1 -> 254, -0.45 -> -5
+  * @note   Khác với ép kiểu (int), không mất dấu của giá trị trong (-1, 0)
+  * @note   NaN (ví dụ cảm biến lỗi) trả về 0, ngoài khoảng int32_t thì bão hòa
+  */
+int32_t FMT_Scale(float value, uint8_t decimals) {
+    if (decimals > FMT_MAX_DECIMALS) {
+        decimals = FMT_MAX_DECIMALS;
+    }
+    if (value != value) {
+        return 0;               // NaN: ép kiểu sang int32_t là undefined
+    }
+
+    float scaled = value * (float)Pow10[decimals];
+    if (scaled >= 2147483647.0f) {
+        return INT32_MAX;
+    }
+    if (scaled <= -2147483648.0f) {
+        return INT32_MIN;
+    }
+    return (int32_t)(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+}
+
+/**
+  * @brief  Ghi số fixed-point vào bộ đệm
+  * @param  buf: bộ đệm đích
+  * @param  size: kích thước bộ đệm (kể cả '\0')
+  * @param  value: giá trị theo đơn vị 10^-decimals, ví dụ -5 với 1 -> "-0.5"
+  * @param  decimals: số chữ số thập phân (0 = số nguyên)
+  * @param  width: độ rộng tối thiểu, thêm khoảng trắng bên trái
+  * @retval Số ký tự đã ghi (không kể '\0'), 0 nếu không đủ chỗ
+  */
+uint16_t FMT_Fixed(char *buf, uint16_t size, int32_t value, uint8_t decimals, uint8_t width) {
+    char digits[FMT_DIGITS_MAX];
+    uint8_t n = 0;
+
+    if (decimals > FMT_MAX_DECIMALS) {
+        decimals = FMT_MAX_DECIMALS;
+    }
+
+    /* Dấu và độ lớn tách riêng, INT32_MIN vẫn đúng */
+    const uint8_t negative = (value < 0);
+    uint32_t mag = negative ? 0u - (uint32_t)value : (uint32_t)value;
+
+    /* Ghi chữ số từ phải sang trái, luôn có chữ số trước dấu chấm ("0.5") */
+    const uint8_t min_n = decimals ? decimals + 2 : 1;
+    do {
+        digits[n++] = (char)('0' + mag % 10);
+        mag /= 10;
+        if (n == decimals) {
+            digits[n++] = '.';
+        }
+    } while (mag > 0 || n < min_n);
+
+    uint16_t len = n + negative;
+    uint16_t pad = (width > len) ? width - len : 0;
+    if (size == 0 || len + pad >= size) {
+        if (size > 0) {
+            buf[0] = '\0';
+        }
+        return 0;
+    }
+
+    char *p = buf;
+    while (pad--) {
+        *p++ = ' ';
+    }
+    if (negative) {
+        *p++ = '-';
+    }
+    while (n > 0) {
+        *p++ = digits[--n];
+    }
+    *p = '\0';
+    return (uint16_t)(p - buf);
+}
+
+/**
+  * @brief  Bắt đầu ghi vào bộ đệm của người gọi
+  * @param  b: con trỏ đến FMT_Buffer
+  * @param  buf: bộ đệm đích
+  * @param  size: kích thước bộ đệm (kể cả '\0')
+  * @retval None
+  */
+void FMT_Init(FMT_Buffer *b, char *buf, uint16_t size) {
+    b->Buf = buf;
+    b->Size = size;
+    b->Len = 0;
+    b->Overflow = (size == 0);
+    if (size > 0) {
+        buf[0] = '\0';
+    }
+}
+
+/**
+  * @brief  Nối chuỗi, cắt bớt nếu thiếu chỗ
+  * @param  b: con trỏ đến FMT_Buffer
+  * @param  str: chuỗi cần nối
+  * @retval None
+  */
+void FMT_PutStr(FMT_Buffer *b, const char *str) {
+    if (b->Size == 0) {
+        return;
+    }
+    while (*str) {
+        if (b->Len + 1 >= b->Size) {
+            b->Overflow = 1;
+            break;
+        }
+        b->Buf[b->Len++] = *str++;
+    }
+    b->Buf[b->Len] = '\0';
+}
+
+/**
+  * @brief  Nối một ký tự
+  * @param  b: con trỏ đến FMT_Buffer
+  * @param  ch: ký tự cần nối
+  * @retval None
+  */
+void FMT_PutChar(FMT_Buffer *b, char ch) {
+    const char str[2] = { ch, '\0' };
+    FMT_PutStr(b, str);
+}
+
+/**
+  * @brief  Nối số fixed-point, xem FMT_Fixed
+  * @param  b: con trỏ đến FMT_Buffer
+  * @param  value: giá trị theo đơn vị 10^-decimals
+  * @param  decimals: số chữ số thập phân
+  * @param  width: độ rộng tối thiểu
+  * @retval None
+  * @note   Số không vừa chỗ còn lại thì không ghi gì và đặt Overflow
+  */
+void FMT_PutFixed(FMT_Buffer *b, int32_t value, uint8_t decimals, uint8_t width) {
+    if (b->Size == 0) {
+        return;
+    }
+    uint16_t n = FMT_Fixed(&b->Buf[b->Len], b->Size - b->Len, value, decimals, width);
+    if (n == 0) {
+        b->Overflow = 1;
+        b->Buf[b->Len] = '\0';
+        return;
+    }
+    b->Len += n;
+}
+
+/**
+  * @brief  Nối số nguyên không dấu
+  * @param  b: con trỏ đến FMT_Buffer
+  * @param  value: giá trị
+  * @param  width: độ rộng tối thiểu
+  * @retval None
+  */
+void FMT_PutUint(FMT_Buffer *b, uint32_t value, uint8_t width) {
+    char digits[FMT_DIGITS_MAX];
+    uint8_t n = 0;
+
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (n < width && n < sizeof(digits)) {
+        digits[n++] = ' ';
+    }
+
+    char str[FMT_DIGITS_MAX + 1];
+    uint8_t i = 0;
+    while (n > 0) {
+        str[i++] = digits[--n];
+    }
+    str[i] = '\0';
+    FMT_PutStr(b, str);
+}
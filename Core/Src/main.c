@@ -26,20 +26,55 @@
 #include "ssd1306.h"
 #include <stdio.h>  // Để sử dụng printf (nếu có UART debug)
 #include <string.h> // Để sử dụng strlen
+#include <stdlib.h> // abs
 #include "ssd1306_fonts.h"
+#include "dashboard.h"
+#include "ssd1306_tests.h"
+#include "fmt.h"
+#include "telemetry.h"
+#include "uart_tx.h"
+#include "uart_rx.h"
+#include "sample_log.h"
+#include "flash_log.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
 /* USER CODE BEGIN PTD */
-
+/* Thống kê refresh OLED, xem trong Live Expressions hoặc dòng "OLED: ..." trên UART5 */
+typedef struct {
+    uint32_t Events;          // Số lần OLED_Notify
+    uint32_t Frames;          // Frame đã gửi
+    uint32_t Heartbeats;      // Trong đó frame heartbeat (gửi lại cả màn hình)
+    uint32_t Unchanged;       // Lần vẽ theo sự kiện nhưng màn hình không đổi, không gửi gì
+    uint16_t FpsX100;         // Tốc độ refresh thực tế trong chu kỳ thống kê gần nhất, x100
+    uint16_t BusPermille;     // Tỉ lệ thời gian I2C1 bận gửi frame trong chu kỳ đó, phần nghìn
+    uint32_t BusBytes;        // Byte screenbuffer đã gửi trong chu kỳ đó
+} OLED_Stats;
 /* USER CODE END PTD */
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-#define DHT11_READ_INTERVAL 2000  // Đọc DHT11 mỗi 2 giây (theo datasheet)
-#define OLED_UPDATE_INTERVAL 200  // Cập nhật OLED mỗi 200ms
-#define MQ2_READ_INTERVAL 1000    // Đọc MQ2 mỗi 1 giây
-#define UART_SEND_INTERVAL 2000   // Gửi dữ liệu qua UART mỗi 2 giây
+#define DHT11_READ_INTERVAL 2000  // Mặc định đọc DHT11 mỗi 2 giây (theo datasheet)
+#define OLED_MAX_FPS 10           // Tối đa 10 frame/giây khi dữ liệu đổi liên tục
+#define OLED_HEARTBEAT_INTERVAL 10000  // Không có frame nào trong 10 giây: gửi lại cả màn hình
+#define OLED_STATS_INTERVAL 10000 // Tính và gửi thống kê OLED qua UART5 mỗi 10 giây
+#define MQ2_READ_INTERVAL 1000    // Mặc định đọc MQ2 mỗi 1 giây
+#define UART_SEND_INTERVAL 2000   // Mặc định gửi dữ liệu qua UART mỗi 2 giây
+
+/* Chỉ ghi lần đọc vào sampleLog khi có thay đổi đáng kể so với bản ghi trước */
+#define SAMPLE_DEADBAND_TEMP 5    // 0.1 C: ghi khi nhiệt độ lệch quá 0.5 C
+#define SAMPLE_DEADBAND_HUMID 2   // %: ghi khi độ ẩm lệch quá 2 %
+#define SAMPLE_DEADBAND_GAS 20    // ppm: ghi khi gas lệch quá 20 ppm
+#define SAMPLE_HEARTBEAT 60000    // ms im lặng tối đa, quá thì ghi dù không đổi; 0: ghi mọi lần đọc
+
+/* Giới hạn chu kỳ đổi được bằng lệnh TELEM_CMD_SET_INTERVAL từ ESP (ms) */
+#define DHT11_INTERVAL_MIN 1000   // DHT11 cần ít nhất 1 giây giữa hai lần đọc
+#define MQ2_INTERVAL_MIN 200
+#define UART_INTERVAL_MIN 200
+#define INTERVAL_MAX 60000
+#define UART_STATS_INTERVAL 10000 // Gửi thống kê hàng đợi UART5 mỗi 10 giây nếu có frame bị bỏ hoặc lỗi
+#define UART_LINK_BAUD 115200     // Tốc độ UART5 với ESP: 500000 khi ESP dùng UART phần cứng (LINK_HW_UART 1), phải bằng LINK_BAUD bên ESP
+#define OLED_BENCHMARK 0          // 1: chạy benchmark OLED lúc khởi động, kết quả "BENCH,..." qua UART5
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -51,10 +86,13 @@
 ADC_HandleTypeDef hadc1;
 
 I2C_HandleTypeDef hi2c1;
+DMA_HandleTypeDef hdma_i2c1_tx;
 
 TIM_HandleTypeDef htim4;
 
 UART_HandleTypeDef huart5;
+DMA_HandleTypeDef hdma_uart5_rx;
+DMA_HandleTypeDef hdma_uart5_tx;
 
 /* USER CODE BEGIN PV */
 DHT11_Data dht11Data;
@@ -74,23 +112,73 @@ volatile float currentLPGValue = 0.0f;
 volatile float currentSmokeValue = 0.0f;
 volatile MQ2_GasLevelTypeDef currentGasLevel = MQ2_LEVEL_NORMAL;
 volatile MQ2_StatusTypeDef mq2Status = MQ2_OK;
+MQ2_Snapshot mq2Snapshot;  // Mẫu MQ2 đã xử lý gần nhất (timestamp + sequence)
 
 /* UART variables */
 uint32_t lastUartSendTime = 0;  // Biến theo dõi thời gian gửi UART
+SLOG_Data sampleLog;            // Mọi lần đọc cảm biến, giữ đến khi ESP xác nhận
+FLOG_Data flashLog;             // Bản sao của sampleLog trong flash, giữ qua mất điện
+uint32_t sampleBootSeq = 0;     // Seq của bản ghi đầu tiên từ lần khởi động này, gửi trong STATS
+uint8_t sampleNewFlags = 0;     // TELEM_FLAG_*_NEW: cảm biến có lần đọc chưa ghi vào sampleLog
+uint32_t sampleReadings = 0;    // Lần đọc đã xét trong SAMPLE_Record
+uint32_t sampleSuppressed = 0;  // Trong đó số lần không ghi vì nằm trong deadband
+UARTTX_Data uartTx;             // Hàng đợi gửi UART5 qua DMA, thống kê trong uartTx.Stats
+UARTRX_Data uartRx;             // Nhận lệnh từ ESP qua DMA vòng, thống kê trong uartRx.Stats
+uint32_t uartRxFrames = 0;      // Frame nhận đúng CRC
+uint32_t uartRxBadFrames = 0;   // Frame nhận hỏng (COBS/CRC)
+uint32_t uartRxBadVersion = 0;  // Frame đúng CRC nhưng khác TELEM_PROTOCOL_VERSION
+uint8_t uartVersionReported = 0; // Đã báo ESP sai version, chờ frame đúng version
+
+/* Chu kỳ hiện tại, ESP đổi được bằng lệnh TELEM_CMD_SET_INTERVAL */
+uint16_t dht11ReadInterval = DHT11_READ_INTERVAL;
+uint16_t mq2ReadInterval = MQ2_READ_INTERVAL;
+uint16_t uartSendInterval = UART_SEND_INTERVAL;
+
+/* OLED variables */
+volatile uint8_t oledBusFree = 1;      // 1 khi I2C1 rảnh (DMA flush đã xong)
+uint8_t oledFlushPending = 0;          // Có frame đã vẽ nhưng chưa gửi được
+uint8_t oledEvents = 0;                // Sự kiện DASH_EVENT_* chưa vẽ, DASH_EVENT_ALARM vẽ ngay không chờ giới hạn FPS
+OLED_Stats oledStats;                  // Thống kê refresh OLED
+static uint32_t oledBusyStart;         // DWT->CYCCNT lúc bắt đầu flush
+static volatile uint32_t oledBusyCycles;  // Chu kỳ CPU I2C1 bận flush, cộng dồn trong ngắt
+
+/* Màn hình OLED - bố cục dựng một lần, mỗi widget chỉ vẽ lại khi giá trị đổi */
+DASH_Data oledDash;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_TIM4_Init(void);
 static void MX_I2C1_Init(void);
 static void MX_ADC1_Init(void);
 static void MX_UART5_Init(void);
 /* USER CODE BEGIN PFP */
 void DHT11_ProcessReading(uint32_t currentTime);
+void OLED_InitLayout(void);
 void OLED_ProcessUpdate(uint32_t currentTime);
+void OLED_Notify(uint8_t events);
+void OLED_StatsInit(void);
 void MQ2_ProcessReading(uint32_t currentTime);
+void SAMPLE_Record(uint32_t currentTime);
+static uint8_t SAMPLE_IsReportable(const TELEM_Record *record);
+void SAMPLE_PrepareFlash(void);
+static uint8_t SAMPLE_ReadFlash(uint32_t seq, TELEM_Record *record);
+static void SAMPLE_SendLogInfo(void);
 void UART_SendSensorData(uint32_t currentTime);
+void UART_SendFrame(const uint8_t *frame, uint16_t len);
+void UART_SendText(const char *text);
+static void UART_UpdateStats(uint32_t currentTime);
+void UART_HandleFrame(const uint8_t *frame, uint16_t len);
+static void UART_HandleCommand(const uint8_t *payload, uint16_t len);
+static void UART_ReportVersion(uint8_t version);
+static uint8_t UART_SetInterval(uint8_t target, uint16_t value);
+static void UART_SendStats(uint8_t seq);
+void MQ2_ProcessCalibration(uint32_t currentTime);
+void OLED_Flush(void);
+static uint8_t OLED_Render(uint8_t events);
+static void OLED_UpdateStats(uint32_t currentTime);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -103,8 +191,8 @@ void UART_SendSensorData(uint32_t currentTime);
 void DHT11_ProcessReading(uint32_t currentTime) {
     static uint32_t lastReadTime = 0;
 
-    /* Kiểm tra interval 2 giây */
-    if (currentTime - lastReadTime >= DHT11_READ_INTERVAL) {
+    /* Kiểm tra chu kỳ đọc (mặc định 2 giây) */
+    if (currentTime - lastReadTime >= dht11ReadInterval) {
         lastReadTime = currentTime;
         readCount++;
 
@@ -117,11 +205,18 @@ void DHT11_ProcessReading(uint32_t currentTime) {
             currentTemperature = dht11Data.Temperature;
             currentHumidity = dht11Data.Humidity;
             isChecksumValid = dht11Data.CheckSum_OK;
+
+            /* Lưu vào lịch sử cho đồ thị (x10) */
+            DASH_PushTemperature(&oledDash, currentTemperature);
         } else {
             /* Có lỗi khi đọc */
             errorCount++;
             isChecksumValid = 0;
         }
+
+        /* Màn hình chỉ vẽ lại khi có kết quả mới */
+        OLED_Notify(DASH_EVENT_CLIMATE);
+        sampleNewFlags |= TELEM_FLAG_DHT11_NEW;
     }
 }
 
@@ -132,147 +227,588 @@ void DHT11_ProcessReading(uint32_t currentTime) {
   */
 void MQ2_ProcessReading(uint32_t currentTime) {
     static uint32_t lastReadTime = 0;
-    static uint8_t isFirstRead = 1;
 
-    /* Kiểm tra interval 1 giây */
-    if (currentTime - lastReadTime >= MQ2_READ_INTERVAL) {
+    /* Kiểm tra chu kỳ đọc (mặc định 1 giây) */
+    if (currentTime - lastReadTime >= mq2ReadInterval) {
         lastReadTime = currentTime;
 
+        /* Giữ trạng thái cũ để phát hiện cảnh báo đổi */
+        const MQ2_GasLevelTypeDef prevLevel = currentGasLevel;
+        const MQ2_StatusTypeDef prevStatus = mq2Status;
+
         /* Đọc dữ liệu từ MQ2 */
         MQ2_StatusTypeDef status = MQ2_ReadAllValues(&mq2Data);
         mq2Status = status;
 
         if (status == MQ2_OK) {
-            /* Dữ liệu hợp lệ - cập nhật variables */
-            currentGasValue = mq2Data.GasConcentration;
-            currentLPGValue = mq2Data.LPGConcentration;
-            currentSmokeValue = mq2Data.SmokeConcentration;
-            currentGasLevel = mq2Data.Level;
-
-            /* Lần đọc đầu tiên hoặc cần hiệu chuẩn */
-            if (isFirstRead) {
-                isFirstRead = 0;
-
-                /* Hiệu chuẩn cảm biến nếu chưa được hiệu chuẩn */
-                if (!mq2Data._isCalibrated) {
-                    MQ2_Calibrate(&mq2Data);
-                }
-            }
+            /* Dữ liệu hợp lệ - cập nhật variables từ snapshot, không đọc lại ADC */
+            MQ2_GetSnapshot(&mq2Data, &mq2Snapshot);
+            currentGasValue = mq2Snapshot.GasConcentration;
+            currentLPGValue = mq2Snapshot.LPGConcentration;
+            currentSmokeValue = mq2Snapshot.SmokeConcentration;
+            currentGasLevel = mq2Snapshot.Level;
+
+            /* Lưu vào lịch sử cho đồ thị */
+            DASH_PushGas(&oledDash, currentGasValue);
+        }
+
+        if (currentGasLevel != prevLevel || mq2Status != prevStatus) {
+            OLED_Notify(DASH_EVENT_GAS | DASH_EVENT_ALARM);
+        } else {
+            OLED_Notify(DASH_EVENT_GAS);
         }
+        sampleNewFlags |= TELEM_FLAG_MQ2_NEW;
+    }
+}
+
+/**
+  * @brief  Chạy hiệu chuẩn MQ2 từng bước, mỗi lần gọi nhiều nhất một lần đọc ADC
+  * @note   Thay cho MQ2_Calibrate chặn ~1 giây, để DHT11/OLED/UART vẫn đúng nhịp
+  * @param  currentTime: thời gian hiện tại từ HAL_GetTick()
+  * @retval None
+  */
+void MQ2_ProcessCalibration(uint32_t currentTime) {
+    if (!mq2Data._isCalibrating) {
+        return;
+    }
+
+    MQ2_StatusTypeDef status = MQ2_CalibrateStep(&mq2Data, currentTime);
+    if (status == MQ2_BUSY) {
+        return;
+    }
+    UART_SendText(status == MQ2_OK ? "MQ2: hiệu chuẩn xong" : "MQ2: hiệu chuẩn lỗi");
+}
+
+/**
+  * @brief  Dựng bố cục OLED (DASH_Init) và đánh dấu cần gửi cả màn hình
+  * @note   Gọi một lần sau ssd1306_Init
+  * @retval None
+  */
+void OLED_InitLayout(void) {
+    DASH_Init(&oledDash);
+    oledFlushPending = 1;
+}
+
+/**
+  * @brief  Báo dữ liệu hiển thị đã đổi
+  * @param  events: các bit DASH_EVENT_*
+  * @retval None
+  */
+void OLED_Notify(uint8_t events) {
+    oledEvents |= events;
+    oledStats.Events++;
+}
+
+/**
+  * @brief  Vẽ lại các widget thuộc các sự kiện vào screenbuffer
+  * @param  events: các bit DASH_EVENT_*
+  * @retval 1 nếu screenbuffer thay đổi
+  */
+static uint8_t OLED_Render(uint8_t events) {
+    DASH_Readings readings;
+
+    if (readCount <= 1) {
+        readings.Climate = DASH_CLIMATE_INIT;
+    } else {
+        readings.Climate = (lastStatus == DHT11_OK) ? DASH_CLIMATE_OK : DASH_CLIMATE_ERROR;
     }
+    readings.Temperature = currentTemperature;
+    readings.Humidity = currentHumidity;
+    readings.GasOk = (mq2Status == MQ2_OK);
+    readings.Gas = currentGasValue;
+    readings.GasLevel = (uint8_t)currentGasLevel;
+
+    return DASH_Render(&oledDash, events, &readings);
 }
 
 /**
-  * @brief  Cập nhật màn hình OLED
+  * @brief  Cập nhật màn hình OLED theo sự kiện
+  * @note   Chỉ vẽ khi có OLED_Notify, các sự kiện dồn lại trong 1/OLED_MAX_FPS giây
+  *         được vẽ chung một frame (cảnh báo thì vẽ ngay). Không có frame nào trong
+  *         OLED_HEARTBEAT_INTERVAL thì gửi lại cả màn hình, phòng khi panel bị nhiễu/reset.
   * @param  currentTime: thời gian hiện tại từ HAL_GetTick()
   * @retval None
   */
 void OLED_ProcessUpdate(uint32_t currentTime) {
-    static uint32_t lastUpdateTime = 0;
-    char oled_buffer[32];
-
-    //  Kiểm tra interval 200ms
-    if (currentTime - lastUpdateTime >= OLED_UPDATE_INTERVAL) {
-        lastUpdateTime = currentTime;
-
-        // Clear OLED screen
-        ssd1306_Fill(Black);
-
-        // Display Temperature - Dùng integer thay vì float
-        ssd1306_SetCursor(1, 0);
-        if (readCount > 1 && lastStatus == DHT11_OK) {
-            // Hiển thị giá trị với integer
-            int temp_whole = (int)currentTemperature;
-            int temp_frac = (int)((currentTemperature - temp_whole) * 10);
-            snprintf(oled_buffer, sizeof(oled_buffer), "Nhiet Do: %d.%d C", temp_whole, temp_frac);
-        } else {
-            if (readCount <= 1) {
-                snprintf(oled_buffer, sizeof(oled_buffer), "Nhiet Do: Init...");
-            } else {
-                snprintf(oled_buffer, sizeof(oled_buffer), "Nhiet Do: Error");
-            }
-        }
-        ssd1306_WriteString(oled_buffer, Font_7x10, White);
-
-        // Display Humidity - Dùng integer thay vì float
-        ssd1306_SetCursor(1, 15);
-        if (readCount > 1 && lastStatus == DHT11_OK) {
-            // Hiển thị giá trị với integer
-            int hum_whole = (int)currentHumidity;
-            int hum_frac = (int)((currentHumidity - hum_whole) * 10);
-            snprintf(oled_buffer, sizeof(oled_buffer), "Do Am:  %d.%d %%", hum_whole, hum_frac);
-        } else {
-            if (readCount <= 1) {
-                snprintf(oled_buffer, sizeof(oled_buffer), "Do Am:  Init...");
-            } else {
-                snprintf(oled_buffer, sizeof(oled_buffer), "Do Am:  Error");
-            }
-        }
-        ssd1306_WriteString(oled_buffer, Font_7x10, White);
-
-        // Display Gas Level - Thêm dòng thứ 3 cho giá trị gas
-        ssd1306_SetCursor(1, 30);
-        if (mq2Status == MQ2_OK) {
-            int gas_whole = (int)currentGasValue;
-            int gas_frac = (int)((currentGasValue - gas_whole) * 10);
-
-            // Thêm icon hoặc marker cho mức nguy hiểm
-            const char* levelMarker = "";
-            if (currentGasLevel == MQ2_LEVEL_DANGER) {
-                levelMarker = "! ";
-            } else if (currentGasLevel == MQ2_LEVEL_WARNING) {
-                levelMarker = "* ";
-            }
-
-            snprintf(oled_buffer, sizeof(oled_buffer), "%sGas:  %d.%d ppm", levelMarker, gas_whole, gas_frac);
+    static uint32_t lastFrameTime = 0;
+
+    if (currentTime - lastFrameTime >= OLED_HEARTBEAT_INTERVAL && !oledFlushPending) {
+        // Heartbeat: vẽ lại mọi widget và gửi toàn bộ screenbuffer
+        oledEvents |= DASH_EVENT_ALL;
+        OLED_Render(oledEvents);
+        oledEvents = 0;
+        ssd1306_Invalidate();
+        oledFlushPending = 1;
+        oledStats.Heartbeats++;
+    }
+
+    // Sự kiện được vẽ khi bus rảnh, nên trong lúc DMA bận chúng dồn lại
+    if (oledEvents && oledBusFree &&
+        ((oledEvents & DASH_EVENT_ALARM) || currentTime - lastFrameTime >= 1000 / OLED_MAX_FPS)) {
+        if (OLED_Render(oledEvents)) {
+            oledFlushPending = 1;
         } else {
-            snprintf(oled_buffer, sizeof(oled_buffer), "Gas:  Cal...");
+            oledStats.Unchanged++;
         }
-        ssd1306_WriteString(oled_buffer, Font_7x10, White);
+        oledEvents = 0;
+    }
+
+    // Gửi frame khi bus rảnh, nếu đang bận thì thử lại ở vòng lặp sau
+    if (oledFlushPending && oledBusFree) {
+        OLED_Flush();
+        lastFrameTime = currentTime;
+    }
+
+    OLED_UpdateStats(currentTime);
+}
+
+/**
+  * @brief  Bật bộ đếm chu kỳ DWT để đo thời gian I2C1 bận
+  * @retval None
+  */
+void OLED_StatsInit(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    oledBusyCycles = 0;
+}
+
+/**
+  * @brief  Tính FPS và tỉ lệ bận của bus mỗi OLED_STATS_INTERVAL, gửi qua UART5
+  * @note   Dòng "OLED: FPS=0.50, BUS=0.4%, BYTES=1234, HEARTBEATS=1" gửi dạng
+  *         frame TELEM_TYPE_TEXT, ESP in ra Serial
+  * @param  currentTime: thời gian hiện tại từ HAL_GetTick()
+  * @retval None
+  */
+static void OLED_UpdateStats(uint32_t currentTime) {
+    static uint32_t lastStatsTime = 0;
+    static uint32_t lastFrames = 0;
+    static uint32_t lastBytes = 0;
+    SSD1306_FlushStats_t flush;
+    char buffer[80];
+
+    const uint32_t elapsed = currentTime - lastStatsTime;
+    if (elapsed < OLED_STATS_INTERVAL) {
+        return;
+    }
+    lastStatsTime = currentTime;
+
+    // Đọc và xóa số chu kỳ bận cùng lúc, ngắt có thể đang cộng vào
+    __disable_irq();
+    const uint32_t busy = oledBusyCycles;
+    oledBusyCycles = 0;
+    __enable_irq();
+
+    ssd1306_GetFlushStats(&flush);
+    oledStats.FpsX100 = (uint16_t)((oledStats.Frames - lastFrames) * 100000u / elapsed);
+    oledStats.BusPermille = (uint16_t)((uint64_t)busy * 1000u / ((uint64_t)elapsed * (SystemCoreClock / 1000u)));
+    oledStats.BusBytes = flush.BytesSent - lastBytes;
+    lastFrames = oledStats.Frames;
+    lastBytes = flush.BytesSent;
+
+    FMT_Buffer line;
+    FMT_Init(&line, buffer, sizeof(buffer));
+    FMT_PutStr(&line, "OLED: FPS=");
+    FMT_PutFixed(&line, oledStats.FpsX100, 2, 0);
+    FMT_PutStr(&line, ", BUS=");
+    FMT_PutFixed(&line, oledStats.BusPermille, 1, 0);
+    FMT_PutStr(&line, "%, BYTES=");
+    FMT_PutUint(&line, oledStats.BusBytes, 0);
+    FMT_PutStr(&line, ", HEARTBEATS=");
+    FMT_PutUint(&line, oledStats.Heartbeats, 0);
+    UART_SendText(buffer);
+}
 
-        // Update OLED display
-        ssd1306_UpdateScreen();
+/**
+  * @brief  Bắt đầu gửi frame OLED qua I2C1 DMA
+  * @note   Phần đã thay đổi được chép sang front buffer, nên có thể vẽ
+  *         tiếp ngay. oledBusFree được set lại trong ssd1306_FlushCpltCallback.
+  * @retval None
+  */
+void OLED_Flush(void) {
+    oledBusFree = 0;
+    oledBusyStart = DWT->CYCCNT;
+    SSD1306_Error_t status = ssd1306_UpdateScreenAsync();
+
+    if (status == SSD1306_BUSY) {
+        // Flush trước chưa xong, giữ frame lại
+        return;
+    }
+    oledFlushPending = 0;
+    if (status != SSD1306_OK || !ssd1306_IsBusy()) {
+        // Không có gì để gửi hoặc DMA không khởi động được
+        oledBusFree = 1;
+        return;
     }
+    oledStats.Frames++;
 }
 
 /**
-  * @brief  Gửi dữ liệu cảm biến qua UART5 đến ESP
+  * @brief  Xếp một frame đã mã hóa vào hàng đợi gửi UART5
+  * @note   Không chờ đường truyền: DMA gửi trong nền, hàng đợi đầy thì frame
+  *         bị bỏ và đếm vào uartTx.Stats.Dropped
+  * @param  frame: các byte frame, kể cả 0x00 cuối
+  * @param  len: số byte
+  * @retval None
+  */
+void UART_SendFrame(const uint8_t *frame, uint16_t len) {
+    UARTTX_Write(&uartTx, frame, len);
+}
+
+/**
+  * @brief  Gửi một dòng log dạng frame TELEM_TYPE_TEXT
+  * @param  text: chuỗi UTF-8, tối đa TELEM_TEXT_MAX byte
+  * @retval None
+  */
+void UART_SendText(const char *text) {
+    uint8_t frame[TELEM_FRAME_SIZE(TELEM_PAYLOAD_MAX)];
+
+    UART_SendFrame(frame, TELEM_EncodeText(text, frame, sizeof(frame)));
+}
+
+/**
+  * @brief  Giới hạn giá trị vào khoảng [min, max]
+  * @param  value: giá trị
+  * @param  min: cận dưới
+  * @param  max: cận trên
+  * @retval Giá trị đã giới hạn
+  */
+static int32_t Clamp(int32_t value, int32_t min, int32_t max) {
+    return value < min ? min : (value > max ? max : value);
+}
+
+/**
+  * @brief  Ghi một bản ghi vào sampleLog khi DHT11 hoặc MQ2 vừa đọc xong
+  * @note   Hai cảm biến đọc trong cùng một vòng lặp thì chung một bản ghi.
+  *         Bản ghi luôn có cả hai giá trị gần nhất, bit *_NEW cho biết giá trị
+  *         nào là lần đọc mới, bit *_OK cho biết lần đọc gần nhất có lỗi không.
+  *         Lần đọc không đổi đáng kể (SAMPLE_IsReportable) thì bỏ qua, bit
+  *         *_NEW được giữ cho bản ghi kế tiếp.
+  * @param  currentTime: thời gian hiện tại từ HAL_GetTick()
+  * @retval None
+  */
+void SAMPLE_Record(uint32_t currentTime) {
+    TELEM_Record record;
+
+    if (sampleNewFlags == 0) {
+        return;
+    }
+
+    record.TimeMs = currentTime;
+    record.Flags = (uint8_t)(sampleNewFlags | ((currentGasLevel << TELEM_FLAG_LEVEL_POS) & TELEM_FLAG_LEVEL_MASK));
+    if (lastStatus == DHT11_OK) {
+        record.Flags |= TELEM_FLAG_DHT11_OK;
+    }
+    if (mq2Status == MQ2_OK) {
+        record.Flags |= TELEM_FLAG_MQ2_OK;
+    }
+    if (mq2Data._isCalibrated) {
+        record.Flags |= TELEM_FLAG_MQ2_CAL;
+    }
+    record.TempX10 = (int16_t)Clamp(FMT_Scale(currentTemperature, 1), INT16_MIN, INT16_MAX);
+    record.Humidity = (uint8_t)Clamp(FMT_Scale(currentHumidity, 0), 0, 100);
+    record.GasPpm = (uint16_t)Clamp(FMT_Scale(currentGasValue, 0), 0, UINT16_MAX);
+
+    sampleReadings++;
+    if (!SAMPLE_IsReportable(&record)) {
+        sampleSuppressed++;
+        return;
+    }
+
+    /* Ghi vào flash trước, sector đầy thì bản ghi cũ nhất trong flash bị xóa */
+    FLOG_Append(&flashLog, &record);
+    SLOG_Append(&sampleLog, &record);
+    SLOG_Discard(&sampleLog, FLOG_Oldest(&flashLog));
+    sampleNewFlags = 0;
+}
+
+/**
+  * @brief  Xóa sẵn sector nhật ký kế tiếp khi không có cảnh báo gas
+  * @note   Xóa 128 KB làm CPU dừng ~1-2 giây (vài giây khi flash đã mòn):
+  *         cảnh báo gas, nhịp đọc DHT11 và lệnh từ ESP đều chờ. Làm ở đây,
+  *         lúc khí gas bình thường và MQ2 không hiệu chuẩn, để SAMPLE_Record
+  *         không phải xóa đúng lúc đang có cảnh báo. Cảnh báo kéo dài đến khi
+  *         sector đầy thì FLOG_Append vẫn tự xóa.
+  * @retval None
+  */
+void SAMPLE_PrepareFlash(void) {
+    if (currentGasLevel != MQ2_LEVEL_NORMAL || mq2Data._isCalibrating) {
+        return;
+    }
+    if (FLOG_Prepare(&flashLog)) {
+        SLOG_Discard(&sampleLog, FLOG_Oldest(&flashLog));
+    }
+}
+
+/**
+  * @brief  Kiểm tra lần đọc có cần ghi vào sampleLog không (report-by-exception)
+  * @note   Ghi khi nhiệt độ, độ ẩm hoặc gas lệch quá SAMPLE_DEADBAND_* so với
+  *         bản ghi đã ghi trước đó, khi mức gas, trạng thái lỗi hay hiệu chuẩn
+  *         đổi, hoặc đã im lặng SAMPLE_HEARTBEAT. So với bản ghi đã ghi (không
+  *         phải lần đọc trước) nên giá trị trôi chậm vẫn được ghi khi đủ lệch.
+  * @param  record: bản ghi của lần đọc hiện tại
+  * @retval 1 nếu cần ghi
+  */
+static uint8_t SAMPLE_IsReportable(const TELEM_Record *record) {
+    static TELEM_Record last;
+    static uint8_t haveLast = 0;
+    const uint8_t stateMask = TELEM_FLAG_DHT11_OK | TELEM_FLAG_MQ2_OK | TELEM_FLAG_MQ2_CAL | TELEM_FLAG_LEVEL_MASK;
+
+    if (SAMPLE_HEARTBEAT == 0 || !haveLast ||
+        (record->Flags & stateMask) != (last.Flags & stateMask) ||
+        record->TimeMs - last.TimeMs >= SAMPLE_HEARTBEAT ||
+        abs(record->TempX10 - last.TempX10) > SAMPLE_DEADBAND_TEMP ||
+        abs(record->Humidity - last.Humidity) > SAMPLE_DEADBAND_HUMID ||
+        abs(record->GasPpm - last.GasPpm) > SAMPLE_DEADBAND_GAS) {
+        last = *record;
+        haveLast = 1;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+  * @brief  Đọc bản ghi đã rời bộ đệm RAM của sampleLog từ flash (SLOG_Reader)
+  * @param  seq: Seq cần đọc
+  * @param  record: bản ghi
+  * @retval 1 nếu đọc được
+  */
+static uint8_t SAMPLE_ReadFlash(uint32_t seq, TELEM_Record *record) {
+    return FLOG_Read(&flashLog, seq, record);
+}
+
+/**
+  * @brief  Gửi dòng "LOG: SEQ=1234, PENDING=56, ERASES=7" lúc khởi động
+  * @note   PENDING là số bản ghi ESP chưa xác nhận từ lần chạy trước, sẽ
+  *         được gửi bù; ERASES là số lần xóa lớn nhất của một sector flash
+  * @retval None
+  */
+static void SAMPLE_SendLogInfo(void) {
+    char buffer[64];
+    FMT_Buffer line;
+
+    FMT_Init(&line, buffer, sizeof(buffer));
+    FMT_PutStr(&line, "LOG: SEQ=");
+    FMT_PutUint(&line, FLOG_Head(&flashLog), 0);
+    FMT_PutStr(&line, ", PENDING=");
+    FMT_PutUint(&line, SLOG_Pending(&sampleLog), 0);
+    FMT_PutStr(&line, ", ERASES=");
+    FMT_PutUint(&line, flashLog.Stats.MaxEraseCount, 0);
+    UART_SendText(buffer);
+}
+
+/**
+  * @brief  Gửi các bản ghi chưa gửi trong sampleLog qua UART5 đến ESP
+  * @note   Frame TELEM_TYPE_BATCH tối đa TELEM_BATCH_MAX bản ghi, gửi khi đủ
+  *         một frame hoặc đã chờ uartSendInterval (mặc định 2 giây). Bản ghi
+  *         chỉ bỏ khỏi sampleLog khi ESP xác nhận, mất frame thì gửi lại.
+  *         Bản ghi tồn đọng (ESP mất WiFi, khởi động lại) gửi thành frame đầy
+  *         liên tiếp, chỉ bị giới hạn bởi tốc độ ESP xác nhận.
   * @param  currentTime: thời gian hiện tại từ HAL_GetTick()
   * @retval None
   */
 void UART_SendSensorData(uint32_t currentTime) {
-    static uint32_t lastSendTime = 0;
-    char uart_buffer[64];
+    uint8_t frame[TELEM_FRAME_SIZE(TELEM_BATCH_SIZE(TELEM_BATCH_MAX))];
+    TELEM_Record records[TELEM_BATCH_MAX];
+    uint32_t firstSeq;
+    uint8_t batchFlags;
+    uint8_t count;
+
+    while ((count = SLOG_NextBatch(&sampleLog, currentTime, uartSendInterval, records, &firstSeq, &batchFlags)) > 0) {
+        /* Hàng đợi đầy thì frame bị bỏ, sẽ gửi lại khi quá thời gian chờ xác nhận */
+        UART_SendFrame(frame, TELEM_EncodeBatch(firstSeq, batchFlags, records, count, frame, sizeof(frame)));
+
+        /* Hiển thị LED báo đã gửi (tùy chọn) */
+        HAL_GPIO_TogglePin(GPIOD, GPIO_PIN_13);  // Đèn báo UART (nếu có)
+    }
+}
 
-    /* Gửi dữ liệu cảm biến mỗi 2 giây */
-    if (currentTime - lastSendTime >= UART_SEND_INTERVAL) {
-        lastSendTime = currentTime;
+/**
+  * @brief  Gửi thống kê hàng đợi UART5 khi có frame bị bỏ hoặc lỗi mới
+  * @note   Dòng "UART: DROPPED=3, ERRORS=0, PEAK=1024/1024B", chính nó cũng
+  *         đi qua hàng đợi nên chỉ gửi khi bộ đếm đổi
+  * @param  currentTime: thời gian hiện tại từ HAL_GetTick()
+  * @retval None
+  */
+static void UART_UpdateStats(uint32_t currentTime) {
+    static uint32_t lastStatsTime = 0;
+    static uint32_t lastDropped = 0;
+    static uint32_t lastErrors = 0;
+    char buffer[64];
+    FMT_Buffer line;
+
+    if (currentTime - lastStatsTime < UART_STATS_INTERVAL) {
+        return;
+    }
+    lastStatsTime = currentTime;
 
-        /* Chỉ gửi khi đọc cảm biến thành công */
-        if (lastStatus == DHT11_OK && mq2Status == MQ2_OK) {
-            /* Định dạng chuỗi giống như mẫu: "DATA: TEMP=XX°C, HUMID=XX%, GAS=XXXppm" */
-            int temp_whole = (int)currentTemperature;
-            int temp_frac = (int)((currentTemperature - temp_whole) * 10);
+    const UARTTX_Stats *stats = &uartTx.Stats;
+    if (stats->Dropped == lastDropped && stats->Errors == lastErrors) {
+        return;
+    }
+    lastDropped = stats->Dropped;
+    lastErrors = stats->Errors;
+
+    FMT_Init(&line, buffer, sizeof(buffer));
+    FMT_PutStr(&line, "UART: DROPPED=");
+    FMT_PutUint(&line, stats->Dropped, 0);
+    FMT_PutStr(&line, ", ERRORS=");
+    FMT_PutUint(&line, stats->Errors, 0);
+    FMT_PutStr(&line, ", PEAK=");
+    FMT_PutUint(&line, stats->HighWater, 0);
+    FMT_PutChar(&line, '/');
+    FMT_PutUint(&line, UARTTX_BUFFER_SIZE, 0);
+    FMT_PutChar(&line, 'B');
+    UART_SendText(buffer);
+}
 
-            int hum_whole = (int)currentHumidity;
-            int hum_frac = (int)((currentHumidity - hum_whole) * 10);
+/**
+  * @brief  Xử lý một frame nhận từ ESP (gọi trong UARTRX_Process)
+  * @param  frame: các byte giữa hai dấu 0x00
+  * @param  len: số byte
+  * @retval None
+  */
+void UART_HandleFrame(const uint8_t *frame, uint16_t len) {
+    uint8_t payload[TELEM_PAYLOAD_MAX];
+    const uint16_t n = TELEM_DecodeFrame(frame, len, payload, sizeof(payload));
 
-            int gas_whole = (int)currentGasValue;
-            int gas_frac = (int)((currentGasValue - gas_whole) * 10);
+    if (n == 0) {
+        uartRxBadFrames++;
+        return;
+    }
+    uartRxFrames++;
 
-            /* Tạo chuỗi dữ liệu */
-            sprintf(uart_buffer, "DATA: TEMP=%d.%d°C, HUMID=%d.%d%%, GAS=%d.%dppm\r\n",
-                    temp_whole, temp_frac,
-                    hum_whole, hum_frac,
-                    gas_whole, gas_frac);
+    if ((payload[0] >> 4) != TELEM_PROTOCOL_VERSION) {
+        UART_ReportVersion(payload[0] >> 4);
+        return;
+    }
+    uartVersionReported = 0;
+    if ((payload[0] & 0x0F) == TELEM_TYPE_COMMAND) {
+        UART_HandleCommand(payload, n);
+    }
+}
 
-            /* Gửi chuỗi qua UART5 */
-            HAL_UART_Transmit(&huart5, (uint8_t*)uart_buffer, strlen(uart_buffer), HAL_MAX_DELAY);
+/**
+  * @brief  Báo ESP đang dùng giao thức khác version (frame TELEM_TYPE_TEXT)
+  * @note   Dòng "UART: ESP dùng giao thức v1, STM32 dùng v2", chỉ gửi một lần
+  *         đến khi lại nhận được frame đúng version. Lệch version thì mọi lệnh
+  *         của ESP bị bỏ, kể cả ACK_SAMPLES.
+  * @param  version: version trong header của frame
+  * @retval None
+  */
+static void UART_ReportVersion(uint8_t version) {
+    char buffer[64];
+    FMT_Buffer line;
+
+    uartRxBadVersion++;
+    if (uartVersionReported) {
+        return;
+    }
+    uartVersionReported = 1;
+
+    FMT_Init(&line, buffer, sizeof(buffer));
+    FMT_PutStr(&line, "UART: ESP dùng giao thức v");
+    FMT_PutUint(&line, version, 0);
+    FMT_PutStr(&line, ", STM32 dùng v");
+    FMT_PutUint(&line, TELEM_PROTOCOL_VERSION, 0);
+    UART_SendText(buffer);
+}
 
-            /* Hiển thị LED báo đã gửi (tùy chọn) */
-            HAL_GPIO_TogglePin(GPIOD, GPIO_PIN_13);  // Đèn báo UART (nếu có)
+/**
+  * @brief  Thực hiện một lệnh TELEM_TYPE_COMMAND và trả lời
+  * @note   Mọi lệnh chỉ đổi biến hoặc bắt đầu việc chạy nền, không chặn vòng lặp.
+  *         GET_STATS trả lời bằng frame STATS, ACK_SAMPLES không trả lời,
+  *         các lệnh khác bằng frame ACK.
+  * @param  payload: payload đã kiểm tra CRC
+  * @param  len: số byte
+  * @retval None
+  */
+static void UART_HandleCommand(const uint8_t *payload, uint16_t len) {
+    uint8_t frame[TELEM_FRAME_SIZE(TELEM_ACK_SIZE)];
+    TELEM_Command cmd;
+    uint8_t status = TELEM_DecodeCommand(payload, len, &cmd);
+
+    if (status == TELEM_STATUS_OK) {
+        switch (cmd.Opcode) {
+        case TELEM_CMD_SET_INTERVAL:
+            status = UART_SetInterval(cmd.Target, cmd.Value);
+            break;
+
+        case TELEM_CMD_CALIBRATE:
+            status = (MQ2_CalibrateStart(&mq2Data, HAL_GetTick()) == MQ2_OK) ? TELEM_STATUS_OK : TELEM_STATUS_BUSY;
+            break;
+
+        case TELEM_CMD_GET_STATS:
+            UART_SendStats(cmd.Seq);
+            return;
+
+        case TELEM_CMD_ACK_SAMPLES:
+            /* Gửi liên tục theo từng frame BATCH, không trả lời */
+            SLOG_Ack(&sampleLog, cmd.NextSeq, cmd.ReceivedSeq, HAL_GetTick());
+            FLOG_SetAcked(&flashLog, SLOG_Oldest(&sampleLog), HAL_GetTick());
+            return;
         }
     }
+    UART_SendFrame(frame, TELEM_EncodeAck(&cmd, status, frame, sizeof(frame)));
+}
+
+/**
+  * @brief  Đổi một chu kỳ đọc/gửi, có hiệu lực từ lần kiểm tra kế tiếp
+  * @param  target: TELEM_INTERVAL_*
+  * @param  value: chu kỳ mới, ms
+  * @retval TELEM_STATUS_OK hoặc TELEM_STATUS_BAD_ARG (sai target, ngoài giới hạn)
+  */
+static uint8_t UART_SetInterval(uint8_t target, uint16_t value) {
+    uint16_t *interval;
+    uint16_t min;
+
+    switch (target) {
+    case TELEM_INTERVAL_DHT11:
+        interval = &dht11ReadInterval;
+        min = DHT11_INTERVAL_MIN;
+        break;
+    case TELEM_INTERVAL_MQ2:
+        interval = &mq2ReadInterval;
+        min = MQ2_INTERVAL_MIN;
+        break;
+    case TELEM_INTERVAL_UART:
+        interval = &uartSendInterval;
+        min = UART_INTERVAL_MIN;
+        break;
+    default:
+        return TELEM_STATUS_BAD_ARG;
+    }
+
+    if (value < min || value > INTERVAL_MAX) {
+        return TELEM_STATUS_BAD_ARG;
+    }
+    *interval = value;
+    return TELEM_STATUS_OK;
+}
+
+/**
+  * @brief  Gửi frame TELEM_TYPE_STATS trả lời TELEM_CMD_GET_STATS
+  * @param  seq: Seq của lệnh
+  * @retval None
+  */
+static void UART_SendStats(uint8_t seq) {
+    uint8_t frame[TELEM_FRAME_SIZE(TELEM_STATS_SIZE)];
+    TELEM_Stats stats;
+
+    stats.UptimeMs = HAL_GetTick();
+    stats.Dht11IntervalMs = dht11ReadInterval;
+    stats.Mq2IntervalMs = mq2ReadInterval;
+    stats.UartIntervalMs = uartSendInterval;
+    stats.Dht11Reads = readCount;
+    stats.Dht11Errors = errorCount;
+    stats.TxFrames = uartTx.Stats.Frames;
+    stats.TxDropped = uartTx.Stats.Dropped;
+    stats.TxErrors = uartTx.Stats.Errors;
+    stats.RxFrames = uartRxFrames;
+    stats.RxErrors = uartRxBadFrames + uartRxBadVersion + uartRx.Stats.Overruns + uartRx.Stats.Errors;
+    stats.BootSeq = sampleBootSeq;
+    stats.SampleReadings = sampleReadings;
+    stats.SampleSuppressed = sampleSuppressed;
+    UART_SendFrame(frame, TELEM_EncodeStats(seq, &stats, frame, sizeof(frame)));
 }
 /* USER CODE END 0 */
 
@@ -305,28 +841,49 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_TIM4_Init();
   MX_I2C1_Init();
   MX_ADC1_Init();
   MX_UART5_Init();
   /* USER CODE BEGIN 2 */
 
+  /* Hàng đợi gửi UART5, cần có trước mọi lần UART_SendText */
+  UARTTX_Init(&uartTx, &huart5);
+
+  /* Nhận lệnh từ ESP qua UART5 */
+  UARTRX_Init(&uartRx, &huart5, UART_HandleFrame);
+
+  /* Bản ghi cảm biến chờ gửi: Seq và điểm xác nhận tiếp tục từ nhật ký trong flash */
+  FLOG_Init(&flashLog);
+  sampleBootSeq = FLOG_Head(&flashLog);
+  SLOG_Init(&sampleLog, FLOG_Head(&flashLog), FLOG_Acked(&flashLog), SAMPLE_ReadFlash);
+
   /* Initialize DHT11 with proper parameters */
   DHT11_Init(&dht11Data, GPIOA, GPIO_PIN_3, &htim4);
   HAL_TIM_Base_Start(&htim4);
 
   /* Initialize MQ2 with proper parameters */
   MQ2_Init(&mq2Data, &hadc1, ADC_CHANNEL_2);
+  /* Hiệu chuẩn lần đầu chạy nền trong MQ2_ProcessCalibration, đến khi xong MQ2 báo chưa hiệu chuẩn */
+  MQ2_CalibrateStart(&mq2Data, HAL_GetTick());
 
   /* Initialize OLED display */
   ssd1306_Init();
+#if OLED_BENCHMARK
+  ssd1306_TestBenchmark();
+  HAL_Delay(3000);
+#endif
+  OLED_StatsInit();
+  OLED_InitLayout();
 
   /* Initial LED states */
   HAL_GPIO_WritePin(GPIOD, GPIO_PIN_15, GPIO_PIN_RESET);  // DHT11 LED
   HAL_GPIO_WritePin(GPIOD, GPIO_PIN_14, GPIO_PIN_RESET);  // MQ2 Alarm LED
 
   /* Khởi tạo UART cho giao tiếp ESP */
-  HAL_UART_Transmit(&huart5, (uint8_t*)"STM32 đã khởi động với cảm biến thực\r\n", 40, 1000);
+  UART_SendText("STM32 đã khởi động với cảm biến thực");
+  SAMPLE_SendLogInfo();
 
   /* USER CODE END 2 */
 
@@ -345,12 +902,20 @@ int main(void)
 
     /* Gọi hàm xử lý MQ2 */
     MQ2_ProcessReading(currentTime);
+    MQ2_ProcessCalibration(currentTime);
 
     /* Cập nhật OLED */
     OLED_ProcessUpdate(currentTime);
 
-    /* Gửi dữ liệu qua UART đến ESP */
+    /* Lệnh từ ESP, sau phần đọc cảm biến để không làm lệch nhịp đọc */
+    UARTRX_Process(&uartRx);
+
+    /* Ghi lần đọc mới vào sampleLog rồi gửi qua UART đến ESP */
+    SAMPLE_Record(currentTime);
+    SAMPLE_PrepareFlash();
     UART_SendSensorData(currentTime);
+    UART_UpdateStats(currentTime);
+    UARTTX_Process(&uartTx, currentTime);
 
     /* Điều khiển các LED */
     DHT11_ControlLED(&dht11Data, currentTime);
@@ -562,11 +1127,42 @@ static void MX_UART5_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN UART5_Init 2 */
-
+  /* Tốc độ đường truyền ESP đặt bằng UART_LINK_BAUD, không sửa trong CubeMX.
+     APB1 = 8 MHz nên chọn tốc độ chia hết cho 16: 500000 chính xác, 460800 lệch 2% */
+  if (huart5.Init.BaudRate != UART_LINK_BAUD)
+  {
+    huart5.Init.BaudRate = UART_LINK_BAUD;
+    if (HAL_UART_Init(&huart5) != HAL_OK)
+    {
+      Error_Handler();
+    }
+  }
   /* USER CODE END UART5_Init 2 */
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Stream0_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream0_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream0_IRQn);
+  /* DMA1_Stream6_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+  /* DMA1_Stream7_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream7_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream7_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -610,6 +1206,104 @@ static void MX_GPIO_Init(void)
 }
 
 /* USER CODE BEGIN 4 */
+/**
+  * @brief  Callback khi flush OLED bằng DMA kết thúc (gọi trong ngắt)
+  * @retval None
+  */
+void ssd1306_FlushCpltCallback(void) {
+    oledBusyCycles += DWT->CYCCNT - oledBusyStart;
+    oledBusFree = 1;
+}
+
+/**
+  * @brief  Callback khi I2C gửi xong một khối (gọi trong ngắt)
+  * @param  hi2c: I2C handle
+  * @retval None
+  */
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c) {
+    if (hi2c->Instance == I2C1) {
+        ssd1306_DMA_TxCplt();
+    }
+}
+
+/**
+  * @brief  Callback khi I2C lỗi (NACK, arbitration lost...)
+  * @param  hi2c: I2C handle
+  * @retval None
+  */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c) {
+    if (hi2c->Instance == I2C1) {
+        ssd1306_DMA_Error();
+    }
+}
+
+/**
+  * @brief  Callback khi UART gửi xong một khối DMA (gọi trong ngắt)
+  * @param  huart: UART handle
+  * @retval None
+  */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    if (huart->Instance == UART5) {
+        UARTTX_TxCplt(&uartTx);
+    }
+}
+
+/**
+  * @brief  Callback khi UART lỗi
+  * @param  huart: UART handle
+  * @retval None
+  */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+    if (huart->Instance == UART5) {
+        UARTTX_Error(&uartTx);
+        UARTRX_Error(&uartRx);
+    }
+}
+
+/**
+  * @brief  Callback khi UART nhận: đường truyền rảnh (IDLE), nửa hoặc hết bộ đệm DMA
+  * @param  huart: UART handle
+  * @param  Size: vị trí DMA trong bộ đệm nhận
+  * @retval None
+  */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
+    if (huart->Instance == UART5) {
+        UARTRX_RxEvent(&uartRx, Size);
+    }
+}
+
+#if defined(SSD1306_USE_SPI) && defined(SSD1306_USE_DMA)
+/**
+  * @brief  Callback khi SPI gửi xong một khối (OLED nối qua SPI, gọi trong ngắt)
+  * @param  hspi: SPI handle
+  * @retval None
+  */
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef *hspi) {
+    if (hspi == &SSD1306_SPI_PORT) {
+        ssd1306_DMA_TxCplt();
+    }
+}
+
+/**
+  * @brief  Callback khi SPI lỗi
+  * @param  hspi: SPI handle
+  * @retval None
+  */
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+    if (hspi == &SSD1306_SPI_PORT) {
+        ssd1306_DMA_Error();
+    }
+}
+#endif
+
+/**
+  * @brief  Gửi một dòng kết quả benchmark OLED qua UART5 (frame TELEM_TYPE_TEXT)
+  * @param  line: chuỗi "BENCH,...\r\n"
+  * @retval None
+  */
+void ssd1306_BenchmarkOutput(const char* line) {
+    UART_SendText(line);
+}
 
 /* USER CODE END 4 */
 
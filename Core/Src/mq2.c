@@ -4,13 +4,14 @@
   * @brief          : MQ2 gas sensor driver implementation
   * @created        : May 18, 2025
   * @author         : NguyenHoa
-  * @version        : 1.0.0
+  * @version        : 1.2.1
   ******************************************************************************
   */
 
 /* Includes ------------------------------------------------------------------*/
 #include "mq2.h"
 #include <math.h>
+#include <string.h>
 
 /* Private defines -----------------------------------------------------------*/
 #define MQ2_ADC_RESOLUTION  4096.0f    // 12-bit ADC resolution
@@ -26,7 +27,8 @@ const char* const StatusMsg[] = {
     "OK",
     "ERROR",
     "ADC TIMEOUT",
-    "CALIBRATION ERROR"
+    "CALIBRATION ERROR",
+    "BUSY"
 };
 
 const char* const LevelMsg[] = {
@@ -39,6 +41,9 @@ const char* const LevelMsg[] = {
 static float MQ2_CalculateResistance(float adc_value);
 static float MQ2_CalculateRatio(float rs_value, float r0_value);
 static float MQ2_CalculatePPM(float rs_ro_ratio, float curve_a, float curve_b);
+static void MQ2_UpdateSnapshot(MQ2_Data *mq2);
+static void MQ2_CalibrateSample(MQ2_Data *mq2);
+static MQ2_StatusTypeDef MQ2_CalibrateFinish(MQ2_Data *mq2);
 
 /* Public Functions ----------------------------------------------------------*/
 
@@ -66,6 +71,8 @@ void MQ2_Init(MQ2_Data *mq2, ADC_HandleTypeDef *hadc, uint32_t channel) {
     mq2->Status = MQ2_OK;
     mq2->_R0 = 10.0f;  // Giá trị mặc định, nên hiệu chuẩn
     mq2->_isCalibrated = 0;
+    mq2->_isCalibrating = 0;
+    memset(&mq2->_snapshot, 0, sizeof(mq2->_snapshot));
 
     // Khởi tạo LED báo động
     HAL_GPIO_WritePin(MQ2_ALARM_PORT, MQ2_ALARM_PIN, GPIO_PIN_RESET);
@@ -92,39 +99,64 @@ void MQ2_DeInit(MQ2_Data *mq2) {
   */
 MQ2_StatusTypeDef MQ2_Calibrate(MQ2_Data *mq2) {
     if (!mq2) return MQ2_ERROR;
+    if (mq2->_isCalibrating) return MQ2_BUSY;
 
-    float rs_sum = 0.0f;
-    uint8_t valid_samples = 0;
+    mq2->_calibSamples = 0;
+    mq2->_calibValid = 0;
+    mq2->_calibRsSum = 0.0f;
 
     // Lấy nhiều mẫu để tăng độ chính xác
     for (uint8_t i = 0; i < MQ2_CALIB_SAMPLES; i++) {
-        if (MQ2_ReadRaw(mq2) == MQ2_OK) {
-            float rs = MQ2_CalculateResistance(mq2->RawValue);
-            if (rs > 0.0f) { // Tránh giá trị không hợp lệ
-                rs_sum += rs;
-                valid_samples++;
-            }
-        }
-        HAL_Delay(100); // Chờ giữa các mẫu
-    }
-
-    // Kiểm tra lỗi
-    if (valid_samples < MQ2_CALIB_SAMPLES/2) {
-        mq2->Status = MQ2_CALIBRATION_ERROR;
-        return MQ2_CALIBRATION_ERROR;
+        MQ2_CalibrateSample(mq2);
+        HAL_Delay(MQ2_CALIB_INTERVAL); // Chờ giữa các mẫu
     }
 
-    // Tính giá trị trung bình
-    float rs_avg = rs_sum / valid_samples;
+    return MQ2_CalibrateFinish(mq2);
+}
 
-    // R0 = Rs / 9.83 (trong không khí sạch)
-    mq2->_R0 = rs_avg / MQ2_CLEAN_AIR_RATIO;
-    mq2->_isCalibrated = 1;
-    mq2->Status = MQ2_OK;
+/**
+  * @brief  Bắt đầu hiệu chuẩn không chặn, cùng cách tính với MQ2_Calibrate
+  * @param  mq2: con trỏ đến cấu trúc MQ2_Data
+  * @param  currentTime: thời gian hiện tại từ HAL_GetTick()
+  * @retval MQ2_OK, MQ2_BUSY nếu đang hiệu chuẩn
+  * @note   Sau đó gọi MQ2_CalibrateStep trong vòng lặp chính, mỗi lần gọi lấy
+  *         nhiều nhất một mẫu (một lần đọc ADC), R0 cũ vẫn dùng đến khi xong
+  */
+MQ2_StatusTypeDef MQ2_CalibrateStart(MQ2_Data *mq2, uint32_t currentTime) {
+    if (!mq2) return MQ2_ERROR;
+    if (mq2->_isCalibrating) return MQ2_BUSY;
 
+    mq2->_isCalibrating = 1;
+    mq2->_calibSamples = 0;
+    mq2->_calibValid = 0;
+    mq2->_calibRsSum = 0.0f;
+    mq2->_calibLastTime = currentTime - MQ2_CALIB_INTERVAL;  // Mẫu đầu lấy ngay
     return MQ2_OK;
 }
 
+/**
+  * @brief  Lấy mẫu hiệu chuẩn kế tiếp nếu đã đến lúc
+  * @param  mq2: con trỏ đến cấu trúc MQ2_Data
+  * @param  currentTime: thời gian hiện tại từ HAL_GetTick()
+  * @retval MQ2_BUSY khi chưa xong, kết quả như MQ2_Calibrate khi vừa xong,
+  *         MQ2_ERROR nếu không có hiệu chuẩn nào đang chạy
+  */
+MQ2_StatusTypeDef MQ2_CalibrateStep(MQ2_Data *mq2, uint32_t currentTime) {
+    if (!mq2 || !mq2->_isCalibrating) return MQ2_ERROR;
+
+    if (currentTime - mq2->_calibLastTime < MQ2_CALIB_INTERVAL) {
+        return MQ2_BUSY;
+    }
+    mq2->_calibLastTime = currentTime;
+    MQ2_CalibrateSample(mq2);
+
+    if (mq2->_calibSamples < MQ2_CALIB_SAMPLES) {
+        return MQ2_BUSY;
+    }
+    mq2->_isCalibrating = 0;
+    return MQ2_CalibrateFinish(mq2);
+}
+
 /**
   * @brief  Thiết lập giá trị R0 từ bên ngoài
   * @param  mq2: con trỏ đến cấu trúc MQ2_Data
@@ -194,14 +226,14 @@ MQ2_StatusTypeDef MQ2_ReadVoltage(MQ2_Data *mq2) {
 /**
   * @brief  Đọc nồng độ khí gas từ cảm biến MQ2
   * @param  mq2: con trỏ đến cấu trúc MQ2_Data
-  * @retval MQ2_StatusTypeDef: trạng thái đọc
+  * @retval MQ2_StatusTypeDef: trạng thái đọc, MQ2_CALIBRATION_ERROR nếu chưa
+  *         hiệu chuẩn (không tự hiệu chuẩn ở đây vì MQ2_Calibrate chặn ~1 giây,
+  *         dùng MQ2_CalibrateStart/Step hoặc MQ2_SetR0)
   */
 MQ2_StatusTypeDef MQ2_ReadGasConcentration(MQ2_Data *mq2) {
     if (!mq2->_isCalibrated) {
-        // Nếu chưa hiệu chuẩn, thử hiệu chuẩn tự động
-        if (MQ2_Calibrate(mq2) != MQ2_OK) {
-            return MQ2_CALIBRATION_ERROR;
-        }
+        mq2->Status = MQ2_CALIBRATION_ERROR;
+        return MQ2_CALIBRATION_ERROR;
     }
 
     // Đọc điện áp
@@ -235,6 +267,9 @@ MQ2_StatusTypeDef MQ2_ReadGasConcentration(MQ2_Data *mq2) {
     // Xác định mức độ
     mq2->Level = MQ2_GetGasLevel(mq2);
 
+    // Lưu lại mẫu cho các hàm truy xuất cache
+    MQ2_UpdateSnapshot(mq2);
+
     return MQ2_OK;
 }
 
@@ -248,25 +283,39 @@ MQ2_StatusTypeDef MQ2_ReadAllValues(MQ2_Data *mq2) {
 }
 
 /**
-  * @brief  Lấy nồng độ khói
+  * @brief  Lấy ảnh chụp của mẫu đã xử lý gần nhất
+  * @param  mq2: con trỏ đến cấu trúc MQ2_Data
+  * @param  snapshot: nơi nhận bản sao dữ liệu
+  * @retval MQ2_StatusTypeDef: MQ2_ERROR nếu chưa có mẫu nào
+  * @note   Không đọc ADC. Chỉ đường lấy mẫu (MQ2_ReadAllValues) mới cập nhật
+  *         snapshot, nên gọi bao nhiêu lần cũng không tốn thêm chuyển đổi ADC
+  */
+MQ2_StatusTypeDef MQ2_GetSnapshot(const MQ2_Data *mq2, MQ2_Snapshot *snapshot) {
+    if (!mq2 || !snapshot) return MQ2_ERROR;
+
+    *snapshot = mq2->_snapshot;
+
+    return (snapshot->Sequence != 0) ? MQ2_OK : MQ2_ERROR;
+}
+
+/**
+  * @brief  Lấy nồng độ khói của mẫu gần nhất
   * @param  mq2: con trỏ đến cấu trúc MQ2_Data
   * @retval float: giá trị nồng độ khói (ppm)
   */
-float MQ2_GetSmokeConcentration(MQ2_Data *mq2) {
+float MQ2_GetSmokeConcentration(const MQ2_Data *mq2) {
     if (!mq2) return 0.0f;
-    MQ2_ReadGasConcentration(mq2);
-    return mq2->SmokeConcentration;
+    return mq2->_snapshot.SmokeConcentration;
 }
 
 /**
-  * @brief  Lấy nồng độ LPG
+  * @brief  Lấy nồng độ LPG của mẫu gần nhất
   * @param  mq2: con trỏ đến cấu trúc MQ2_Data
   * @retval float: giá trị nồng độ LPG (ppm)
   */
-float MQ2_GetLPGConcentration(MQ2_Data *mq2) {
+float MQ2_GetLPGConcentration(const MQ2_Data *mq2) {
     if (!mq2) return 0.0f;
-    MQ2_ReadGasConcentration(mq2);
-    return mq2->LPGConcentration;
+    return mq2->_snapshot.LPGConcentration;
 }
 
 /**
@@ -406,3 +455,65 @@ static float MQ2_CalculatePPM(float rs_ro_ratio, float curve_a, float curve_b) {
     // Áp dụng công thức từ datasheet
     return curve_a * powf(rs_ro_ratio, curve_b);
 }
+
+/**
+  * @brief  Chụp lại kết quả của mẫu vừa xử lý
+  * @param  mq2: con trỏ đến cấu trúc MQ2_Data
+  * @retval None
+  */
+static void MQ2_UpdateSnapshot(MQ2_Data *mq2) {
+    MQ2_Snapshot *snap = &mq2->_snapshot;
+
+    snap->RawValue = mq2->RawValue;
+    snap->Voltage = mq2->Voltage;
+    snap->GasConcentration = mq2->GasConcentration;
+    snap->SmokeConcentration = mq2->SmokeConcentration;
+    snap->LPGConcentration = mq2->LPGConcentration;
+    snap->Level = mq2->Level;
+    snap->Timestamp = HAL_GetTick();
+    snap->Sequence++;
+
+    // Bỏ qua 0 khi tràn để 0 luôn nghĩa là "chưa có mẫu"
+    if (snap->Sequence == 0) {
+        snap->Sequence = 1;
+    }
+}
+
+/**
+  * @brief  Lấy một mẫu hiệu chuẩn, cộng Rs vào tổng nếu hợp lệ
+  * @param  mq2: con trỏ đến cấu trúc MQ2_Data
+  * @retval None
+  */
+static void MQ2_CalibrateSample(MQ2_Data *mq2) {
+    mq2->_calibSamples++;
+    if (MQ2_ReadRaw(mq2) == MQ2_OK) {
+        float rs = MQ2_CalculateResistance(mq2->RawValue);
+        if (rs > 0.0f) { // Tránh giá trị không hợp lệ
+            mq2->_calibRsSum += rs;
+            mq2->_calibValid++;
+        }
+    }
+}
+
+/**
+  * @brief  Tính R0 từ các mẫu hiệu chuẩn đã lấy
+  * @param  mq2: con trỏ đến cấu trúc MQ2_Data
+  * @retval MQ2_OK hoặc MQ2_CALIBRATION_ERROR
+  */
+static MQ2_StatusTypeDef MQ2_CalibrateFinish(MQ2_Data *mq2) {
+    // Kiểm tra lỗi
+    if (mq2->_calibValid < MQ2_CALIB_SAMPLES/2) {
+        mq2->Status = MQ2_CALIBRATION_ERROR;
+        return MQ2_CALIBRATION_ERROR;
+    }
+
+    // Tính giá trị trung bình
+    float rs_avg = mq2->_calibRsSum / mq2->_calibValid;
+
+    // R0 = Rs / 9.83 (trong không khí sạch)
+    mq2->_R0 = rs_avg / MQ2_CLEAN_AIR_RATIO;
+    mq2->_isCalibrated = 1;
+    mq2->Status = MQ2_OK;
+
+    return MQ2_OK;
+}
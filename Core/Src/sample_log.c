@@ -0,0 +1,225 @@
+/**
+  ******************************************************************************
+  * @file           : sample_log.c
+  * @brief          : Bộ đệm vòng lưu mọi lần đọc cảm biến đến khi ESP xác nhận
+  * @created        : Oct 18, 2026
+  * @author         : NguyenHoa
+  * @version        : 1.2.0
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sample_log.h"
+#include <string.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define SLOG_MASK (SLOG_CAPACITY - 1)
+
+/* Private function prototypes -----------------------------------------------*/
+static void SLOG_Get(SLOG_Data *log, uint32_t seq, TELEM_Record *record);
+
+/**
+  * @brief  Khởi tạo bộ đệm RAM rỗng
+  * @param  log: bộ đệm
+  * @param  headSeq: Seq của bản ghi kế tiếp
+  * @param  ackedSeq: bản ghi đầu chưa xác nhận; nhỏ hơn headSeq thì các bản
+  *         ghi [ackedSeq, headSeq) đọc qua reader và được gửi bù
+  * @param  reader: đọc bản ghi không còn trong RAM, NULL nếu chỉ dùng RAM
+  * @retval None
+  */
+void SLOG_Init(SLOG_Data *log, uint32_t headSeq, uint32_t ackedSeq, SLOG_Reader reader) {
+    memset(log, 0, sizeof(*log));
+    log->_reader = reader;
+    log->_ramStart = headSeq;
+    log->_head = headSeq;
+    log->_acked = (reader != NULL) ? ackedSeq : headSeq;
+    log->_received = log->_acked;
+    log->_sent = log->_acked;
+}
+
+/**
+  * @brief  Thêm một bản ghi
+  * @note   Bộ đệm đầy thì bỏ bản ghi cũ nhất chưa xác nhận
+  * @param  log: bộ đệm
+  * @param  record: bản ghi
+  * @retval Seq của bản ghi
+  */
+uint32_t SLOG_Append(SLOG_Data *log, const TELEM_Record *record) {
+    if (log->_reader == NULL && log->_head - log->_acked == SLOG_CAPACITY) {
+        log->_acked++;
+        log->Stats.Overwritten++;
+        if (log->_received - log->_acked > log->_head - log->_acked) {
+            // Bản ghi ESP chưa nhận vừa bị ghi đè
+            log->_received = log->_acked;
+        }
+        if (log->_sent - log->_acked > log->_head - log->_acked) {
+            // Bản ghi đang chờ gửi vừa bị ghi đè
+            log->_sent = log->_acked;
+        }
+    }
+
+    log->_records[log->_head & SLOG_MASK] = *record;
+    log->Stats.Records++;
+
+    if (++log->_head - log->_ramStart > SLOG_CAPACITY) {
+        // Bản ghi cũ nhất trong RAM vừa bị ghi đè, vẫn còn trong reader
+        log->_ramStart++;
+    }
+    const uint32_t pending = log->_head - log->_acked;
+    if (pending > log->Stats.HighWater) {
+        log->Stats.HighWater = pending;
+    }
+    return log->_head - 1;
+}
+
+/**
+  * @brief  Số bản ghi chưa được xác nhận
+  * @param  log: bộ đệm
+  * @retval Số bản ghi
+  */
+uint32_t SLOG_Pending(const SLOG_Data *log) {
+    return log->_head - log->_acked;
+}
+
+/**
+  * @brief  Seq của bản ghi cũ nhất chưa được xác nhận
+  * @param  log: bộ đệm
+  * @retval Seq
+  */
+uint32_t SLOG_Oldest(const SLOG_Data *log) {
+    return log->_acked;
+}
+
+/**
+  * @brief  Nơi lưu đã bỏ mọi bản ghi trước oldestSeq
+  * @note   Bản ghi chưa xác nhận trong số đó đếm vào Stats.Overwritten
+  * @param  log: bộ đệm
+  * @param  oldestSeq: Seq của bản ghi cũ nhất nơi lưu còn giữ
+  * @retval None
+  */
+void SLOG_Discard(SLOG_Data *log, uint32_t oldestSeq) {
+    if (oldestSeq - log->_acked == 0 || oldestSeq - log->_acked > log->_head - log->_acked) {
+        return;
+    }
+    log->Stats.Overwritten += oldestSeq - log->_acked;
+    if (log->_received - log->_acked < oldestSeq - log->_acked) {
+        log->_received = oldestSeq;
+    }
+    if (log->_sent - log->_acked < oldestSeq - log->_acked) {
+        log->_sent = oldestSeq;
+    }
+    log->_acked = oldestSeq;
+}
+
+/**
+  * @brief  Lấy frame BATCH kế tiếp nếu đã đến lúc gửi
+  * @note   Gửi khi có đủ TELEM_BATCH_MAX bản ghi mới, hoặc có bản ghi mới và
+  *         frame trước đã cách interval. Không gửi thêm khi đã có SLOG_WINDOW
+  *         bản ghi chờ xác nhận; quá SLOG_RETRY_TIMEOUT ESP chưa báo nhận thêm
+  *         thì gửi lại từ received. Bản ghi ESP đã nhận nhưng chưa đẩy lên
+  *         server không được gửi lại.
+  * @param  log: bộ đệm
+  * @param  currentTime: thời gian hiện tại từ HAL_GetTick()
+  * @param  interval: độ trễ tối đa trước khi gửi frame chưa đầy, ms
+  * @param  records: bộ đệm đích, TELEM_BATCH_MAX bản ghi
+  * @param  firstSeq: Seq của records[0]
+  * @param  batchFlags: TELEM_BATCH_OLDEST nếu records[0] là bản ghi cũ nhất
+  *         chưa xác nhận, TELEM_BATCH_LIVE nếu records kết thúc ở bản ghi mới nhất
+  * @retval Số bản ghi, 0 nếu chưa cần gửi
+  */
+uint8_t SLOG_NextBatch(SLOG_Data *log, uint32_t currentTime, uint32_t interval, TELEM_Record *records, uint32_t *firstSeq, uint8_t *batchFlags) {
+    if (log->_sent != log->_received && currentTime - log->_progressTime >= SLOG_RETRY_TIMEOUT) {
+        // ESP không báo đã nhận: frame hoặc ACK đã mất
+        log->_sent = log->_received;
+        log->Stats.Retransmits++;
+    }
+
+    const uint32_t unsent = log->_head - log->_sent;
+    const uint32_t room = SLOG_WINDOW - (log->_sent - log->_acked);
+    uint32_t count = (unsent < TELEM_BATCH_MAX) ? unsent : TELEM_BATCH_MAX;
+    if (count > room) {
+        count = room;
+    }
+
+    if (count == 0) {
+        return 0;
+    }
+    if (count < TELEM_BATCH_MAX && currentTime - log->_lastBatchTime < interval) {
+        return 0;
+    }
+
+    if (log->_sent == log->_received) {
+        // Bắt đầu chờ ESP nhận từ frame này
+        log->_progressTime = currentTime;
+    }
+    *firstSeq = log->_sent;
+    *batchFlags = (log->_sent == log->_acked) ? TELEM_BATCH_OLDEST : 0;
+    for (uint32_t i = 0; i < count; i++) {
+        SLOG_Get(log, log->_sent + i, &records[i]);
+    }
+    log->_sent += count;
+    if (log->_sent == log->_head) {
+        *batchFlags |= TELEM_BATCH_LIVE;
+    }
+    log->_lastBatchTime = currentTime;
+    log->Stats.Batches++;
+    return (uint8_t)count;
+}
+
+/**
+  * @brief  ESP đã nhận mọi bản ghi trước receivedSeq và đẩy lên server mọi bản ghi trước nextSeq
+  * @note   Bản ghi trước nextSeq được bỏ khỏi bộ đệm. Bản ghi trong [nextSeq, receivedSeq)
+  *         vẫn giữ nhưng không gửi lại khi quá thời gian, ESP đang gom chúng để đẩy lên
+  * @param  log: bộ đệm
+  * @param  nextSeq: Seq đầu tiên ESP chưa đẩy lên server
+  * @param  receivedSeq: Seq đầu tiên ESP chưa nhận, bằng nextSeq nếu ESP không báo riêng
+  * @param  currentTime: thời gian hiện tại từ HAL_GetTick()
+  * @retval None
+  */
+void SLOG_Ack(SLOG_Data *log, uint32_t nextSeq, uint32_t receivedSeq, uint32_t currentTime) {
+    // Tính theo khoảng cách từ acked; chỉ nhận giá trị trong [acked, head], bỏ ACK cũ hoặc của phiên trước
+    const uint32_t limit = log->_head - log->_acked;
+    uint32_t committed = nextSeq - log->_acked;
+    uint32_t received = receivedSeq - log->_acked;
+    if (committed > limit) {
+        committed = 0;
+    }
+    if (received > limit) {
+        received = 0;
+    }
+    if (received < committed) {
+        received = committed;
+    }
+
+    if (received > log->_received - log->_acked) {
+        if (log->_sent - log->_acked < received) {
+            // ESP đã có cả phần sắp gửi lại
+            log->_sent = log->_acked + received;
+        }
+        log->_received = log->_acked + received;
+        log->_progressTime = currentTime;
+    }
+    log->_acked += committed;
+}
+
+/**
+  * @brief  Lấy bản ghi theo Seq từ RAM, hoặc qua reader nếu đã rời RAM
+  * @note   Reader không đọc được thì trả bản ghi rỗng (không có bit *_NEW)
+  *         để giữ Seq liên tục, bên nhận bỏ qua giá trị của bản ghi này
+  * @param  log: bộ đệm
+  * @param  seq: Seq, trong [acked, head)
+  * @param  record: bản ghi
+  * @retval None
+  */
+static void SLOG_Get(SLOG_Data *log, uint32_t seq, TELEM_Record *record) {
+    if (seq - log->_ramStart < log->_head - log->_ramStart) {
+        *record = log->_records[seq & SLOG_MASK];
+        return;
+    }
+    if (log->_reader != NULL && log->_reader(seq, record)) {
+        log->Stats.Replayed++;
+        return;
+    }
+    memset(record, 0, sizeof(*record));
+    log->Stats.Missing++;
+}
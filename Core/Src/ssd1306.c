@@ -1,8 +1,11 @@
 #include "ssd1306.h"
-#include <math.h>
 #include <stdlib.h>
 #include <string.h>  // For memcpy
 
+#if defined(SSD1306_USE_DMA)
+static void ssd1306_WaitIdle(void);
+#endif
+
 #if defined(SSD1306_USE_I2C)
 
 void ssd1306_Reset(void) {
@@ -11,14 +14,44 @@ void ssd1306_Reset(void) {
 
 // Send a byte to the command register
 void ssd1306_WriteCommand(uint8_t byte) {
+#if defined(SSD1306_USE_DMA)
+    ssd1306_WaitIdle();
+#endif
     HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x00, 1, &byte, 1, HAL_MAX_DELAY);
 }
 
+// Send a sequence of command bytes in one transaction
+void ssd1306_WriteCommands(const uint8_t* cmds, size_t count) {
+#if defined(SSD1306_USE_DMA)
+    ssd1306_WaitIdle();
+#endif
+    HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x00, 1, (uint8_t*)cmds, count, HAL_MAX_DELAY);
+}
+
 // Send data
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
+#if defined(SSD1306_USE_DMA)
+    ssd1306_WaitIdle();
+#endif
     HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x40, 1, buffer, buff_size, HAL_MAX_DELAY);
 }
 
+#if defined(SSD1306_USE_DMA)
+// Start sending command bytes, completion is reported by ssd1306_DMA_TxCplt
+static HAL_StatusTypeDef ssd1306_WriteCommandsDMA(const uint8_t* cmds, size_t count) {
+    return HAL_I2C_Mem_Write_DMA(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x00, 1, (uint8_t*)cmds, count);
+}
+
+// Start sending data, completion is reported by ssd1306_DMA_TxCplt
+static HAL_StatusTypeDef ssd1306_WriteDataDMA(uint8_t* buffer, size_t buff_size) {
+    return HAL_I2C_Mem_Write_DMA(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x40, 1, buffer, buff_size);
+}
+
+// A DMA transfer has ended, the I2C stop condition was already sent
+static inline void ssd1306_EndTransferDMA(void) {
+}
+#endif
+
 #elif defined(SSD1306_USE_SPI)
 
 void ssd1306_Reset(void) {
@@ -34,134 +67,271 @@ void ssd1306_Reset(void) {
 
 // Send a byte to the command register
 void ssd1306_WriteCommand(uint8_t byte) {
+    ssd1306_WriteCommands(&byte, 1);
+}
+
+// Send a sequence of command bytes under one CS assertion
+void ssd1306_WriteCommands(const uint8_t* cmds, size_t count) {
+#if defined(SSD1306_USE_DMA)
+    ssd1306_WaitIdle();
+#endif
     HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_RESET); // select OLED
     HAL_GPIO_WritePin(SSD1306_DC_Port, SSD1306_DC_Pin, GPIO_PIN_RESET); // command
-    HAL_SPI_Transmit(&SSD1306_SPI_PORT, (uint8_t *) &byte, 1, HAL_MAX_DELAY);
+    HAL_SPI_Transmit(&SSD1306_SPI_PORT, (uint8_t *) cmds, count, HAL_MAX_DELAY);
     HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_SET); // un-select OLED
 }
 
 // Send data
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
+#if defined(SSD1306_USE_DMA)
+    ssd1306_WaitIdle();
+#endif
     HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_RESET); // select OLED
     HAL_GPIO_WritePin(SSD1306_DC_Port, SSD1306_DC_Pin, GPIO_PIN_SET); // data
     HAL_SPI_Transmit(&SSD1306_SPI_PORT, buffer, buff_size, HAL_MAX_DELAY);
     HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_SET); // un-select OLED
 }
 
+#if defined(SSD1306_USE_DMA)
+// Start sending command bytes, CS stays low until ssd1306_DMA_TxCplt
+static HAL_StatusTypeDef ssd1306_WriteCommandsDMA(const uint8_t* cmds, size_t count) {
+    HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_RESET); // select OLED
+    HAL_GPIO_WritePin(SSD1306_DC_Port, SSD1306_DC_Pin, GPIO_PIN_RESET); // command
+    return HAL_SPI_Transmit_DMA(&SSD1306_SPI_PORT, (uint8_t *) cmds, count);
+}
+
+// Start sending data, CS stays low until ssd1306_DMA_TxCplt
+static HAL_StatusTypeDef ssd1306_WriteDataDMA(uint8_t* buffer, size_t buff_size) {
+    HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_RESET); // select OLED
+    HAL_GPIO_WritePin(SSD1306_DC_Port, SSD1306_DC_Pin, GPIO_PIN_SET); // data
+    return HAL_SPI_Transmit_DMA(&SSD1306_SPI_PORT, buffer, buff_size);
+}
+
+// A DMA transfer has ended (HAL waits for the last bit before the callback)
+static inline void ssd1306_EndTransferDMA(void) {
+    HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_SET); // un-select OLED
+}
+#endif
+
+#elif defined(SSD1306_USE_HOST)
+
+void ssd1306_Reset(void) {
+    ssd1306_HostReset();
+}
+
+// Send a byte to the command register
+void ssd1306_WriteCommand(uint8_t byte) {
+    ssd1306_HostWrite(0x00, &byte, 1);
+}
+
+// Send a sequence of command bytes in one transaction
+void ssd1306_WriteCommands(const uint8_t* cmds, size_t count) {
+    ssd1306_HostWrite(0x00, cmds, count);
+}
+
+// Send data
+void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
+    ssd1306_HostWrite(0x40, buffer, buff_size);
+}
+
 #else
-#error "You should define SSD1306_USE_SPI or SSD1306_USE_I2C macro"
+#error "You should define SSD1306_USE_SPI, SSD1306_USE_I2C or SSD1306_USE_HOST macro"
+#endif
+
+#if defined(SSD1306_USE_DMA) && !defined(SSD1306_USE_I2C) && !defined(SSD1306_USE_SPI)
+#error "SSD1306_USE_DMA is only implemented for the I2C and SPI buses"
 #endif
 
 
+#define SSD1306_PAGES           (SSD1306_HEIGHT / 8)
+#define SSD1306_COLUMN_OFFSET   ((SSD1306_X_OFFSET_UPPER << 4) | SSD1306_X_OFFSET_LOWER)
+
 // Screenbuffer
 static uint8_t SSD1306_Buffer[SSD1306_BUFFER_SIZE];
 
+// Copy of what the panel currently shows. DMA transfers are fed from here,
+// so drawing into SSD1306_Buffer can go on while a flush is in flight.
+static uint8_t SSD1306_FrontBuffer[SSD1306_BUFFER_SIZE];
+
+// Column span of pages Page1..Page2 to be sent by a flush. Only full width
+// spans cover more than one page, so their data is contiguous in RAM.
+typedef struct {
+    uint8_t Page1;
+    uint8_t Page2;
+    uint8_t X1;
+    uint8_t X2;
+} SSD1306_Span_t;
+
+static SSD1306_Span_t SSD1306_Spans[SSD1306_PAGES];
+static uint8_t SSD1306_SpanCount;
+
+// Dirty column span of every page. A page is clean when DirtyX1 > DirtyX2.
+static uint8_t SSD1306_DirtyX1[SSD1306_PAGES];
+static uint8_t SSD1306_DirtyX2[SSD1306_PAGES];
+
+// Set when the panel content is unknown and the next flush must send everything.
+// Also set from the bus interrupts, so it is the only state they touch.
+static volatile uint8_t SSD1306_FullFlush;
+
+// Flush statistics
+static SSD1306_FlushStats_t SSD1306_Stats;
+
+#if defined(SSD1306_USE_DMA)
+// State of the DMA flush
+typedef enum {
+    SSD1306_DMA_IDLE = 0,
+    SSD1306_DMA_WINDOW,   // Column/page window commands in flight
+    SSD1306_DMA_DATA      // Span data in flight
+} SSD1306_DMAState_t;
+
+static volatile SSD1306_DMAState_t SSD1306_DMAState = SSD1306_DMA_IDLE;
+static volatile uint8_t SSD1306_SpanIndex;
+static uint8_t SSD1306_WindowCmd[6];
+#endif
+
 // Screen object
 static SSD1306_t SSD1306;
 
+/* Mark columns x1..x2 of pages page1..page2 as changed */
+static inline void ssd1306_MarkDirty(uint8_t x1, uint8_t x2, uint8_t page1, uint8_t page2) {
+    for (uint8_t page = page1; page <= page2; page++) {
+        if (x1 < SSD1306_DirtyX1[page]) {
+            SSD1306_DirtyX1[page] = x1;
+        }
+        if (x2 > SSD1306_DirtyX2[page]) {
+            SSD1306_DirtyX2[page] = x2;
+        }
+    }
+}
+
+/* Forget all pending changes */
+static void ssd1306_MarkClean(void) {
+    memset(SSD1306_DirtyX1, SSD1306_WIDTH, sizeof(SSD1306_DirtyX1));
+    memset(SSD1306_DirtyX2, 0, sizeof(SSD1306_DirtyX2));
+}
+
+/* Force the next ssd1306_UpdateScreen to send the whole screenbuffer */
+void ssd1306_Invalidate(void) {
+    SSD1306_FullFlush = 1;
+}
+
+/*
+ * Shrink the dirty span of a page to the bytes that really differ from
+ * the front buffer. Returns 0 if nothing changed.
+ */
+static uint8_t ssd1306_TrimDirty(uint8_t page, uint8_t* x1, uint8_t* x2) {
+    const uint8_t* buf = &SSD1306_Buffer[SSD1306_WIDTH*page];
+    const uint8_t* front = &SSD1306_FrontBuffer[SSD1306_WIDTH*page];
+    uint8_t start = *x1;
+    uint8_t end = *x2;
+
+    while (start <= end && buf[start] == front[start]) {
+        start++;
+    }
+    if (start > end) {
+        return 0;
+    }
+    while (buf[end] == front[end]) {
+        end--;
+    }
+
+    *x1 = start;
+    *x2 = end;
+    return 1;
+}
+
 /* Fills the Screenbuffer with values from a given buffer of a fixed length */
 SSD1306_Error_t ssd1306_FillBuffer(uint8_t* buf, uint32_t len) {
     SSD1306_Error_t ret = SSD1306_ERR;
     if (len <= SSD1306_BUFFER_SIZE) {
         memcpy(SSD1306_Buffer,buf,len);
+        ssd1306_MarkDirty(0, SSD1306_WIDTH - 1, 0, SSD1306_PAGES - 1);
         ret = SSD1306_OK;
     }
     return ret;
 }
 
-/* Initialize the oled screen */
-void ssd1306_Init(void) {
-    // Reset OLED
-    ssd1306_Reset();
-
-    // Wait for the screen to boot
-    HAL_Delay(100);
-
-    // Init OLED
-    ssd1306_SetDisplayOn(0); //display off
-
-    ssd1306_WriteCommand(0x20); //Set Memory Addressing Mode
-    ssd1306_WriteCommand(0x00); // 00b,Horizontal Addressing Mode; 01b,Vertical Addressing Mode;
-                                // 10b,Page Addressing Mode (RESET); 11b,Invalid
-
-    ssd1306_WriteCommand(0xB0); //Set Page Start Address for Page Addressing Mode,0-7
-
+/*
+ * Setup commands sent by ssd1306_Init, between display off and display on.
+ * Operands follow their command byte.
+ */
+static const uint8_t SSD1306_InitSequence[] = {
+    0x20, 0x00,     // Set Memory Addressing Mode: 00b,Horizontal Addressing Mode; 01b,Vertical Addressing Mode;
+                    // 10b,Page Addressing Mode (RESET); 11b,Invalid
+    0xB0,           // Set Page Start Address for Page Addressing Mode,0-7
 #ifdef SSD1306_MIRROR_VERT
-    ssd1306_WriteCommand(0xC0); // Mirror vertically
+    0xC0,           // Mirror vertically
 #else
-    ssd1306_WriteCommand(0xC8); //Set COM Output Scan Direction
+    0xC8,           // Set COM Output Scan Direction
 #endif
-
-    ssd1306_WriteCommand(0x00); //---set low column address
-    ssd1306_WriteCommand(0x10); //---set high column address
-
-    ssd1306_WriteCommand(0x40); //--set start line address - CHECK
-
-    ssd1306_SetContrast(0xFF);
-
+    0x00,           // ---set low column address
+    0x10,           // ---set high column address
+    0x40,           // --set start line address - CHECK
+    0x81, 0xFF,     // Set contrast
 #ifdef SSD1306_MIRROR_HORIZ
-    ssd1306_WriteCommand(0xA0); // Mirror horizontally
+    0xA0,           // Mirror horizontally
 #else
-    ssd1306_WriteCommand(0xA1); //--set segment re-map 0 to 127 - CHECK
+    0xA1,           // --set segment re-map 0 to 127 - CHECK
 #endif
-
 #ifdef SSD1306_INVERSE_COLOR
-    ssd1306_WriteCommand(0xA7); //--set inverse color
+    0xA7,           // --set inverse color
 #else
-    ssd1306_WriteCommand(0xA6); //--set normal color
+    0xA6,           // --set normal color
 #endif
-
 // Set multiplex ratio.
 #if (SSD1306_HEIGHT == 128)
-    // Found in the Luma Python lib for SH1106.
-    ssd1306_WriteCommand(0xFF);
+    0xFF,           // Found in the Luma Python lib for SH1106.
 #else
-    ssd1306_WriteCommand(0xA8); //--set multiplex ratio(1 to 64) - CHECK
+    0xA8,           // --set multiplex ratio(1 to 64) - CHECK
 #endif
-
 #if (SSD1306_HEIGHT == 32)
-    ssd1306_WriteCommand(0x1F); //
+    0x1F,
 #elif (SSD1306_HEIGHT == 64)
-    ssd1306_WriteCommand(0x3F); //
+    0x3F,
 #elif (SSD1306_HEIGHT == 128)
-    ssd1306_WriteCommand(0x3F); // Seems to work for 128px high displays too.
+    0x3F,           // Seems to work for 128px high displays too.
 #else
 #error "Only 32, 64, or 128 lines of height are supported!"
 #endif
-
-    ssd1306_WriteCommand(0xA4); //0xa4,Output follows RAM content;0xa5,Output ignores RAM content
-
-    ssd1306_WriteCommand(0xD3); //-set display offset - CHECK
-    ssd1306_WriteCommand(0x00); //-not offset
-
-    ssd1306_WriteCommand(0xD5); //--set display clock divide ratio/oscillator frequency
-    ssd1306_WriteCommand(0xF0); //--set divide ratio
-
-    ssd1306_WriteCommand(0xD9); //--set pre-charge period
-    ssd1306_WriteCommand(0x22); //
-
-    ssd1306_WriteCommand(0xDA); //--set com pins hardware configuration - CHECK
+    0xA4,           // 0xa4,Output follows RAM content;0xa5,Output ignores RAM content
+    0xD3, 0x00,     // -set display offset - CHECK, -not offset
+    0xD5, 0xF0,     // --set display clock divide ratio/oscillator frequency, --set divide ratio
+    0xD9, 0x22,     // --set pre-charge period
+    0xDA,           // --set com pins hardware configuration - CHECK
 #if (SSD1306_HEIGHT == 32)
-    ssd1306_WriteCommand(0x02);
+    0x02,
 #elif (SSD1306_HEIGHT == 64)
-    ssd1306_WriteCommand(0x12);
+    0x12,
 #elif (SSD1306_HEIGHT == 128)
-    ssd1306_WriteCommand(0x12);
+    0x12,
 #else
 #error "Only 32, 64, or 128 lines of height are supported!"
 #endif
+    0xDB, 0x20,     // --set vcomh, 0x20,0.77xVcc
+    0x8D, 0x14,     // --set DC-DC enable
+};
+
+/* Initialize the oled screen */
+void ssd1306_Init(void) {
+    // Reset OLED
+    ssd1306_Reset();
 
-    ssd1306_WriteCommand(0xDB); //--set vcomh
-    ssd1306_WriteCommand(0x20); //0x20,0.77xVcc
+    // Wait for the screen to boot
+    HAL_Delay(100);
 
-    ssd1306_WriteCommand(0x8D); //--set DC-DC enable
-    ssd1306_WriteCommand(0x14); //
+    // Init OLED
+    ssd1306_SetDisplayOn(0); //display off
+
+    // The whole setup goes out as one command sequence (one I2C
+    // transaction, one CS assertion on SPI)
+    ssd1306_WriteCommands(SSD1306_InitSequence, sizeof(SSD1306_InitSequence));
     ssd1306_SetDisplayOn(1); //--turn on SSD1306 panel
 
     // Clear screen
     ssd1306_Fill(Black);
     
-    // Flush buffer to screen
+    // Flush buffer to screen. The panel RAM content is unknown after reset.
+    ssd1306_Invalidate();
     ssd1306_UpdateScreen();
     
     // Set default values for screen object
@@ -174,24 +344,224 @@ void ssd1306_Init(void) {
 /* Fill the whole screen with the given color */
 void ssd1306_Fill(SSD1306_COLOR color) {
     memset(SSD1306_Buffer, (color == Black) ? 0x00 : 0xFF, sizeof(SSD1306_Buffer));
+    ssd1306_MarkDirty(0, SSD1306_WIDTH - 1, 0, SSD1306_PAGES - 1);
+}
+
+/* Fill the column/page address window commands for a span */
+static void ssd1306_SpanWindow(const SSD1306_Span_t* span, uint8_t* cmd) {
+    cmd[0] = 0x21;                                   // Set Column Address
+    cmd[1] = SSD1306_COLUMN_OFFSET + span->X1;
+    cmd[2] = SSD1306_COLUMN_OFFSET + span->X2;
+    cmd[3] = 0x22;                                   // Set Page Address
+    cmd[4] = span->Page1;
+    cmd[5] = span->Page2;
 }
 
-/* Write the screenbuffer with changed to the screen */
+/* First byte of a span in the front buffer */
+static uint8_t* ssd1306_SpanData(const SSD1306_Span_t* span) {
+    return &SSD1306_FrontBuffer[SSD1306_WIDTH*span->Page1 + span->X1];
+}
+
+/* Number of bytes in a span */
+static uint16_t ssd1306_SpanLength(const SSD1306_Span_t* span) {
+    return (uint16_t)(span->X2 - span->X1 + 1) * (span->Page2 - span->Page1 + 1);
+}
+
+/*
+ * Collect the changed column span of each page of RAM into SSD1306_Spans
+ * and copy them to the front buffer. Runs of full width pages are merged
+ * into one span: with Horizontal Addressing Mode the panel wraps to the
+ * next page by itself, so a full frame goes out as one window and one data
+ * transfer. Number of pages depends on the screen height:
+ *
+ *  * 32px   ==  4 pages
+ *  * 64px   ==  8 pages
+ *  * 128px  ==  16 pages
+ */
+static void ssd1306_CollectSpans(void) {
+    const uint8_t fullFlush = SSD1306_FullFlush;
+    uint32_t sent = 0;
+
+    SSD1306_SpanCount = 0;
+    for(uint8_t i = 0; i < SSD1306_PAGES; i++) {
+        uint8_t x1 = fullFlush ? 0 : SSD1306_DirtyX1[i];
+        uint8_t x2 = fullFlush ? SSD1306_WIDTH - 1 : SSD1306_DirtyX2[i];
+        if (x1 > x2) {
+            continue;
+        }
+        if (!fullFlush && !ssd1306_TrimDirty(i, &x1, &x2)) {
+            continue;
+        }
+
+        SSD1306_Span_t* span = SSD1306_SpanCount > 0 ? &SSD1306_Spans[SSD1306_SpanCount - 1] : NULL;
+        const uint8_t full = (x1 == 0 && x2 == SSD1306_WIDTH - 1);
+        if (span && full && span->Page2 == i - 1 &&
+            span->X1 == 0 && span->X2 == SSD1306_WIDTH - 1) {
+            span->Page2 = i;
+        } else {
+            span = &SSD1306_Spans[SSD1306_SpanCount++];
+            span->Page1 = i;
+            span->Page2 = i;
+            span->X1 = x1;
+            span->X2 = x2;
+        }
+        memcpy(&SSD1306_FrontBuffer[SSD1306_WIDTH*i + x1], &SSD1306_Buffer[SSD1306_WIDTH*i + x1], x2 - x1 + 1);
+        sent += x2 - x1 + 1;
+    }
+    ssd1306_MarkClean();
+    SSD1306_FullFlush = 0;
+
+    if (sent > 0) {
+        SSD1306_Stats.Flushes++;
+    }
+    SSD1306_Stats.LastBytesSent = sent;
+    SSD1306_Stats.LastSpans = SSD1306_SpanCount;
+    SSD1306_Stats.LastBytesAvoided = SSD1306_BUFFER_SIZE - sent;
+    SSD1306_Stats.BytesSent += sent;
+    SSD1306_Stats.BytesAvoided += SSD1306_BUFFER_SIZE - sent;
+}
+
+/* Write the changed parts of the screenbuffer to the screen */
 void ssd1306_UpdateScreen(void) {
-    // Write data to each page of RAM. Number of pages
-    // depends on the screen height:
-    //
-    //  * 32px   ==  4 pages
-    //  * 64px   ==  8 pages
-    //  * 128px  ==  16 pages
-    for(uint8_t i = 0; i < SSD1306_HEIGHT/8; i++) {
-        ssd1306_WriteCommand(0xB0 + i); // Set the current RAM page address.
-        ssd1306_WriteCommand(0x00 + SSD1306_X_OFFSET_LOWER);
-        ssd1306_WriteCommand(0x10 + SSD1306_X_OFFSET_UPPER);
-        ssd1306_WriteData(&SSD1306_Buffer[SSD1306_WIDTH*i],SSD1306_WIDTH);
+    uint8_t window[6];
+
+#if defined(SSD1306_USE_DMA)
+    // The front buffer must not change under a running transfer
+    ssd1306_WaitIdle();
+#endif
+    ssd1306_CollectSpans();
+
+    // The column/page address window (0x21, 0x22) works because
+    // ssd1306_Init selects Horizontal Addressing Mode.
+    for(uint8_t i = 0; i < SSD1306_SpanCount; i++) {
+        const SSD1306_Span_t* span = &SSD1306_Spans[i];
+        ssd1306_SpanWindow(span, window);
+        ssd1306_WriteCommands(window, sizeof(window));
+        ssd1306_WriteData(ssd1306_SpanData(span), ssd1306_SpanLength(span));
     }
 }
 
+#if defined(SSD1306_USE_DMA)
+/* Wait until the DMA flush is finished */
+static void ssd1306_WaitIdle(void) {
+    const uint32_t start = HAL_GetTick();
+    while (SSD1306_DMAState != SSD1306_DMA_IDLE) {
+        if ((HAL_GetTick() - start) >= SSD1306_DMA_TIMEOUT) {
+            // Bus is stuck; give up on the transfer and resend everything later
+            ssd1306_EndTransferDMA();
+            SSD1306_DMAState = SSD1306_DMA_IDLE;
+            SSD1306_Stats.Errors++;
+            ssd1306_Invalidate();
+            break;
+        }
+    }
+}
+
+/* Start the transfer of the current span, window commands first */
+static SSD1306_Error_t ssd1306_StartSpan(void) {
+    ssd1306_SpanWindow(&SSD1306_Spans[SSD1306_SpanIndex], SSD1306_WindowCmd);
+    SSD1306_DMAState = SSD1306_DMA_WINDOW;
+    if (ssd1306_WriteCommandsDMA(SSD1306_WindowCmd, sizeof(SSD1306_WindowCmd)) != HAL_OK) {
+        ssd1306_EndTransferDMA();
+        SSD1306_DMAState = SSD1306_DMA_IDLE;
+        SSD1306_Stats.Errors++;
+        SSD1306_FullFlush = 1;  // May run in the interrupt: leave the dirty spans alone
+        return SSD1306_ERR;
+    }
+    return SSD1306_OK;
+}
+
+/* Write the changed parts of the screenbuffer to the screen without blocking */
+SSD1306_Error_t ssd1306_UpdateScreenAsync(void) {
+    if (SSD1306_DMAState != SSD1306_DMA_IDLE) {
+        // Changes stay marked dirty and go out with the next flush
+        return SSD1306_BUSY;
+    }
+
+    ssd1306_CollectSpans();
+    if (SSD1306_SpanCount == 0) {
+        return SSD1306_OK;
+    }
+
+    SSD1306_SpanIndex = 0;
+    return ssd1306_StartSpan();
+}
+
+/* Returns 1 while a DMA flush is in flight */
+uint8_t ssd1306_IsBusy(void) {
+    return SSD1306_DMAState != SSD1306_DMA_IDLE;
+}
+
+/* To be called from the bus transfer complete interrupt */
+void ssd1306_DMA_TxCplt(void) {
+    const SSD1306_Span_t* span;
+
+    if (SSD1306_DMAState == SSD1306_DMA_IDLE) {
+        return;
+    }
+    ssd1306_EndTransferDMA();
+
+    switch (SSD1306_DMAState) {
+    case SSD1306_DMA_WINDOW:
+        span = &SSD1306_Spans[SSD1306_SpanIndex];
+        SSD1306_DMAState = SSD1306_DMA_DATA;
+        if (ssd1306_WriteDataDMA(ssd1306_SpanData(span), ssd1306_SpanLength(span)) != HAL_OK) {
+            ssd1306_DMA_Error();
+        }
+        break;
+
+    case SSD1306_DMA_DATA:
+        if (++SSD1306_SpanIndex < SSD1306_SpanCount) {
+            if (ssd1306_StartSpan() != SSD1306_OK) {
+                ssd1306_FlushCpltCallback();
+            }
+        } else {
+            SSD1306_DMAState = SSD1306_DMA_IDLE;
+            ssd1306_FlushCpltCallback();
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+/* To be called from the bus error interrupt */
+void ssd1306_DMA_Error(void) {
+    if (SSD1306_DMAState == SSD1306_DMA_IDLE) {
+        return;
+    }
+    // Part of the frame may be missing on the panel; resend everything
+    ssd1306_EndTransferDMA();
+    SSD1306_DMAState = SSD1306_DMA_IDLE;
+    SSD1306_Stats.Errors++;
+    // Only the flag: drawing in the main loop may be updating the dirty spans
+    SSD1306_FullFlush = 1;
+    ssd1306_FlushCpltCallback();
+}
+
+/* Called when the bus is free again. Override to get notified. */
+__weak void ssd1306_FlushCpltCallback(void) {
+}
+#endif
+
+/* Direct access to the screenbuffer, SSD1306_BUFFER_SIZE bytes in page order */
+uint8_t* ssd1306_GetBuffer(void) {
+    return SSD1306_Buffer;
+}
+
+/* Read the flush statistics */
+void ssd1306_GetFlushStats(SSD1306_FlushStats_t* stats) {
+    if (stats != NULL) {
+        *stats = SSD1306_Stats;
+    }
+}
+
+/* Reset the flush statistics */
+void ssd1306_ResetFlushStats(void) {
+    memset(&SSD1306_Stats, 0, sizeof(SSD1306_Stats));
+}
+
 /*
  * Draw one pixel in the screenbuffer
  * X => X Coordinate
@@ -210,34 +580,101 @@ void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color) {
     } else { 
         SSD1306_Buffer[x + (y / 8) * SSD1306_WIDTH] &= ~(1 << (y % 8));
     }
+    ssd1306_MarkDirty(x, x, y / 8, y / 8);
 }
 
 /*
- * Draw 1 char to the screen buffer
- * ch       => char om weg te schrijven
- * Font     => Font waarmee we gaan schrijven
- * color    => Black or White
+ * Copy page-aligned column bytes (a glyph or a paged bitmap) to x, y.
+ * Each band of 8 source rows lands in at most two pages; the 16-bit masks
+ * shifted by y % 8 split it between them. Pixels of the box that are not
+ * set in the source are drawn in the background color. Bands on page
+ * boundaries are plain copies.
  */
-char ssd1306_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color) {
+static void ssd1306_BlitPages(uint8_t x, uint8_t y, const uint8_t* src, uint8_t stride, uint8_t width, uint8_t height, SSD1306_COLOR color) {
+    const uint8_t shift = y % 8;
+    const uint8_t bands = (height + 7) / 8;
+
+    for(uint8_t band = 0; band < bands; band++) {
+        const uint8_t rows = height - band * 8;
+        const uint16_t mask = (uint16_t)(rows >= 8 ? 0xFF : (1 << rows) - 1) << shift;
+        const uint8_t page = y / 8 + band;
+        const uint16_t lo = SSD1306_WIDTH * page + x;
+        const uint16_t hi = lo + SSD1306_WIDTH;
+        const uint8_t* line = &src[band * stride];
+
+        if (mask == 0xFF && color == White) {
+            memcpy(&SSD1306_Buffer[lo], line, width);
+            continue;
+        }
+        for(uint8_t i = 0; i < width; i++) {
+            uint16_t bits = (uint16_t)line[i] << shift;
+            if (color == Black) {
+                bits = ~bits;
+            }
+            bits &= mask;
+            SSD1306_Buffer[lo + i] = (SSD1306_Buffer[lo + i] & ~mask) | bits;
+            if ((mask >> 8) && page + 1 < SSD1306_PAGES) {
+                SSD1306_Buffer[hi + i] = (SSD1306_Buffer[hi + i] & ~(mask >> 8)) | (bits >> 8);
+            }
+        }
+    }
+
+    ssd1306_MarkDirty(x, x + width - 1, y / 8, (y + height - 1) / 8);
+}
+
+/* Glyph of a code point in the font, -1 if there is none */
+static int16_t ssd1306_GlyphIndex(const SSD1306_Font_t* Font, uint16_t cp) {
+    if (!Font->codepoints) {
+        return (cp >= 32 && cp <= 126) ? (int16_t)(cp - 32) : -1;
+    }
+
+    // Subset font: binary search in the sorted code points
+    uint16_t lo = 0, hi = Font->glyph_count;
+    while (lo < hi) {
+        const uint16_t mid = (lo + hi) / 2;
+        if (Font->codepoints[mid] == cp) {
+            return (int16_t)mid;
+        }
+        if (Font->codepoints[mid] < cp) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return -1;
+}
+
+/* Draw the glyph of a code point, returns 0 if there is none or it doesn't fit */
+static uint8_t ssd1306_WriteGlyph(uint16_t cp, const SSD1306_Font_t* Font, SSD1306_COLOR color) {
     uint32_t i, b, j;
-    
-    // Check if character is valid
-    if (ch < 32 || ch > 126)
+
+    const int16_t glyph = ssd1306_GlyphIndex(Font, cp);
+    if (glyph < 0) {
         return 0;
-    
+    }
+
     // Char width is not equal to font width for proportional font
-    const uint8_t char_width = Font.char_width ? Font.char_width[ch-32] : Font.width;
+    const uint8_t char_width = Font->char_width ? Font->char_width[glyph] : Font->width;
     // Check remaining space on current line
     if (SSD1306_WIDTH < (SSD1306.CurrentX + char_width) ||
-        SSD1306_HEIGHT < (SSD1306.CurrentY + Font.height))
+        SSD1306_HEIGHT < (SSD1306.CurrentY + Font->height))
     {
         // Not enough space on current line
         return 0;
     }
-    
+
+    if (Font->page_data) {
+        ssd1306_BlitPages(SSD1306.CurrentX, SSD1306.CurrentY,
+                          &Font->page_data[glyph * Font->width * ((Font->height + 7) / 8)],
+                          Font->width, char_width, Font->height, color);
+        // The current space is now taken
+        SSD1306.CurrentX += char_width;
+        return 1;
+    }
+
     // Use the font to write
-    for(i = 0; i < Font.height; i++) {
-        b = Font.data[(ch - 32) * Font.height + i];
+    for(i = 0; i < Font->height; i++) {
+        b = Font->data[glyph * Font->height + i];
         for(j = 0; j < char_width; j++) {
             if((b << j) & 0x8000)  {
                 ssd1306_DrawPixel(SSD1306.CurrentX + j, (SSD1306.CurrentY + i), (SSD1306_COLOR) color);
@@ -249,19 +686,72 @@ char ssd1306_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color) {
     
     // The current space is now taken
     SSD1306.CurrentX += char_width;
+    return 1;
+}
+
+/*
+ * Draw 1 char to the screen buffer
+ * ch       => char om weg te schrijven
+ * Font     => Font waarmee we gaan schrijven
+ * color    => Black or White
+ */
+char ssd1306_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color) {
+    // Check if character is valid
+    if (ch < 32 || ch > 126)
+        return 0;
     
     // Return written char for validation
-    return ch;
+    return ssd1306_WriteGlyph((uint8_t)ch, &Font, color) ? ch : 0;
+}
+
+uint16_t ssd1306_Utf8Next(const char** str) {
+    const uint8_t* s = (const uint8_t*)*str;
+    uint32_t cp;
+    uint8_t n, i;
+
+    if (s[0] < 0x80) {
+        if (s[0]) {
+            (*str)++;
+        }
+        return s[0];
+    }
+
+    if ((s[0] & 0xE0) == 0xC0) {
+        cp = s[0] & 0x1F;
+        n = 1;
+    } else if ((s[0] & 0xF0) == 0xE0) {
+        cp = s[0] & 0x0F;
+        n = 2;
+    } else if ((s[0] & 0xF8) == 0xF0) {
+        cp = s[0] & 0x07;
+        n = 3;
+    } else {
+        (*str)++;
+        return SSD1306_UTF8_INVALID;
+    }
+
+    // A missing continuation byte (also the end of the string) ends the sequence early
+    for (i = 1; i <= n; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *str += i;
+            return SSD1306_UTF8_INVALID;
+        }
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    *str += n + 1;
+    return cp > 0xFFFF ? SSD1306_UTF8_INVALID : (uint16_t)cp;
 }
 
 /* Write full string to screenbuffer */
 char ssd1306_WriteString(char* str, SSD1306_Font_t Font, SSD1306_COLOR color) {
+    const char* next = str;
+
     while (*str) {
-        if (ssd1306_WriteChar(*str, Font, color) != *str) {
+        if (!ssd1306_WriteGlyph(ssd1306_Utf8Next(&next), &Font, color)) {
             // Char could not be written
             return *str;
         }
-        str++;
+        str += next - str;
     }
     
     // Everything ok
@@ -274,6 +764,11 @@ void ssd1306_SetCursor(uint8_t x, uint8_t y) {
     SSD1306.CurrentY = y;
 }
 
+/* X position where the next char will be written */
+uint8_t ssd1306_GetCursorX(void) {
+    return SSD1306.CurrentX;
+}
+
 /* Draw line by Bresenhem's algorithm */
 void ssd1306_Line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color) {
     int32_t deltaX = abs(x2 - x1);
@@ -315,9 +810,31 @@ void ssd1306_Polyline(const SSD1306_VERTEX *par_vertex, uint16_t par_size, SSD13
     return;
 }
 
-/* Convert Degrees to Radians */
-static float ssd1306_DegToRad(float par_deg) {
-    return par_deg * (3.14f / 180.0f);
+/* sin(0..90 degrees) * 16384, the rest of the circle is mirrored from it */
+static const int16_t SSD1306_SinTable[91] = {
+        0,   286,   572,   857,  1143,  1428,  1713,  1997,  2280,  2563,
+     2845,  3126,  3406,  3686,  3964,  4240,  4516,  4790,  5063,  5334,
+     5604,  5872,  6138,  6402,  6664,  6924,  7182,  7438,  7692,  7943,
+     8192,  8438,  8682,  8923,  9162,  9397,  9630,  9860, 10087, 10311,
+    10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+    12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+    14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+    15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+    16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+    16384
+};
+
+/* Sine of a whole degree angle, scaled by 16384 */
+static int16_t ssd1306_Sin(uint16_t deg) {
+    deg %= 360;
+    if (deg <= 90) {
+        return SSD1306_SinTable[deg];
+    } else if (deg <= 180) {
+        return SSD1306_SinTable[180 - deg];
+    } else if (deg <= 270) {
+        return -SSD1306_SinTable[deg - 180];
+    }
+    return -SSD1306_SinTable[360 - deg];
 }
 
 /* Normalize degree to [0;360] */
@@ -332,6 +849,24 @@ static uint16_t ssd1306_NormalizeTo0_360(uint16_t par_deg) {
     return loc_angle;
 }
 
+/*
+ * Point on a circle. Angle is in degree and begins from 4 quart of the
+ * trigonometric circle (3pi/2), like in ssd1306_DrawArc.
+ */
+void ssd1306_GetArcPoint(uint8_t x, uint8_t y, uint8_t radius, uint16_t angle, uint8_t* px, uint8_t* py) {
+    // Division truncates towards zero, as the float cast did
+    *px = x + (int16_t)(((int32_t)ssd1306_Sin(angle) * radius) / 16384);
+    *py = y + (int16_t)(((int32_t)ssd1306_Sin(angle + 90) * radius) / 16384);
+}
+
+/* Angle of the end of segment i, for arcs split into 10 degree segments */
+static uint16_t ssd1306_ArcSegmentAngle(uint32_t i, uint32_t segments, uint32_t sweep) {
+    if (i >= segments) {
+        return sweep;
+    }
+    return (uint16_t)((i * sweep + segments / 2) / segments);
+}
+
 /*
  * DrawArc. Draw angle is beginning from 4 quart of trigonometric circle (3pi/2)
  * start_angle in degree
@@ -339,32 +874,27 @@ static uint16_t ssd1306_NormalizeTo0_360(uint16_t par_deg) {
  */
 void ssd1306_DrawArc(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color) {
     static const uint8_t CIRCLE_APPROXIMATION_SEGMENTS = 36;
-    float approx_degree;
     uint32_t approx_segments;
     uint8_t xp1,xp2;
     uint8_t yp1,yp2;
     uint32_t count;
     uint32_t loc_sweep;
-    float rad;
     
     loc_sweep = ssd1306_NormalizeTo0_360(sweep);
     
     count = (ssd1306_NormalizeTo0_360(start_angle) * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
     approx_segments = (loc_sweep * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
-    approx_degree = loc_sweep / (float)approx_segments;
+    if (count >= approx_segments) {
+        return;
+    }
+
+    ssd1306_GetArcPoint(x, y, radius, ssd1306_ArcSegmentAngle(count, approx_segments, loc_sweep), &xp2, &yp2);
     while(count < approx_segments)
     {
-        rad = ssd1306_DegToRad(count*approx_degree);
-        xp1 = x + (int8_t)(sinf(rad)*radius);
-        yp1 = y + (int8_t)(cosf(rad)*radius);    
+        xp1 = xp2;
+        yp1 = yp2;
         count++;
-        if(count != approx_segments) {
-            rad = ssd1306_DegToRad(count*approx_degree);
-        } else {
-            rad = ssd1306_DegToRad(loc_sweep);
-        }
-        xp2 = x + (int8_t)(sinf(rad)*radius);
-        yp2 = y + (int8_t)(cosf(rad)*radius);    
+        ssd1306_GetArcPoint(x, y, radius, ssd1306_ArcSegmentAngle(count, approx_segments, loc_sweep), &xp2, &yp2);
         ssd1306_Line(xp1,yp1,xp2,yp2,color);
     }
     
@@ -379,43 +909,29 @@ void ssd1306_DrawArc(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle,
  */
 void ssd1306_DrawArcWithRadiusLine(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color) {
     const uint32_t CIRCLE_APPROXIMATION_SEGMENTS = 36;
-    float approx_degree;
     uint32_t approx_segments;
-    uint8_t xp1;
-    uint8_t xp2 = 0;
-    uint8_t yp1;
-    uint8_t yp2 = 0;
+    uint8_t first_point_x;
+    uint8_t first_point_y;
+    uint8_t last_point_x;
+    uint8_t last_point_y;
     uint32_t count;
     uint32_t loc_sweep;
-    float rad;
     
     loc_sweep = ssd1306_NormalizeTo0_360(sweep);
     
     count = (ssd1306_NormalizeTo0_360(start_angle) * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
     approx_segments = (loc_sweep * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
-    approx_degree = loc_sweep / (float)approx_segments;
-
-    rad = ssd1306_DegToRad(count*approx_degree);
-    uint8_t first_point_x = x + (int8_t)(sinf(rad)*radius);
-    uint8_t first_point_y = y + (int8_t)(cosf(rad)*radius);   
-    while (count < approx_segments) {
-        rad = ssd1306_DegToRad(count*approx_degree);
-        xp1 = x + (int8_t)(sinf(rad)*radius);
-        yp1 = y + (int8_t)(cosf(rad)*radius);    
-        count++;
-        if (count != approx_segments) {
-            rad = ssd1306_DegToRad(count*approx_degree);
-        } else {
-            rad = ssd1306_DegToRad(loc_sweep);
-        }
-        xp2 = x + (int8_t)(sinf(rad)*radius);
-        yp2 = y + (int8_t)(cosf(rad)*radius);    
-        ssd1306_Line(xp1,yp1,xp2,yp2,color);
+    if (count >= approx_segments) {
+        return;
     }
-    
+
+    ssd1306_DrawArc(x, y, radius, start_angle, sweep, color);
+
     // Radius line
+    ssd1306_GetArcPoint(x, y, radius, ssd1306_ArcSegmentAngle(count, approx_segments, loc_sweep), &first_point_x, &first_point_y);
+    ssd1306_GetArcPoint(x, y, radius, loc_sweep, &last_point_x, &last_point_y);
     ssd1306_Line(x,y,first_point_x,first_point_y,color);
-    ssd1306_Line(x,y,xp2,yp2,color);
+    ssd1306_Line(x,y,last_point_x,last_point_y,color);
     return;
 }
 
@@ -492,14 +1008,46 @@ void ssd1306_FillCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR
 
 /* Draw a rectangle */
 void ssd1306_DrawRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color) {
-    ssd1306_Line(x1,y1,x2,y1,color);
-    ssd1306_Line(x2,y1,x2,y2,color);
-    ssd1306_Line(x2,y2,x1,y2,color);
-    ssd1306_Line(x1,y2,x1,y1,color);
+    ssd1306_FillRectangle(x1,y1,x2,y1,color);
+    ssd1306_FillRectangle(x2,y1,x2,y2,color);
+    ssd1306_FillRectangle(x1,y2,x2,y2,color);
+    ssd1306_FillRectangle(x1,y1,x1,y2,color);
 
     return;
 }
 
+/*
+ * Set or clear rows y1..y2 of columns x1..x2, one masked byte per column
+ * and page; whole pages are a memset. The area must be on the screen.
+ */
+static void ssd1306_FillArea(uint8_t x1, uint8_t x2, uint8_t y1, uint8_t y2, SSD1306_COLOR color) {
+    const uint8_t count = x2 - x1 + 1;
+
+    for (uint8_t page = y1 / 8; page <= y2 / 8; page++) {
+        uint8_t* dst = &SSD1306_Buffer[SSD1306_WIDTH * page + x1];
+        uint8_t mask = 0xFF;
+        if (page == y1 / 8) {
+            mask &= 0xFF << (y1 % 8);
+        }
+        if (page == y2 / 8) {
+            mask &= 0xFF >> (7 - (y2 % 8));
+        }
+
+        if (mask == 0xFF) {
+            memset(dst, (color == White) ? 0xFF : 0x00, count);
+        } else if (color == White) {
+            for (uint8_t i = 0; i < count; i++) {
+                dst[i] |= mask;
+            }
+        } else {
+            for (uint8_t i = 0; i < count; i++) {
+                dst[i] &= ~mask;
+            }
+        }
+    }
+    ssd1306_MarkDirty(x1, x2, y1 / 8, y2 / 8);
+}
+
 /* Draw a filled rectangle */
 void ssd1306_FillRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color) {
     uint8_t x_start = ((x1<=x2) ? x1 : x2);
@@ -507,11 +1055,17 @@ void ssd1306_FillRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD13
     uint8_t y_start = ((y1<=y2) ? y1 : y2);
     uint8_t y_end   = ((y1<=y2) ? y2 : y1);
 
-    for (uint8_t y= y_start; (y<= y_end)&&(y<SSD1306_HEIGHT); y++) {
-        for (uint8_t x= x_start; (x<= x_end)&&(x<SSD1306_WIDTH); x++) {
-            ssd1306_DrawPixel(x, y, color);
-        }
+    if (x_start >= SSD1306_WIDTH || y_start >= SSD1306_HEIGHT) {
+        return;
+    }
+    if (x_end >= SSD1306_WIDTH) {
+        x_end = SSD1306_WIDTH - 1;
+    }
+    if (y_end >= SSD1306_HEIGHT) {
+        y_end = SSD1306_HEIGHT - 1;
     }
+
+    ssd1306_FillArea(x_start, x_end, y_start, y_end, color);
     return;
 }
 
@@ -542,34 +1096,95 @@ SSD1306_Error_t ssd1306_InvertRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint
       SSD1306_Buffer[i] ^= mask;
     }
   }
+  ssd1306_MarkDirty(x1, x2, y1 / 8, y2 / 8);
   return SSD1306_OK;
 }
 
+/* Draw a vertical line, one masked byte per page */
+void ssd1306_DrawVLine(uint8_t x, uint8_t y1, uint8_t y2, SSD1306_COLOR color) {
+    if (y1 > y2) {
+        uint8_t tmp = y1;
+        y1 = y2;
+        y2 = tmp;
+    }
+    if (x >= SSD1306_WIDTH || y1 >= SSD1306_HEIGHT) {
+        return;
+    }
+    if (y2 >= SSD1306_HEIGHT) {
+        y2 = SSD1306_HEIGHT - 1;
+    }
+
+    ssd1306_FillArea(x, x, y1, y2, color);
+}
+
+/* Move the columns x1..x2 of pages page1..page2 left by count, clearing the columns freed on the right */
+void ssd1306_ScrollColumnsLeft(uint8_t x1, uint8_t x2, uint8_t page1, uint8_t page2, uint8_t count) {
+    if (x1 > x2 || x2 >= SSD1306_WIDTH || page1 > page2 || page2 >= SSD1306_PAGES) {
+        return;
+    }
+    if (count > x2 - x1 + 1) {
+        count = x2 - x1 + 1;
+    }
+
+    const uint8_t keep = x2 - x1 + 1 - count;
+    for (uint8_t page = page1; page <= page2; page++) {
+        uint8_t* row = &SSD1306_Buffer[page * SSD1306_WIDTH];
+        memmove(&row[x1], &row[x1 + count], keep);
+        memset(&row[x1 + keep], 0x00, count);
+    }
+    ssd1306_MarkDirty(x1, x2, page1, page2);
+}
+
 /* Draw a bitmap */
 void ssd1306_DrawBitmap(uint8_t x, uint8_t y, const unsigned char* bitmap, uint8_t w, uint8_t h, SSD1306_COLOR color) {
     int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
-    uint8_t byte = 0;
 
-    if (x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT) {
+    if (x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT || w == 0 || h == 0) {
         return;
     }
-
-    for (uint8_t j = 0; j < h; j++, y++) {
-        for (uint8_t i = 0; i < w; i++) {
-            if (i & 7) {
-                byte <<= 1;
-            } else {
-                byte = (*(const unsigned char *)(&bitmap[j * byteWidth + i / 8]));
+    // Clip to the screen
+    const uint8_t cols = (x + w > SSD1306_WIDTH) ? SSD1306_WIDTH - x : w;
+    const uint8_t rows = (y + h > SSD1306_HEIGHT) ? SSD1306_HEIGHT - y : h;
+
+    // Every scanline sets or clears one bit in a row of page bytes;
+    // zero bytes of the bitmap (8 transparent pixels) are skipped.
+    for (uint8_t j = 0; j < rows; j++) {
+        const unsigned char* src = &bitmap[j * byteWidth];
+        uint8_t* dst = &SSD1306_Buffer[SSD1306_WIDTH * ((y + j) / 8) + x];
+        const uint8_t bit = 1 << ((y + j) % 8);
+
+        for (uint8_t i = 0; i < cols; i += 8) {
+            const uint8_t byte = src[i / 8];
+            if (byte == 0) {
+                continue;
             }
-
-            if (byte & 0x80) {
-                ssd1306_DrawPixel(x + i, y, color);
+            const uint8_t n = (cols - i < 8) ? cols - i : 8;
+            for (uint8_t k = 0; k < n; k++) {
+                if (byte & (0x80 >> k)) {
+                    if (color == White) {
+                        dst[i + k] |= bit;
+                    } else {
+                        dst[i + k] &= ~bit;
+                    }
+                }
             }
         }
     }
+    ssd1306_MarkDirty(x, x + cols - 1, y / 8, (y + rows - 1) / 8);
     return;
 }
 
+/* Copy a bitmap in the panel's page format, clipped to the screen */
+void ssd1306_DrawBitmapPaged(uint8_t x, uint8_t y, const uint8_t* pages, uint8_t w, uint8_t h, SSD1306_COLOR color) {
+    if (x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT || w == 0 || h == 0) {
+        return;
+    }
+    const uint8_t cols = (x + w > SSD1306_WIDTH) ? SSD1306_WIDTH - x : w;
+    const uint8_t rows = (y + h > SSD1306_HEIGHT) ? SSD1306_HEIGHT - y : h;
+
+    ssd1306_BlitPages(x, y, pages, w, cols, rows, color);
+}
+
 void ssd1306_SetContrast(const uint8_t value) {
     const uint8_t kSetContrastControlRegister = 0x81;
     ssd1306_WriteCommand(kSetContrastControlRegister);
@@ -400,6 +400,7 @@ static const uint16_t Font6x8 [] = {
 #endif
 
 /* see ./examples/custom-fonts/ */
+/* page_data is generated by tools/ssd1306_font_pages.py into ssd1306_fonts_paged.c */
 #ifdef SSD1306_INCLUDE_FONT_16x24
 static const uint16_t Font16x24 [] = {
 /* -- <- these are comments and symbol separators */
@@ -895,21 +896,26 @@ static const uint8_t char_width[] = {
 #endif
 
 #ifdef SSD1306_INCLUDE_FONT_6x8
-const SSD1306_Font_t Font_6x8 = {6, 8, Font6x8, NULL};
+extern const uint8_t Font6x8_Pages[];
+const SSD1306_Font_t Font_6x8 = {6, 8, Font6x8, NULL, Font6x8_Pages, NULL, 0};
 #endif
 #ifdef SSD1306_INCLUDE_FONT_7x10
-const SSD1306_Font_t Font_7x10 = {7, 10, Font7x10, NULL};
+extern const uint8_t Font7x10_Pages[];
+const SSD1306_Font_t Font_7x10 = {7, 10, Font7x10, NULL, Font7x10_Pages, NULL, 0};
 #endif
 #ifdef SSD1306_INCLUDE_FONT_11x18
-const SSD1306_Font_t Font_11x18 = {11, 18, Font11x18, NULL};
+extern const uint8_t Font11x18_Pages[];
+const SSD1306_Font_t Font_11x18 = {11, 18, Font11x18, NULL, Font11x18_Pages, NULL, 0};
 #endif
 #ifdef SSD1306_INCLUDE_FONT_16x26
-const SSD1306_Font_t Font_16x26 = {16, 26, Font16x26, NULL};
+extern const uint8_t Font16x26_Pages[];
+const SSD1306_Font_t Font_16x26 = {16, 26, Font16x26, NULL, Font16x26_Pages, NULL, 0};
 #endif
 
 /* see ./examples/custom-fonts/ */
 #ifdef SSD1306_INCLUDE_FONT_16x24
-const SSD1306_Font_t Font_16x24 = {16, 24, Font16x24, NULL};
+extern const uint8_t Font16x24_Pages[];
+const SSD1306_Font_t Font_16x24 = {16, 24, Font16x24, NULL, Font16x24_Pages, NULL, 0};
 #endif
 
 #ifdef SSD1306_INCLUDE_FONT_16x15
@@ -917,5 +923,6 @@ const SSD1306_Font_t Font_16x24 = {16, 24, Font16x24, NULL};
  * @copyright Google https://github.com/googlefonts/roboto
  * @license This font is licensed under the Apache License, Version 2.0.
 */
-const SSD1306_Font_t Font_16x15 = {16, 15, Font16x15, char_width};
+extern const uint8_t Font16x15_Pages[];
+const SSD1306_Font_t Font_16x15 = {16, 15, Font16x15, char_width, Font16x15_Pages, NULL, 0};
 #endif
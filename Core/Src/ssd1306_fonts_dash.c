@@ -0,0 +1,59 @@
+/*
+ * Font_7x10_Dash: 38 glyphs of Font_7x10 for dashboard.txt.
+ * Generated by tools/ssd1306_font_subset.py, do not edit.
+ */
+
+#include "ssd1306_fonts.h"
+
+#ifdef SSD1306_INCLUDE_FONT_7x10_DASH
+static const uint16_t Font7x10_Dash_Codepoints[] = {
+    0x0020, 0x0021, 0x0025, 0x002A, 0x002D, 0x002E, 0x0030, 0x0031,
+    0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037, 0x0038, 0x0039,
+    0x003A, 0x0043, 0x0045, 0x0047, 0x0049, 0x004E, 0x0061, 0x0068,
+    0x0069, 0x006C, 0x006D, 0x006E, 0x006F, 0x0070, 0x0072, 0x0073,
+    0x0074, 0x0110, 0x0111, 0x1EA9, 0x1EC7, 0x1ED9,
+};
+
+static const uint8_t Font7x10_Dash_Pages[] = {
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // sp
+0x00,0x00,0x00,0xBF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // !
+0x00,0x26,0x19,0x6E,0x94,0x62,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // %
+0x00,0x00,0x0A,0x07,0x0A,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // *
+0x00,0x00,0x20,0x20,0x20,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // -
+0x00,0x00,0x00,0x80,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // .
+0x00,0x7E,0x81,0x89,0x81,0x7E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // 0
+0x00,0x04,0x02,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // 1
+0x00,0x86,0xC1,0xA1,0x91,0x8E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // 2
+0x00,0x42,0x81,0x89,0x89,0x76,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // 3
+0x00,0x30,0x2C,0x22,0xFF,0x20,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // 4
+0x00,0x4F,0x89,0x89,0x89,0x71,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // 5
+0x00,0x7E,0x89,0x89,0x89,0x72,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // 6
+0x00,0x01,0xE1,0x19,0x05,0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // 7
+0x00,0x76,0x89,0x89,0x89,0x76,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // 8
+0x00,0x4E,0x91,0x91,0x91,0x7E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // 9
+0x00,0x00,0x00,0x84,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // :
+0x00,0x7E,0x81,0x81,0x81,0x42,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // C
+0x00,0xFF,0x89,0x89,0x89,0x89,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // E
+0x00,0x7E,0x81,0x91,0x91,0x72,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // G
+0x00,0x00,0x81,0xFF,0x81,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // I
+0x00,0xFF,0x06,0x18,0x60,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // N
+0x00,0x68,0x94,0x94,0x54,0xF8,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // a
+0x00,0xFF,0x08,0x04,0x04,0xF8,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // h
+0x00,0x04,0x04,0xFD,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // i
+0x00,0x01,0x01,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // l
+0x00,0xFC,0x04,0xFC,0x04,0xF8,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // m
+0x00,0xFC,0x08,0x04,0x04,0xF8,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // n
+0x00,0x78,0x84,0x84,0x84,0x78,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // o
+0x00,0xFC,0x48,0x84,0x84,0x78,0x00,0x00,0x03,0x00,0x00,0x00,0x00,0x00,  // p
+0x00,0xFC,0x08,0x04,0x04,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // r
+0x00,0x48,0x94,0x94,0xA4,0x48,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // s
+0x00,0x04,0x7F,0x84,0x84,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // t
+0x08,0xFF,0x89,0x81,0x42,0x3C,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // Đ
+0x00,0x78,0x84,0x84,0x4A,0xFF,0x02,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // đ
+0x00,0x68,0x96,0x95,0x56,0xF9,0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x00,  // ẩ
+0x00,0x78,0x96,0x95,0x96,0x58,0x00,0x00,0x00,0x00,0x02,0x00,0x00,0x00,  // ệ
+0x00,0x78,0x86,0x85,0x86,0x78,0x00,0x00,0x00,0x00,0x02,0x00,0x00,0x00,  // ộ
+};
+
+const SSD1306_Font_t Font_7x10_Dash = {7, 10, NULL, NULL, Font7x10_Dash_Pages, Font7x10_Dash_Codepoints, 38};
+#endif
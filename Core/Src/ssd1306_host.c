@@ -0,0 +1,188 @@
+#include "ssd1306.h"
+
+#if defined(SSD1306_USE_HOST)
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define HOST_PAGES      8
+#define HOST_COLUMNS    128
+
+// Emulated panel
+static uint8_t Host_RAM[HOST_PAGES][HOST_COLUMNS];
+static struct {
+    uint8_t Mode;               // 0 horizontal, 1 vertical, 2 page addressing
+    uint8_t Col, ColStart, ColEnd;
+    uint8_t Page, PageStart, PageEnd;
+    uint8_t DisplayOn;
+    uint8_t Inverse;
+    uint8_t Cmd[7];             // Command being collected with its operands
+    uint8_t CmdLen;
+    uint8_t CmdNeed;
+} Host;
+
+static SSD1306_HostBusStats_t Host_Stats;
+static uint32_t Host_Delayed;
+
+/* Number of operand bytes that follow a command byte */
+static uint8_t ssd1306_HostOperands(uint8_t cmd) {
+    switch (cmd) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+    case 0xD5: case 0xD8: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    case 0x21: case 0x22: case 0xA3:
+        return 2;
+    case 0x29: case 0x2A:
+        return 5;
+    case 0x26: case 0x27:
+        return 6;
+    default:
+        return 0;
+    }
+}
+
+/* Apply a complete command */
+static void ssd1306_HostCommand(const uint8_t* c) {
+    if (c[0] <= 0x0F) {
+        Host.Col = (Host.Col & 0xF0) | c[0];
+    } else if (c[0] <= 0x1F) {
+        Host.Col = (Host.Col & 0x0F) | ((c[0] & 0x0F) << 4);
+    } else if (c[0] >= 0xB0 && c[0] <= 0xB7) {
+        Host.Page = c[0] & 0x07;
+    } else {
+        switch (c[0]) {
+        case 0x20: Host.Mode = c[1] & 0x03; break;
+        case 0x21: Host.ColStart = Host.Col = c[1] & 0x7F; Host.ColEnd = c[2] & 0x7F; break;
+        case 0x22: Host.PageStart = Host.Page = c[1] & 0x07; Host.PageEnd = c[2] & 0x07; break;
+        case 0xA6: Host.Inverse = 0; break;
+        case 0xA7: Host.Inverse = 1; break;
+        case 0xAE: Host.DisplayOn = 0; break;
+        case 0xAF: Host.DisplayOn = 1; break;
+        default: break;         // Timing, contrast, remap etc. don't change the RAM
+        }
+    }
+}
+
+/* Store one display data byte and advance the address like the panel does */
+static void ssd1306_HostData(uint8_t byte) {
+    if (Host.Col < HOST_COLUMNS) {
+        Host_RAM[Host.Page][Host.Col] = byte;
+    }
+
+    if (Host.Mode == 2) {
+        // Page addressing: column wraps within the page
+        Host.Col = (Host.Col + 1) % HOST_COLUMNS;
+    } else if (Host.Mode == 0) {
+        if (Host.Col >= Host.ColEnd) {
+            Host.Col = Host.ColStart;
+            Host.Page = (Host.Page >= Host.PageEnd) ? Host.PageStart : Host.Page + 1;
+        } else {
+            Host.Col++;
+        }
+    } else {
+        if (Host.Page >= Host.PageEnd) {
+            Host.Page = Host.PageStart;
+            Host.Col = (Host.Col >= Host.ColEnd) ? Host.ColStart : Host.Col + 1;
+        } else {
+            Host.Page++;
+        }
+    }
+}
+
+void ssd1306_HostWrite(uint8_t control, const uint8_t* bytes, size_t count) {
+    Host_Stats.Transactions++;
+    Host_Stats.BusBytes += count + SSD1306_HOST_BUS_OVERHEAD;
+
+    if (control == 0x40) {
+        Host_Stats.DataBytes += count;
+        for (size_t i = 0; i < count; i++) {
+            ssd1306_HostData(bytes[i]);
+        }
+        return;
+    }
+
+    Host_Stats.CommandBytes += count;
+    for (size_t i = 0; i < count; i++) {
+        if (Host.CmdLen == 0) {
+            Host.CmdNeed = ssd1306_HostOperands(bytes[i]);
+        }
+        Host.Cmd[Host.CmdLen++] = bytes[i];
+        if (Host.CmdLen > Host.CmdNeed) {
+            ssd1306_HostCommand(Host.Cmd);
+            Host.CmdLen = 0;
+        }
+    }
+}
+
+void ssd1306_HostReset(void) {
+    memset(Host_RAM, 0, sizeof(Host_RAM));
+    memset(&Host, 0, sizeof(Host));
+    // Reset values from the datasheet
+    Host.Mode = 2;
+    Host.ColEnd = HOST_COLUMNS - 1;
+    Host.PageEnd = HOST_PAGES - 1;
+}
+
+void ssd1306_HostGetBusStats(SSD1306_HostBusStats_t* stats) {
+    *stats = Host_Stats;
+}
+
+void ssd1306_HostResetBusStats(void) {
+    memset(&Host_Stats, 0, sizeof(Host_Stats));
+}
+
+const uint8_t* ssd1306_HostGetRAM(void) {
+    return &Host_RAM[0][0];
+}
+
+void ssd1306_HostRender(uint8_t* image) {
+    for (uint16_t y = 0; y < SSD1306_HEIGHT; y++) {
+        for (uint16_t x = 0; x < SSD1306_WIDTH; x++) {
+            uint8_t on = (Host_RAM[y / 8][x] >> (y % 8)) & 1;
+            image[y * SSD1306_WIDTH + x] = Host.DisplayOn ? (on ^ Host.Inverse) : 0;
+        }
+    }
+}
+
+int ssd1306_HostWritePBM(const char* path) {
+    static uint8_t image[SSD1306_WIDTH * SSD1306_HEIGHT];
+    FILE* f = fopen(path, "wb");
+
+    if (!f) {
+        return -1;
+    }
+    ssd1306_HostRender(image);
+
+    // P4: 1 = black, rows padded to whole bytes, MSB first
+    fprintf(f, "P4\n%d %d\n", SSD1306_WIDTH, SSD1306_HEIGHT);
+    for (uint16_t y = 0; y < SSD1306_HEIGHT; y++) {
+        for (uint16_t x = 0; x < SSD1306_WIDTH; x += 8) {
+            uint8_t byte = 0;
+            for (uint8_t b = 0; b < 8 && x + b < SSD1306_WIDTH; b++) {
+                if (!image[y * SSD1306_WIDTH + x + b]) {
+                    byte |= 0x80 >> b;
+                }
+            }
+            fputc(byte, f);
+        }
+    }
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+uint32_t ssd1306_HostDelayed(void) {
+    return Host_Delayed;
+}
+
+/* Delays only move the virtual clock, so test sequences run at full speed */
+void HAL_Delay(uint32_t Delay) {
+    Host_Delayed += Delay;
+}
+
+uint32_t HAL_GetTick(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000u + ts.tv_nsec / 1000000u) + Host_Delayed;
+}
+
+#endif // SSD1306_USE_HOST
@@ -3,6 +3,7 @@
 #include "ssd1306.h"
 #include "ssd1306_tests.h"
 #include "ssd1306_fonts.h"
+#include "ssd1306_widgets.h"
 
 //------------------------------------------------------------------------------
 // Table generated by LCD Assistant
@@ -871,6 +872,42 @@ const unsigned char github_logo_64x64[] = {
 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 };
 
+// 64x64, from github_logo_64x64 by tools/ssd1306_bitmap_pages.py
+const unsigned char github_logo_64x64_pages[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xC0, 0xE0, 0xE0,
+    0xF0, 0xF0, 0xF8, 0xF8, 0xFC, 0xFC, 0xFE, 0xFE, 0xFE, 0xFE, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xFE, 0xFE, 0xFE, 0xFC, 0xFC, 0xFC, 0xF8, 0xF8, 0xF0, 0xF0,
+    0xE0, 0xE0, 0xC0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xFC, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x1F,
+    0x1F, 0x1F, 0x3F, 0x3F, 0x3F, 0x7F, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x7F, 0x7F,
+    0x7F, 0x7F, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x3F, 0x3F, 0x3F, 0x1F, 0x1F,
+    0x1F, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xFC, 0xF0, 0xE0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0xC0, 0xF0, 0xFC, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x30, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x20, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFC, 0xF0, 0x80, 0x00,
+    0xF8, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x03, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x01, 0x1F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF8,
+    0x1F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xE0, 0x80, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x80, 0xE0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x1F,
+    0x00, 0x03, 0x0F, 0x3F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xCF, 0x8F, 0x1F, 0x1F, 0x3F, 0x7E, 0xFC,
+    0xF8, 0xF8, 0xF0, 0xE0, 0xE0, 0xE0, 0xC0, 0xC0, 0xC0, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xC0, 0xC0, 0xE0, 0xE0, 0xE0, 0xF0, 0xF0, 0xF8,
+    0xFC, 0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3F, 0x0F, 0x01, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x07, 0x0F, 0x3F, 0x7F, 0xFF, 0xFF, 0xFC, 0xF0, 0xE0, 0xC1,
+    0x83, 0x83, 0x87, 0x87, 0x87, 0x87, 0x87, 0x87, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x3F, 0x0F, 0x07, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x07, 0x07,
+    0x0F, 0x0F, 0x1F, 0x1F, 0x3F, 0x3F, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x3F, 0x3F, 0x1F, 0x1F, 0x0F, 0x0F,
+    0x07, 0x07, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
 void ssd1306_TestBorder() {
     ssd1306_Fill(Black);
    
@@ -1013,6 +1050,329 @@ void ssd1306_TestFPS() {
     ssd1306_UpdateScreen();
 }
 
+// Frame transfer as ssd1306_UpdateScreen did it before the single burst:
+// page address and column nibbles as separate commands before each page.
+static void ssd1306_UpdateScreenPaged(void) {
+    uint8_t* buffer = ssd1306_GetBuffer();
+
+    for(uint8_t i = 0; i < SSD1306_HEIGHT/8; i++) {
+        ssd1306_WriteCommand(0xB0 + i); // Set the current RAM page address.
+        ssd1306_WriteCommand(0x00 + SSD1306_X_OFFSET_LOWER);
+        ssd1306_WriteCommand(0x10 + SSD1306_X_OFFSET_UPPER);
+        ssd1306_WriteData(&buffer[SSD1306_WIDTH*i], SSD1306_WIDTH);
+    }
+}
+
+void ssd1306_TestFrameTime() {
+    const int frames = 20;
+    uint32_t start;
+    uint32_t paged;
+    uint32_t burst;
+    char buff[32];
+
+    ssd1306_Fill(Black);
+    ssd1306_SetCursor(2, 0);
+    ssd1306_WriteString("Frame time", Font_7x10, White);
+    ssd1306_UpdateScreen();
+
+    // Before: 4 transactions per page
+    start = HAL_GetTick();
+    for(int i = 0; i < frames; i++) {
+        ssd1306_UpdateScreenPaged();
+    }
+    paged = HAL_GetTick() - start;
+
+    // After: one window, one transfer
+    start = HAL_GetTick();
+    for(int i = 0; i < frames; i++) {
+        ssd1306_Invalidate();
+        ssd1306_UpdateScreen();
+    }
+    burst = HAL_GetTick() - start;
+
+    snprintf(buff, sizeof(buff), "Paged: %lu.%lu ms",
+             (unsigned long)(paged / frames), (unsigned long)((paged * 10 / frames) % 10));
+    ssd1306_SetCursor(2, 20);
+    ssd1306_WriteString(buff, Font_7x10, White);
+    snprintf(buff, sizeof(buff), "Burst: %lu.%lu ms",
+             (unsigned long)(burst / frames), (unsigned long)((burst * 10 / frames) % 10));
+    ssd1306_SetCursor(2, 34);
+    ssd1306_WriteString(buff, Font_7x10, White);
+    ssd1306_UpdateScreen();
+}
+
+/*
+ * Benchmark suite
+ *
+ * Every primitive is timed on its own with a cycle counter (DWT CYCCNT on
+ * Cortex-M3/M4/M7, nanoseconds on the host) and reported as one line:
+ *
+ *   BENCH,begin,<build>,<timer Hz>
+ *   BENCH,<name>,<calls>,<cycles per call>,<bus bytes>
+ *   BENCH,end
+ *
+ * Bus bytes is what ssd1306_UpdateScreen puts on the bus to show the
+ * result of one call on a black screen: data, address window commands and,
+ * on I2C, the address/control byte of every transaction.
+ */
+
+#if defined(SSD1306_USE_SPI)
+// Per address window: 6 command bytes, SPI has no framing bytes
+#define SSD1306_BENCH_WINDOW_BYTES  6
+#else
+// Per address window: 6 command bytes, 2 transactions of address + control byte
+#define SSD1306_BENCH_WINDOW_BYTES  (6 + 2 * 2)
+#endif
+
+#if defined(SSD1306_USE_HOST)
+#include <time.h>
+
+#define SSD1306_BENCH_TIMER_HZ      1000000000UL
+
+static void ssd1306_BenchTimerInit(void) {
+}
+
+static uint32_t ssd1306_BenchTimer(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+#elif defined(DWT)
+#define SSD1306_BENCH_TIMER_HZ      SystemCoreClock
+
+static void ssd1306_BenchTimerInit(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static uint32_t ssd1306_BenchTimer(void) {
+    return DWT->CYCCNT;
+}
+#else
+// No cycle counter (Cortex-M0/M0+): SysTick milliseconds scaled to cycles
+#define SSD1306_BENCH_TIMER_HZ      SystemCoreClock
+
+static void ssd1306_BenchTimerInit(void) {
+}
+
+static uint32_t ssd1306_BenchTimer(void) {
+    return HAL_GetTick() * (SystemCoreClock / 1000);
+}
+#endif
+
+typedef struct {
+    const char* Name;
+    void (*Draw)(void);
+    uint32_t Calls;
+    // Optional, runs before call i outside the timed region
+    void (*Prepare)(uint32_t i);
+} SSD1306_Bench_t;
+
+static void ssd1306_BenchFill(void) {
+    ssd1306_Fill(White);
+}
+
+static void ssd1306_BenchString(const SSD1306_Font_t* font) {
+    ssd1306_SetCursor(0, 0);
+    ssd1306_WriteString("Bench 123", *font, White);
+}
+
+#ifdef SSD1306_INCLUDE_FONT_6x8
+static void ssd1306_BenchString6x8(void) {
+    ssd1306_BenchString(&Font_6x8);
+}
+#endif
+
+#ifdef SSD1306_INCLUDE_FONT_7x10
+static void ssd1306_BenchString7x10(void) {
+    ssd1306_BenchString(&Font_7x10);
+}
+#endif
+
+#ifdef SSD1306_INCLUDE_FONT_11x18
+static void ssd1306_BenchString11x18(void) {
+    ssd1306_BenchString(&Font_11x18);
+}
+#endif
+
+#ifdef SSD1306_INCLUDE_FONT_16x26
+static void ssd1306_BenchString16x26(void) {
+    ssd1306_BenchString(&Font_16x26);
+}
+#endif
+
+#ifdef SSD1306_INCLUDE_FONT_16x24
+static void ssd1306_BenchString16x24(void) {
+    ssd1306_BenchString(&Font_16x24);
+}
+#endif
+
+#ifdef SSD1306_INCLUDE_FONT_16x15
+static void ssd1306_BenchString16x15(void) {
+    ssd1306_BenchString(&Font_16x15);
+}
+#endif
+
+#ifdef SSD1306_INCLUDE_FONT_7x10_DASH
+// Subset font: UTF-8 decoding and glyph lookup by code point
+static void ssd1306_BenchStringDash(void) {
+    ssd1306_SetCursor(0, 0);
+    ssd1306_WriteString("Nhiệt độ: 25.3 C", Font_7x10_Dash, White);
+}
+#endif
+
+static void ssd1306_BenchLine(void) {
+    ssd1306_Line(0, 0, SSD1306_WIDTH - 1, SSD1306_HEIGHT - 1, White);
+}
+
+static void ssd1306_BenchFillCircle(void) {
+    ssd1306_FillCircle(SSD1306_WIDTH / 2, SSD1306_HEIGHT / 2, 20, White);
+}
+
+static void ssd1306_BenchDrawArc(void) {
+    ssd1306_DrawArc(SSD1306_WIDTH / 2, SSD1306_HEIGHT / 2, 20, 45, 270, White);
+}
+
+static void ssd1306_BenchDrawBitmap(void) {
+    ssd1306_DrawBitmap(32, 0, github_logo_64x64, 64, 64, White);
+}
+
+static void ssd1306_BenchDrawBitmapPaged(void) {
+    ssd1306_DrawBitmapPaged(32, 0, github_logo_64x64_pages, 64, 64, White);
+}
+
+static void ssd1306_BenchFillRectangle(void) {
+    ssd1306_FillRectangle(16, 8, SSD1306_WIDTH - 17, SSD1306_HEIGHT - 9, White);
+}
+
+static void ssd1306_BenchInvertRectangle(void) {
+    ssd1306_InvertRectangle(16, 8, SSD1306_WIDTH - 17, SSD1306_HEIGHT - 9);
+}
+
+static void ssd1306_BenchUpdateScreenPrepare(uint32_t i) {
+    // Alternate the content so every frame really goes out in full
+    ssd1306_Fill((i & 1) ? Black : White);
+}
+
+static void ssd1306_BenchUpdateScreen(void) {
+    ssd1306_UpdateScreen();
+}
+
+static const SSD1306_Bench_t ssd1306_Benches[] = {
+    { "Fill",               ssd1306_BenchFill,              100, NULL },
+#ifdef SSD1306_INCLUDE_FONT_6x8
+    { "WriteString6x8",     ssd1306_BenchString6x8,         100, NULL },
+#endif
+#ifdef SSD1306_INCLUDE_FONT_7x10
+    { "WriteString7x10",    ssd1306_BenchString7x10,        100, NULL },
+#endif
+#ifdef SSD1306_INCLUDE_FONT_11x18
+    { "WriteString11x18",   ssd1306_BenchString11x18,       100, NULL },
+#endif
+#ifdef SSD1306_INCLUDE_FONT_16x26
+    { "WriteString16x26",   ssd1306_BenchString16x26,       100, NULL },
+#endif
+#ifdef SSD1306_INCLUDE_FONT_16x24
+    { "WriteString16x24",   ssd1306_BenchString16x24,       100, NULL },
+#endif
+#ifdef SSD1306_INCLUDE_FONT_16x15
+    { "WriteString16x15",   ssd1306_BenchString16x15,       100, NULL },
+#endif
+#ifdef SSD1306_INCLUDE_FONT_7x10_DASH
+    { "WriteString7x10Dash", ssd1306_BenchStringDash,        100, NULL },
+#endif
+    { "Line",               ssd1306_BenchLine,              100, NULL },
+    { "FillCircle",         ssd1306_BenchFillCircle,        100, NULL },
+    { "DrawArc",            ssd1306_BenchDrawArc,           100, NULL },
+    { "DrawBitmap",         ssd1306_BenchDrawBitmap,        100, NULL },
+    { "DrawBitmapPaged",    ssd1306_BenchDrawBitmapPaged,   100, NULL },
+    { "FillRectangle",      ssd1306_BenchFillRectangle,     100, NULL },
+    { "InvertRectangle",    ssd1306_BenchInvertRectangle,   100, NULL },
+    { "UpdateScreen",       ssd1306_BenchUpdateScreen,      20,
+                            ssd1306_BenchUpdateScreenPrepare },
+};
+
+/* Called with every result line ("BENCH,...\r\n"). Override to send it somewhere. */
+__weak void ssd1306_BenchmarkOutput(const char* line) {
+    (void)line;
+}
+
+static void ssd1306_BenchRun(const SSD1306_Bench_t* bench, SSD1306_BenchResult_t* result) {
+    SSD1306_FlushStats_t stats;
+
+    // Time the calls alone, from a screen that matches the panel
+    ssd1306_Fill(Black);
+    ssd1306_UpdateScreen();
+    uint32_t elapsed = 0;
+    if (bench->Prepare == NULL) {
+        const uint32_t start = ssd1306_BenchTimer();
+        for (uint32_t i = 0; i < bench->Calls; i++) {
+            bench->Draw();
+        }
+        elapsed = ssd1306_BenchTimer() - start;
+    } else {
+        // Time each call on its own so the preparation stays out of it
+        for (uint32_t i = 0; i < bench->Calls; i++) {
+            bench->Prepare(i);
+            const uint32_t start = ssd1306_BenchTimer();
+            bench->Draw();
+            elapsed += ssd1306_BenchTimer() - start;
+        }
+    }
+
+    // Bus cost of one call; UpdateScreen flushes by itself
+    ssd1306_Fill(Black);
+    ssd1306_UpdateScreen();
+    if (bench->Prepare != NULL) {
+        bench->Prepare(0);
+    }
+    ssd1306_ResetFlushStats();
+    bench->Draw();
+    ssd1306_GetFlushStats(&stats);
+    if (stats.Flushes == 0) {
+        ssd1306_UpdateScreen();
+        ssd1306_GetFlushStats(&stats);
+    }
+
+    result->Name = bench->Name;
+    result->Calls = bench->Calls;
+    result->CyclesPerCall = elapsed / bench->Calls;
+    result->BusBytes = stats.LastBytesSent + stats.LastSpans * SSD1306_BENCH_WINDOW_BYTES;
+}
+
+void ssd1306_TestBenchmark() {
+    const uint8_t count = sizeof(ssd1306_Benches) / sizeof(ssd1306_Benches[0]);
+    SSD1306_BenchResult_t result;
+    char line[80];
+
+    ssd1306_BenchTimerInit();
+
+    snprintf(line, sizeof(line), "BENCH,begin,%s %s,%lu\r\n",
+             __DATE__, __TIME__, (unsigned long)SSD1306_BENCH_TIMER_HZ);
+    ssd1306_BenchmarkOutput(line);
+
+    for (uint8_t i = 0; i < count; i++) {
+        ssd1306_BenchRun(&ssd1306_Benches[i], &result);
+        snprintf(line, sizeof(line), "BENCH,%s,%lu,%lu,%lu\r\n", result.Name,
+                 (unsigned long)result.Calls, (unsigned long)result.CyclesPerCall,
+                 (unsigned long)result.BusBytes);
+        ssd1306_BenchmarkOutput(line);
+    }
+
+    ssd1306_BenchmarkOutput("BENCH,end\r\n");
+
+    // Frame cost of the last run (UpdateScreen) on the panel
+    snprintf(line, sizeof(line), "Frame: %lu us",
+             (unsigned long)((uint64_t)result.CyclesPerCall * 1000000 / SSD1306_BENCH_TIMER_HZ));
+    ssd1306_Fill(Black);
+    ssd1306_SetCursor(2, 0);
+    ssd1306_WriteString("Benchmark", Font_7x10, White);
+    ssd1306_SetCursor(2, 20);
+    ssd1306_WriteString(line, Font_7x10, White);
+    ssd1306_UpdateScreen();
+}
+
 void ssd1306_TestLine() {
 
   ssd1306_Line(1,1,SSD1306_WIDTH - 1,SSD1306_HEIGHT - 1,White);
@@ -1085,6 +1445,18 @@ void ssd1306_TestArc() {
   return;
 }
 
+void ssd1306_TestGauge() {
+  SSD1306_GaugeWidget_t gauge;
+
+  // Needle swings from min to max and back, one step per frame
+  ssd1306_GaugeInit(&gauge, SSD1306_WIDTH / 2, SSD1306_HEIGHT - 4, 40, 90, 180, 0, 100, White);
+  for (int16_t i = 0; i <= 200; i += 2) {
+    ssd1306_GaugeSet(&gauge, (i <= 100) ? i : 200 - i);
+    ssd1306_UpdateScreen();
+  }
+  return;
+}
+
 void ssd1306_TestPolyline() {
   SSD1306_VERTEX loc_vertex[] =
   {
@@ -1115,6 +1487,11 @@ void ssd1306_TestDrawBitmap()
     ssd1306_Fill(White);
     ssd1306_DrawBitmap(32,0,github_logo_64x64,64,64,Black);
     ssd1306_UpdateScreen();
+    HAL_Delay(3000);
+    // Same logo in page format, copied band by band
+    ssd1306_Fill(Black);
+    ssd1306_DrawBitmapPaged(32,0,github_logo_64x64_pages,64,64,White);
+    ssd1306_UpdateScreen();
 }
 
 /*void ssd1306_IconBehoa()
@@ -1187,6 +1564,10 @@ void ssd1306_TestAll() {
 
     ssd1306_TestFPS();
     HAL_Delay(3000);
+    ssd1306_TestBenchmark();
+    HAL_Delay(3000);
+    ssd1306_TestFrameTime();
+    HAL_Delay(3000);
     ssd1306_TestBorder();
     ssd1306_TestFonts1();
     HAL_Delay(3000);
@@ -1211,6 +1592,9 @@ void ssd1306_TestAll() {
     ssd1306_TestArc();
     HAL_Delay(3000);
     ssd1306_Fill(Black);
+    ssd1306_TestGauge();
+    HAL_Delay(3000);
+    ssd1306_Fill(Black);
     ssd1306_TestCircle();
     HAL_Delay(3000);
     ssd1306_TestDrawBitmap();
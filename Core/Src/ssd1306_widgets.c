@@ -0,0 +1,291 @@
+#include <string.h>
+#include "ssd1306_widgets.h"
+#include "fmt.h"
+
+/* Paint the text and clear the rest of the box */
+static void ssd1306_WidgetPaint(SSD1306_Widget_t* w) {
+    const uint8_t x2 = w->X + w->Chars * w->Font->width - 1;
+
+    ssd1306_SetCursor(w->X, w->Y);
+    ssd1306_WriteString(w->Text, *w->Font, w->Color);
+
+    // Text that got shorter leaves old pixels behind
+    uint8_t x = ssd1306_GetCursorX();
+    if (x <= x2) {
+        ssd1306_FillRectangle(x, w->Y, x2, w->Y + w->Font->height - 1, (SSD1306_COLOR)!w->Color);
+    }
+    w->Drawn = 1;
+}
+
+/* Bytes of the first chars characters of text, whole UTF-8 sequences within size - 1 bytes */
+static uint8_t ssd1306_WidgetFit(const char* text, uint8_t chars, uint8_t size) {
+    const char* end = text;
+
+    while (*end && chars > 0) {
+        const char* next = end;
+        ssd1306_Utf8Next(&next);
+        if (next - text > size - 1) {
+            break;
+        }
+        end = next;
+        chars--;
+    }
+    return (uint8_t)(end - text);
+}
+
+void ssd1306_WidgetInit(SSD1306_Widget_t* w, uint8_t x, uint8_t y, uint8_t chars,
+                        const SSD1306_Font_t* font, SSD1306_COLOR color) {
+    w->X = x;
+    w->Y = y;
+    w->Chars = chars > SSD1306_WIDGET_MAX_CHARS ? SSD1306_WIDGET_MAX_CHARS : chars;
+    w->Color = color;
+    w->Font = font;
+    w->Text[0] = '\0';
+    w->Drawn = 0;
+}
+
+uint8_t ssd1306_WidgetSetText(SSD1306_Widget_t* w, const char* text) {
+    const uint8_t len = ssd1306_WidgetFit(text, w->Chars, sizeof(w->Text));
+
+    if (w->Drawn && w->Text[len] == '\0' && strncmp(w->Text, text, len) == 0) {
+        return 0;
+    }
+
+    memcpy(w->Text, text, len);
+    w->Text[len] = '\0';
+    ssd1306_WidgetPaint(w);
+    return 1;
+}
+
+void ssd1306_WidgetRedraw(SSD1306_Widget_t* w) {
+    ssd1306_WidgetPaint(w);
+}
+
+void ssd1306_LabelInit(SSD1306_Widget_t* w, uint8_t x, uint8_t y, const char* text,
+                       const SSD1306_Font_t* font, SSD1306_COLOR color) {
+    const char* p = text;
+    uint8_t chars = 0;
+
+    while (ssd1306_Utf8Next(&p)) {
+        chars++;
+    }
+    ssd1306_WidgetInit(w, x, y, chars, font, color);
+    ssd1306_WidgetSetText(w, text);
+}
+
+void ssd1306_ValueInit(SSD1306_ValueWidget_t* w, uint8_t x, uint8_t y, uint8_t chars,
+                       const SSD1306_Font_t* font, SSD1306_COLOR color,
+                       uint8_t decimals, const char* unit) {
+    ssd1306_WidgetInit(&w->Field, x, y, chars, font, color);
+    w->Unit = unit;
+    w->Decimals = decimals;
+    w->HasValue = 0;
+    w->Value = 0;
+}
+
+uint8_t ssd1306_ValueSet(SSD1306_ValueWidget_t* w, int32_t value) {
+    char text[SSD1306_WIDGET_TEXT_SIZE];
+    FMT_Buffer b;
+
+    if (w->HasValue && w->Value == value) {
+        return 0;
+    }
+    w->HasValue = 1;
+    w->Value = value;
+
+    FMT_Init(&b, text, sizeof(text));
+    FMT_PutFixed(&b, value, w->Decimals, 0);
+    FMT_PutStr(&b, w->Unit);
+    return ssd1306_WidgetSetText(&w->Field, text);
+}
+
+uint8_t ssd1306_ValueSetText(SSD1306_ValueWidget_t* w, const char* text) {
+    w->HasValue = 0;
+    return ssd1306_WidgetSetText(&w->Field, text);
+}
+
+void ssd1306_MarkerInit(SSD1306_MarkerWidget_t* w, uint8_t x, uint8_t y, uint8_t chars,
+                        const SSD1306_Font_t* font, SSD1306_COLOR color,
+                        const char* const* symbols, uint8_t count) {
+    ssd1306_WidgetInit(&w->Field, x, y, chars, font, color);
+    w->Symbols = symbols;
+    w->Count = count;
+    w->State = 0;
+}
+
+uint8_t ssd1306_MarkerSet(SSD1306_MarkerWidget_t* w, uint8_t state) {
+    if (state >= w->Count) {
+        return 0;
+    }
+    if (w->Field.Drawn && w->State == state) {
+        return 0;
+    }
+    w->State = state;
+    return ssd1306_WidgetSetText(&w->Field, w->Symbols[state]);
+}
+
+void ssd1306_HistoryInit(SSD1306_History_t* h, uint8_t decimation) {
+    memset(h, 0, sizeof(*h));
+    h->Decimation = decimation ? decimation : 1;
+}
+
+uint8_t ssd1306_HistoryPush(SSD1306_History_t* h, int16_t sample) {
+    h->Sum += sample;
+    if (++h->Pending < h->Decimation) {
+        return 0;
+    }
+
+    h->Samples[h->Head] = (int16_t)(h->Sum / h->Pending);
+    h->Head = (h->Head + 1) % SSD1306_HISTORY_LEN;
+    if (h->Count < SSD1306_HISTORY_LEN) {
+        h->Count++;
+    }
+    h->Stored++;
+    h->Sum = 0;
+    h->Pending = 0;
+    return 1;
+}
+
+int16_t ssd1306_HistoryGet(const SSD1306_History_t* h, uint8_t age) {
+    return h->Samples[(h->Head + SSD1306_HISTORY_LEN - 1 - age) % SSD1306_HISTORY_LEN];
+}
+
+/* Row of a value inside the plot area */
+static uint8_t ssd1306_PlotRow(const SSD1306_PlotWidget_t* w, int16_t value) {
+    const uint8_t top = w->Page1 * 8;
+    const uint8_t bottom = w->Page2 * 8 + 7;
+
+    if (value <= w->Min) {
+        return bottom;
+    }
+    if (value >= w->Max) {
+        return top;
+    }
+    return bottom - (uint8_t)((int32_t)(value - w->Min) * (bottom - top) / (w->Max - w->Min));
+}
+
+/* Draw one point into column x; the column must be clear */
+static void ssd1306_PlotColumn(SSD1306_PlotWidget_t* w, uint8_t x, int16_t value, uint8_t first) {
+    const uint8_t y = ssd1306_PlotRow(w, value);
+
+    if (w->Style == SSD1306_PLOT_BARS) {
+        ssd1306_DrawVLine(x, y, w->Page2 * 8 + 7, w->Color);
+    } else {
+        ssd1306_DrawVLine(x, first ? y : w->LastY, y, w->Color);
+    }
+    w->LastY = y;
+}
+
+void ssd1306_PlotInit(SSD1306_PlotWidget_t* w, uint8_t x, uint8_t y, uint8_t width, uint8_t height,
+                      const SSD1306_History_t* history, int16_t min, int16_t max,
+                      SSD1306_PlotStyle_t style, SSD1306_COLOR color) {
+    w->X = x;
+    w->Width = width > SSD1306_HISTORY_LEN ? SSD1306_HISTORY_LEN : width;
+    w->Page1 = y / 8;
+    w->Page2 = (y + height) / 8 - 1;
+    w->Min = min;
+    w->Max = max > min ? max : min + 1;
+    w->Style = style;
+    w->Color = color;
+    w->History = history;
+    w->Shown = 0;
+    w->LastY = 0;
+    w->Drawn = 0;
+}
+
+void ssd1306_PlotRedraw(SSD1306_PlotWidget_t* w) {
+    const SSD1306_History_t* h = w->History;
+    const uint8_t n = h->Count < w->Width ? h->Count : w->Width;
+
+    // Clears the whole area: shifting by the full width frees every column
+    ssd1306_ScrollColumnsLeft(w->X, w->X + w->Width - 1, w->Page1, w->Page2, w->Width);
+
+    // The leftmost point joins the older one scrolled out, as it did on screen
+    uint8_t first = 1;
+    if (h->Count > n) {
+        w->LastY = ssd1306_PlotRow(w, ssd1306_HistoryGet(h, n));
+        first = 0;
+    }
+    for (uint8_t i = 0; i < n; i++) {
+        ssd1306_PlotColumn(w, w->X + w->Width - n + i, ssd1306_HistoryGet(h, n - 1 - i), first);
+        first = 0;
+    }
+    w->Shown = h->Stored;
+    w->Drawn = 1;
+}
+
+uint8_t ssd1306_PlotUpdate(SSD1306_PlotWidget_t* w) {
+    const SSD1306_History_t* h = w->History;
+    const uint16_t fresh = h->Stored - w->Shown;
+
+    if (w->Drawn && fresh == 0) {
+        return 0;
+    }
+    if (!w->Drawn || fresh >= w->Width) {
+        ssd1306_PlotRedraw(w);
+        return 1;
+    }
+
+    ssd1306_ScrollColumnsLeft(w->X, w->X + w->Width - 1, w->Page1, w->Page2, fresh);
+    for (uint8_t i = 0; i < fresh; i++) {
+        // Only the first point ever has nothing to join to
+        const uint8_t first = (h->Count - fresh + i == 0);
+        ssd1306_PlotColumn(w, w->X + w->Width - fresh + i, ssd1306_HistoryGet(h, fresh - 1 - i), first);
+    }
+    w->Shown = h->Stored;
+    return 1;
+}
+
+/* Needle from the centre towards angle */
+static void ssd1306_GaugeNeedle(const SSD1306_GaugeWidget_t* w, uint16_t angle, SSD1306_COLOR color) {
+    uint8_t x;
+    uint8_t y;
+
+    ssd1306_GetArcPoint(w->X, w->Y, w->Radius > 3 ? w->Radius - 3 : 0, angle, &x, &y);
+    ssd1306_Line(w->X, w->Y, x, y, color);
+}
+
+void ssd1306_GaugeInit(SSD1306_GaugeWidget_t* w, uint8_t x, uint8_t y, uint8_t radius,
+                       uint16_t start, uint16_t sweep, int16_t min, int16_t max,
+                       SSD1306_COLOR color) {
+    w->X = x;
+    w->Y = y;
+    w->Radius = radius;
+    w->Start = start;
+    w->Sweep = start + sweep <= 360 ? sweep : 360 - start;
+    w->Min = min;
+    w->Max = max > min ? max : min + 1;
+    w->Color = color;
+    w->Angle = start;
+    w->Drawn = 0;
+}
+
+void ssd1306_GaugeRedraw(SSD1306_GaugeWidget_t* w) {
+    ssd1306_DrawArc(w->X, w->Y, w->Radius, w->Start, w->Start + w->Sweep, w->Color);
+    ssd1306_GaugeNeedle(w, w->Angle, w->Color);
+    w->Drawn = 1;
+}
+
+uint8_t ssd1306_GaugeSet(SSD1306_GaugeWidget_t* w, int16_t value) {
+    if (value < w->Min) {
+        value = w->Min;
+    } else if (value > w->Max) {
+        value = w->Max;
+    }
+    const uint16_t angle = w->Start + (uint16_t)((int32_t)(value - w->Min) * w->Sweep / (w->Max - w->Min));
+
+    if (!w->Drawn) {
+        w->Angle = angle;
+        ssd1306_GaugeRedraw(w);
+        return 1;
+    }
+    if (angle == w->Angle) {
+        return 0;
+    }
+
+    const SSD1306_COLOR background = (w->Color == White) ? Black : White;
+    ssd1306_GaugeNeedle(w, w->Angle, background);
+    ssd1306_GaugeNeedle(w, angle, w->Color);
+    w->Angle = angle;
+    return 1;
+}
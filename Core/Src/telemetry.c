@@ -0,0 +1,303 @@
+/**
+  ******************************************************************************
+  * @file           : telemetry.c
+  * @brief          : Frame nhị phân STM32 <-> ESP8266 qua UART5 (COBS + CRC16)
+  * @created        : Oct 18, 2026
+  * @author         : NguyenHoa
+  * @version        : 1.7.0
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "telemetry.h"
+#include <string.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define TELEM_HEADER(type) (uint8_t)((TELEM_PROTOCOL_VERSION << 4) | (type))
+
+/* Private functions ---------------------------------------------------------*/
+static void PutU16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void PutU32(uint8_t *p, uint32_t v) {
+    PutU16(p, (uint16_t)v);
+    PutU16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t GetU16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t GetU32(const uint8_t *p) {
+    return (uint32_t)GetU16(p) | ((uint32_t)GetU16(p + 2) << 16);
+}
+
+/**
+  * @brief  CRC-16/CCITT-FALSE (đa thức 0x1021, giá trị đầu 0xFFFF)
+  * @param  data: dữ liệu
+  * @param  len: số byte
+  * @retval CRC, "123456789" -> 0x29B1
+  */
+uint16_t TELEM_Crc16(const uint8_t *data, uint16_t len) {
+    uint16_t crc = 0xFFFF;
+
+    while (len--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+  * @brief  Mã hóa COBS: bỏ mọi byte 0x00 khỏi dữ liệu
+  * @param  src: dữ liệu gốc
+  * @param  len: số byte gốc
+  * @param  dst: bộ đệm đích, ít nhất len + len / 254 + 1 byte, không được trùng src
+  * @retval Số byte đã ghi (không có dấu kết thúc 0x00)
+  */
+uint16_t TELEM_CobsEncode(const uint8_t *src, uint16_t len, uint8_t *dst) {
+    uint16_t code_pos = 0;     // Vị trí byte mã của khối hiện tại
+    uint16_t out = 1;
+    uint8_t code = 1;
+
+    for (uint16_t i = 0; i < len; i++) {
+        if (src[i] == 0) {
+            dst[code_pos] = code;
+            code_pos = out++;
+            code = 1;
+            continue;
+        }
+        dst[out++] = src[i];
+        if (++code == 0xFF) {
+            // Khối đầy 254 byte khác 0
+            dst[code_pos] = code;
+            code_pos = out++;
+            code = 1;
+        }
+    }
+    dst[code_pos] = code;
+    return out;
+}
+
+/**
+  * @brief  Giải mã COBS
+  * @param  src: dữ liệu đã mã hóa, không có dấu kết thúc 0x00
+  * @param  len: số byte
+  * @param  dst: bộ đệm đích, ít nhất len byte, có thể trùng src (giải mã tại chỗ)
+  * @retval Số byte gốc, 0 nếu dữ liệu không hợp lệ
+  */
+uint16_t TELEM_CobsDecode(const uint8_t *src, uint16_t len, uint8_t *dst) {
+    uint16_t in = 0;
+    uint16_t out = 0;
+
+    while (in < len) {
+        const uint8_t code = src[in++];
+        if (code == 0 || in + code - 1 > len) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            if (src[in] == 0) {
+                return 0;
+            }
+            dst[out++] = src[in++];
+        }
+        // Khối ngắn hơn 254 byte kết thúc bằng một byte 0, trừ khối cuối
+        if (code != 0xFF && in < len) {
+            dst[out++] = 0;
+        }
+    }
+    return out;
+}
+
+/**
+  * @brief  Ghép payload, CRC16 và COBS thành frame hoàn chỉnh
+  * @param  payload: header và nội dung
+  * @param  len: số byte payload, tối đa TELEM_PAYLOAD_MAX
+  * @param  frame: bộ đệm đích
+  * @param  size: kích thước bộ đệm, cần TELEM_FRAME_SIZE(len)
+  * @retval Số byte frame kể cả 0x00 cuối, 0 nếu không đủ chỗ
+  */
+uint16_t TELEM_EncodeFrame(const uint8_t *payload, uint16_t len, uint8_t *frame, uint16_t size) {
+    uint8_t raw[TELEM_PAYLOAD_MAX + 2];
+
+    if (len == 0 || len > TELEM_PAYLOAD_MAX || size < TELEM_FRAME_SIZE(len)) {
+        return 0;
+    }
+    memcpy(raw, payload, len);
+    PutU16(&raw[len], TELEM_Crc16(payload, len));
+
+    uint16_t n = TELEM_CobsEncode(raw, len + 2, frame);
+    frame[n++] = 0x00;
+    return n;
+}
+
+/**
+  * @brief  Tách payload từ một frame và kiểm tra CRC
+  * @param  frame: các byte giữa hai dấu 0x00 (không kể 0x00)
+  * @param  len: số byte
+  * @param  payload: bộ đệm đích
+  * @param  size: kích thước bộ đệm
+  * @retval Số byte payload, 0 nếu frame hỏng, sai CRC hoặc không vừa bộ đệm
+  */
+uint16_t TELEM_DecodeFrame(const uint8_t *frame, uint16_t len, uint8_t *payload, uint16_t size) {
+    uint8_t raw[TELEM_FRAME_SIZE(TELEM_PAYLOAD_MAX)];
+
+    if (len < 4 || len > sizeof(raw)) {
+        return 0;
+    }
+    uint16_t n = TELEM_CobsDecode(frame, len, raw);
+    if (n < 3 || n - 2 > size) {
+        return 0;
+    }
+    n -= 2;
+    if (TELEM_Crc16(raw, n) != (uint16_t)(raw[n] | (raw[n + 1] << 8))) {
+        return 0;
+    }
+    memcpy(payload, raw, n);
+    return n;
+}
+
+/**
+  * @brief  Tạo frame TELEM_TYPE_BATCH
+  * @param  firstSeq: số thứ tự của records[0]
+  * @param  batchFlags: TELEM_BATCH_*
+  * @param  records: các bản ghi liên tiếp
+  * @param  count: số bản ghi, 1..TELEM_BATCH_MAX
+  * @param  frame: bộ đệm đích, cần TELEM_FRAME_SIZE(TELEM_BATCH_SIZE(count)) byte
+  * @param  size: kích thước bộ đệm
+  * @retval Số byte frame, 0 nếu count sai hoặc không đủ chỗ
+  */
+uint16_t TELEM_EncodeBatch(uint32_t firstSeq, uint8_t batchFlags, const TELEM_Record *records, uint8_t count, uint8_t *frame, uint16_t size) {
+    uint8_t p[TELEM_BATCH_SIZE(TELEM_BATCH_MAX)];
+
+    if (count == 0 || count > TELEM_BATCH_MAX) {
+        return 0;
+    }
+    p[0] = TELEM_HEADER(TELEM_TYPE_BATCH);
+    PutU32(&p[1], firstSeq);
+    p[5] = count;
+    p[6] = batchFlags;
+
+    uint8_t *r = &p[7];
+    for (uint8_t i = 0; i < count; i++, r += TELEM_RECORD_SIZE) {
+        PutU32(&r[0], records[i].TimeMs);
+        r[4] = records[i].Flags;
+        PutU16(&r[5], (uint16_t)records[i].TempX10);
+        r[7] = records[i].Humidity;
+        PutU16(&r[8], records[i].GasPpm);
+    }
+    return TELEM_EncodeFrame(p, TELEM_BATCH_SIZE(count), frame, size);
+}
+
+/**
+  * @brief  Tạo frame TELEM_TYPE_TEXT
+  * @param  text: chuỗi, phần quá TELEM_TEXT_MAX byte bị cắt
+  * @param  frame: bộ đệm đích, cần TELEM_FRAME_SIZE(1 + strlen(text)) byte
+  * @param  size: kích thước bộ đệm
+  * @retval Số byte frame, 0 nếu không đủ chỗ
+  */
+uint16_t TELEM_EncodeText(const char *text, uint8_t *frame, uint16_t size) {
+    uint8_t p[TELEM_PAYLOAD_MAX];
+    uint16_t len = (uint16_t)strlen(text);
+
+    if (len > TELEM_TEXT_MAX) {
+        len = TELEM_TEXT_MAX;
+    }
+    p[0] = TELEM_HEADER(TELEM_TYPE_TEXT);
+    memcpy(&p[1], text, len);
+    return TELEM_EncodeFrame(p, len + 1, frame, size);
+}
+
+/**
+  * @brief  Đọc một lệnh từ payload đã tách khỏi frame
+  * @param  payload: payload (kể cả header)
+  * @param  len: số byte
+  * @param  cmd: lệnh đọc được, Seq và Opcode hợp lệ cả khi trả về lỗi
+  *         (trừ khi payload ngắn hơn 3 byte)
+  * @retval TELEM_STATUS_OK, TELEM_STATUS_UNKNOWN hoặc TELEM_STATUS_BAD_ARG
+  */
+uint8_t TELEM_DecodeCommand(const uint8_t *payload, uint16_t len, TELEM_Command *cmd) {
+    memset(cmd, 0, sizeof(*cmd));
+    if (len < 3 || payload[0] != TELEM_HEADER(TELEM_TYPE_COMMAND)) {
+        return TELEM_STATUS_BAD_ARG;
+    }
+    cmd->Seq = payload[1];
+    cmd->Opcode = payload[2];
+
+    switch (cmd->Opcode) {
+    case TELEM_CMD_SET_INTERVAL:
+        if (len != 6) {
+            return TELEM_STATUS_BAD_ARG;
+        }
+        cmd->Target = payload[3];
+        cmd->Value = GetU16(&payload[4]);
+        return TELEM_STATUS_OK;
+
+    case TELEM_CMD_ACK_SAMPLES:
+        if (len != 7 && len != 11) {
+            return TELEM_STATUS_BAD_ARG;
+        }
+        cmd->NextSeq = GetU32(&payload[3]);
+        cmd->ReceivedSeq = (len == 11) ? GetU32(&payload[7]) : cmd->NextSeq;
+        return TELEM_STATUS_OK;
+
+    case TELEM_CMD_CALIBRATE:
+    case TELEM_CMD_GET_STATS:
+        return (len == 3) ? TELEM_STATUS_OK : TELEM_STATUS_BAD_ARG;
+
+    default:
+        return TELEM_STATUS_UNKNOWN;
+    }
+}
+
+/**
+  * @brief  Tạo frame TELEM_TYPE_ACK trả lời một lệnh
+  * @param  cmd: lệnh (lấy Seq và Opcode)
+  * @param  status: TELEM_STATUS_*
+  * @param  frame: bộ đệm đích, cần TELEM_FRAME_SIZE(TELEM_ACK_SIZE) byte
+  * @param  size: kích thước bộ đệm
+  * @retval Số byte frame, 0 nếu không đủ chỗ
+  */
+uint16_t TELEM_EncodeAck(const TELEM_Command *cmd, uint8_t status, uint8_t *frame, uint16_t size) {
+    uint8_t p[TELEM_ACK_SIZE];
+
+    p[0] = TELEM_HEADER(TELEM_TYPE_ACK);
+    p[1] = cmd->Seq;
+    p[2] = cmd->Opcode;
+    p[3] = status;
+    return TELEM_EncodeFrame(p, sizeof(p), frame, size);
+}
+
+/**
+  * @brief  Tạo frame TELEM_TYPE_STATS
+  * @param  seq: Seq của lệnh TELEM_CMD_GET_STATS
+  * @param  stats: thống kê
+  * @param  frame: bộ đệm đích, cần TELEM_FRAME_SIZE(TELEM_STATS_SIZE) byte
+  * @param  size: kích thước bộ đệm
+  * @retval Số byte frame, 0 nếu không đủ chỗ
+  */
+uint16_t TELEM_EncodeStats(uint8_t seq, const TELEM_Stats *stats, uint8_t *frame, uint16_t size) {
+    uint8_t p[TELEM_STATS_SIZE];
+
+    p[0] = TELEM_HEADER(TELEM_TYPE_STATS);
+    p[1] = seq;
+    PutU32(&p[2], stats->UptimeMs);
+    PutU16(&p[6], stats->Dht11IntervalMs);
+    PutU16(&p[8], stats->Mq2IntervalMs);
+    PutU16(&p[10], stats->UartIntervalMs);
+    PutU32(&p[12], stats->Dht11Reads);
+    PutU32(&p[16], stats->Dht11Errors);
+    PutU32(&p[20], stats->TxFrames);
+    PutU32(&p[24], stats->TxDropped);
+    PutU32(&p[28], stats->TxErrors);
+    PutU32(&p[32], stats->RxFrames);
+    PutU32(&p[36], stats->RxErrors);
+    PutU32(&p[40], stats->BootSeq);
+    PutU32(&p[44], stats->SampleReadings);
+    PutU32(&p[48], stats->SampleSuppressed);
+    return TELEM_EncodeFrame(p, sizeof(p), frame, size);
+}
@@ -0,0 +1,128 @@
+/**
+  ******************************************************************************
+  * @file           : uart_rx.c
+  * @brief          : Nhận UART bằng DMA vòng + phát hiện IDLE, tách frame theo 0x00
+  * @created        : Oct 18, 2026
+  * @author         : NguyenHoa
+  * @version        : 1.0.0
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "uart_rx.h"
+#include <string.h>
+
+/* Private function prototypes -----------------------------------------------*/
+static HAL_StatusTypeDef UARTRX_Start(UARTRX_Data *rx);
+static void UARTRX_Consume(UARTRX_Data *rx, uint16_t from, uint16_t to);
+
+/**
+  * @brief  Khởi tạo và bắt đầu nhận
+  * @param  rx: bộ nhận
+  * @param  huart: UART handle, đã init và liên kết DMA RX vòng
+  * @param  handler: hàm nhận từng frame, gọi trong vòng lặp chính
+  * @retval HAL_OK nếu DMA đã chạy
+  */
+HAL_StatusTypeDef UARTRX_Init(UARTRX_Data *rx, UART_HandleTypeDef *huart, UARTRX_FrameHandler handler) {
+    memset(rx, 0, sizeof(*rx));
+    rx->_huart = huart;
+    rx->_handler = handler;
+    HAL_StatusTypeDef status = UARTRX_Start(rx);
+    rx->_discard = 0;   // Đường truyền vừa mở, byte đầu là đầu frame
+    return status;
+}
+
+/**
+  * @brief  Xử lý các byte DMA đã nhận từ lần gọi trước
+  * @note   Gọi trong vòng lặp chính; handler chạy ngay trong hàm này.
+  *         Nếu phần nhận bị dừng vì lỗi thì khởi động lại DMA.
+  * @param  rx: bộ nhận
+  * @retval None
+  */
+void UARTRX_Process(UARTRX_Data *rx) {
+    if (rx->_huart->RxState == HAL_UART_STATE_READY) {
+        // HAL đã dừng DMA sau lỗi, phần đang ghép dở không còn tin được
+        rx->Stats.Restarts++;
+        UARTRX_Start(rx);
+        rx->_discard = 1;   // Byte đầu có thể rơi giữa frame: đợi 0x00 đầu tiên
+        return;
+    }
+
+    const uint16_t pos = rx->_dmaPos;
+    if (pos == rx->_readPos) {
+        return;
+    }
+    if (pos < rx->_readPos) {
+        // DMA đã quay vòng: xử lý đến cuối bộ đệm rồi từ đầu
+        UARTRX_Consume(rx, rx->_readPos, UARTRX_DMA_SIZE);
+        rx->_readPos = 0;
+    }
+    UARTRX_Consume(rx, rx->_readPos, pos);
+    rx->_readPos = (pos == UARTRX_DMA_SIZE) ? 0 : pos;
+}
+
+/**
+  * @brief  Ghi lại vị trí DMA (gọi trong ngắt IDLE, nửa và hết bộ đệm)
+  * @param  rx: bộ nhận
+  * @param  pos: số byte DMA đã ghi tính từ đầu bộ đệm
+  * @retval None
+  */
+void UARTRX_RxEvent(UARTRX_Data *rx, uint16_t pos) {
+    rx->_dmaPos = pos;
+}
+
+/**
+  * @brief  UART báo lỗi (gọi trong ngắt)
+  * @note   Chỉ đếm lỗi đường truyền. Overrun và lỗi DMA làm HAL dừng phần
+  *         nhận, UARTRX_Process sẽ khởi động lại (đếm trong Restarts).
+  * @param  rx: bộ nhận
+  * @retval None
+  */
+void UARTRX_Error(UARTRX_Data *rx) {
+    if (rx->_huart->ErrorCode & (HAL_UART_ERROR_PE | HAL_UART_ERROR_NE | HAL_UART_ERROR_FE | HAL_UART_ERROR_ORE)) {
+        rx->Stats.Errors++;
+    }
+}
+
+/**
+  * @brief  Bắt đầu nhận DMA vòng từ đầu bộ đệm, xóa frame đang ghép dở
+  * @param  rx: bộ nhận
+  * @retval Kết quả HAL_UARTEx_ReceiveToIdle_DMA
+  */
+static HAL_StatusTypeDef UARTRX_Start(UARTRX_Data *rx) {
+    rx->_dmaPos = 0;
+    rx->_readPos = 0;
+    rx->_frameLen = 0;
+    return HAL_UARTEx_ReceiveToIdle_DMA(rx->_huart, rx->_dmaBuffer, UARTRX_DMA_SIZE);
+}
+
+/**
+  * @brief  Ghép các byte [from, to) của bộ đệm DMA thành frame
+  * @param  rx: bộ nhận
+  * @param  from: vị trí đầu
+  * @param  to: vị trí cuối (không kể)
+  * @retval None
+  */
+static void UARTRX_Consume(UARTRX_Data *rx, uint16_t from, uint16_t to) {
+    rx->Stats.Bytes += to - from;
+
+    for (uint16_t i = from; i < to; i++) {
+        const uint8_t b = rx->_dmaBuffer[i];
+
+        if (b == 0x00) {
+            if (!rx->_discard && rx->_frameLen > 0) {
+                rx->Stats.Frames++;
+                rx->_handler(rx->_frame, rx->_frameLen);
+            }
+            rx->_frameLen = 0;
+            rx->_discard = 0;
+        } else if (rx->_discard) {
+            continue;
+        } else if (rx->_frameLen < UARTRX_FRAME_MAX) {
+            rx->_frame[rx->_frameLen++] = b;
+        } else {
+            rx->Stats.Overruns++;
+            rx->_discard = 1;
+        }
+    }
+}
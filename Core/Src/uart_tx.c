@@ -0,0 +1,176 @@
+/**
+  ******************************************************************************
+  * @file           : uart_tx.c
+  * @brief          : Hàng đợi gửi UART không chặn (ring buffer + DMA)
+  * @created        : Oct 18, 2026
+  * @author         : NguyenHoa
+  * @version        : 1.0.0
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "uart_tx.h"
+#include <string.h>
+
+/* Private defines -----------------------------------------------------------*/
+#define UARTTX_MASK (UARTTX_BUFFER_SIZE - 1)
+
+/* Private function prototypes -----------------------------------------------*/
+static void UARTTX_Kick(UARTTX_Data *tx);
+static void UARTTX_DropInFlight(UARTTX_Data *tx);
+
+/**
+  * @brief  Khởi tạo hàng đợi
+  * @param  tx: hàng đợi
+  * @param  huart: UART handle, đã init và liên kết DMA TX
+  * @retval None
+  */
+void UARTTX_Init(UARTTX_Data *tx, UART_HandleTypeDef *huart) {
+    memset(tx, 0, sizeof(*tx));
+    tx->_huart = huart;
+}
+
+/**
+  * @brief  Xếp một frame vào hàng đợi và khởi động DMA nếu đang rảnh
+  * @note   O(1) ngoài memcpy, không bao giờ chờ. Không đủ chỗ thì bỏ cả frame.
+  * @param  tx: hàng đợi
+  * @param  data: các byte cần gửi
+  * @param  len: số byte
+  * @retval UARTTX_OK hoặc UARTTX_FULL
+  */
+UARTTX_StatusTypeDef UARTTX_Write(UARTTX_Data *tx, const uint8_t *data, uint16_t len) {
+    const uint16_t head = tx->_head;
+    const uint16_t used = (uint16_t)(head - tx->_tail);
+
+    if (len == 0) {
+        return UARTTX_OK;
+    }
+    if (len > UARTTX_BUFFER_SIZE - used) {
+        tx->Stats.Dropped++;
+        tx->Stats.DroppedBytes += len;
+        return UARTTX_FULL;
+    }
+
+    // Chép thành hai đoạn nếu frame vắt qua cuối bộ đệm
+    const uint16_t index = head & UARTTX_MASK;
+    const uint16_t first = (len < UARTTX_BUFFER_SIZE - index) ? len : (uint16_t)(UARTTX_BUFFER_SIZE - index);
+    memcpy(&tx->_buffer[index], data, first);
+    memcpy(tx->_buffer, data + first, len - first);
+
+    // Dữ liệu phải nằm trong bộ đệm trước khi ngắt thấy _head mới
+    __DMB();
+    tx->_head = (uint16_t)(head + len);
+
+    tx->Stats.Frames++;
+    tx->Stats.Bytes += len;
+    if (used + len > tx->Stats.HighWater) {
+        tx->Stats.HighWater = used + len;
+    }
+
+    __disable_irq();
+    UARTTX_Kick(tx);
+    __enable_irq();
+    return UARTTX_OK;
+}
+
+/**
+  * @brief  Số byte đang chờ gửi, kể cả khối DMA đang gửi
+  * @param  tx: hàng đợi
+  * @retval Số byte
+  */
+uint16_t UARTTX_Pending(const UARTTX_Data *tx) {
+    return (uint16_t)(tx->_head - tx->_tail);
+}
+
+/**
+  * @brief  Gọi trong vòng lặp chính: thử lại khi DMA chưa khởi động được,
+  *         bỏ khối đang gửi nếu quá thời gian (đường truyền bị treo)
+  * @param  tx: hàng đợi
+  * @param  currentTime: thời gian hiện tại từ HAL_GetTick()
+  * @retval None
+  */
+void UARTTX_Process(UARTTX_Data *tx, uint32_t currentTime) {
+    const uint16_t inFlight = tx->_inFlight;
+
+    if (inFlight == 0) {
+        if (tx->_head != tx->_tail) {
+            __disable_irq();
+            UARTTX_Kick(tx);
+            __enable_irq();
+        }
+        return;
+    }
+
+    // 10 bit mỗi byte (start + 8 data + stop)
+    const uint32_t timeout = (uint32_t)inFlight * 10000u / tx->_huart->Init.BaudRate + UARTTX_TIMEOUT_MARGIN;
+    if (currentTime - tx->_startTick <= timeout) {
+        return;
+    }
+
+    // Sau khi abort xong, TxCplt của khối này không thể chạy nữa
+    HAL_UART_AbortTransmit(tx->_huart);
+    __disable_irq();
+    if (tx->_inFlight != 0) {
+        UARTTX_DropInFlight(tx);
+        UARTTX_Kick(tx);
+    }
+    __enable_irq();
+}
+
+/**
+  * @brief  Khối DMA đã gửi xong, gửi tiếp phần còn lại (gọi trong ngắt)
+  * @param  tx: hàng đợi
+  * @retval None
+  */
+void UARTTX_TxCplt(UARTTX_Data *tx) {
+    tx->Stats.SentBytes += tx->_inFlight;
+    tx->_tail = (uint16_t)(tx->_tail + tx->_inFlight);
+    tx->_inFlight = 0;
+    UARTTX_Kick(tx);
+}
+
+/**
+  * @brief  UART báo lỗi (gọi trong ngắt)
+  * @note   Chỉ xử lý khi HAL đã dừng phần TX (lỗi DMA): bỏ khối đang gửi
+  *         và gửi tiếp. Lỗi phía RX không ảnh hưởng hàng đợi.
+  * @param  tx: hàng đợi
+  * @retval None
+  */
+void UARTTX_Error(UARTTX_Data *tx) {
+    if (tx->_inFlight != 0 && tx->_huart->gState == HAL_UART_STATE_READY) {
+        UARTTX_DropInFlight(tx);
+        UARTTX_Kick(tx);
+    }
+}
+
+/**
+  * @brief  Khởi động DMA cho phần liền mạch dài nhất ở đầu hàng đợi
+  * @note   Gọi trong ngắt hoặc khi đã tắt ngắt
+  * @param  tx: hàng đợi
+  * @retval None
+  */
+static void UARTTX_Kick(UARTTX_Data *tx) {
+    const uint16_t used = (uint16_t)(tx->_head - tx->_tail);
+
+    if (tx->_inFlight != 0 || used == 0) {
+        return;
+    }
+
+    const uint16_t index = tx->_tail & UARTTX_MASK;
+    const uint16_t chunk = (used < UARTTX_BUFFER_SIZE - index) ? used : (uint16_t)(UARTTX_BUFFER_SIZE - index);
+    if (HAL_UART_Transmit_DMA(tx->_huart, &tx->_buffer[index], chunk) == HAL_OK) {
+        tx->_inFlight = chunk;
+        tx->_startTick = HAL_GetTick();
+    }
+}
+
+/**
+  * @brief  Bỏ khối đang gửi dở và đếm lỗi
+  * @param  tx: hàng đợi
+  * @retval None
+  */
+static void UARTTX_DropInFlight(UARTTX_Data *tx) {
+    tx->Stats.Errors++;
+    tx->_tail = (uint16_t)(tx->_tail + tx->_inFlight);
+    tx->_inFlight = 0;
+}
@@ -5,43 +5,76 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../Core/Src/dashboard.c \
 ../Core/Src/dht11.c \
+../Core/Src/flash_log.c \
+../Core/Src/fmt.c \
 ../Core/Src/main.c \
 ../Core/Src/mq2.c \
+../Core/Src/sample_log.c \
 ../Core/Src/ssd1306.c \
 ../Core/Src/ssd1306_fonts.c \
+../Core/Src/ssd1306_fonts_dash.c \
+../Core/Src/ssd1306_fonts_paged.c \
+../Core/Src/ssd1306_host.c \
 ../Core/Src/ssd1306_tests.c \
+../Core/Src/ssd1306_widgets.c \
 ../Core/Src/stm32f4xx_hal_msp.c \
 ../Core/Src/stm32f4xx_it.c \
 ../Core/Src/syscalls.c \
 ../Core/Src/sysmem.c \
-../Core/Src/system_stm32f4xx.c 
+../Core/Src/system_stm32f4xx.c \
+../Core/Src/telemetry.c \
+../Core/Src/uart_rx.c \
+../Core/Src/uart_tx.c 
 
 OBJS += \
+./Core/Src/dashboard.o \
 ./Core/Src/dht11.o \
+./Core/Src/flash_log.o \
+./Core/Src/fmt.o \
 ./Core/Src/main.o \
 ./Core/Src/mq2.o \
+./Core/Src/sample_log.o \
 ./Core/Src/ssd1306.o \
 ./Core/Src/ssd1306_fonts.o \
+./Core/Src/ssd1306_fonts_dash.o \
+./Core/Src/ssd1306_fonts_paged.o \
+./Core/Src/ssd1306_host.o \
 ./Core/Src/ssd1306_tests.o \
+./Core/Src/ssd1306_widgets.o \
 ./Core/Src/stm32f4xx_hal_msp.o \
 ./Core/Src/stm32f4xx_it.o \
 ./Core/Src/syscalls.o \
 ./Core/Src/sysmem.o \
-./Core/Src/system_stm32f4xx.o 
+./Core/Src/system_stm32f4xx.o \
+./Core/Src/telemetry.o \
+./Core/Src/uart_rx.o \
+./Core/Src/uart_tx.o 
 
 C_DEPS += \
+./Core/Src/dashboard.d \
 ./Core/Src/dht11.d \
+./Core/Src/flash_log.d \
+./Core/Src/fmt.d \
 ./Core/Src/main.d \
 ./Core/Src/mq2.d \
+./Core/Src/sample_log.d \
 ./Core/Src/ssd1306.d \
 ./Core/Src/ssd1306_fonts.d \
+./Core/Src/ssd1306_fonts_dash.d \
+./Core/Src/ssd1306_fonts_paged.d \
+./Core/Src/ssd1306_host.d \
 ./Core/Src/ssd1306_tests.d \
+./Core/Src/ssd1306_widgets.d \
 ./Core/Src/stm32f4xx_hal_msp.d \
 ./Core/Src/stm32f4xx_it.d \
 ./Core/Src/syscalls.d \
 ./Core/Src/sysmem.d \
-./Core/Src/system_stm32f4xx.d 
+./Core/Src/system_stm32f4xx.d \
+./Core/Src/telemetry.d \
+./Core/Src/uart_rx.d \
+./Core/Src/uart_tx.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -51,7 +84,7 @@ Core/Src/%.o Core/Src/%.su Core/Src/%.cyclo: ../Core/Src/%.c Core/Src/subdir.mk
 clean: clean-Core-2f-Src
 
 clean-Core-2f-Src:
-	-$(RM) ./Core/Src/dht11.cyclo ./Core/Src/dht11.d ./Core/Src/dht11.o ./Core/Src/dht11.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/mq2.cyclo ./Core/Src/mq2.d ./Core/Src/mq2.o ./Core/Src/mq2.su ./Core/Src/ssd1306.cyclo ./Core/Src/ssd1306.d ./Core/Src/ssd1306.o ./Core/Src/ssd1306.su ./Core/Src/ssd1306_fonts.cyclo ./Core/Src/ssd1306_fonts.d ./Core/Src/ssd1306_fonts.o ./Core/Src/ssd1306_fonts.su ./Core/Src/ssd1306_tests.cyclo ./Core/Src/ssd1306_tests.d ./Core/Src/ssd1306_tests.o ./Core/Src/ssd1306_tests.su ./Core/Src/stm32f4xx_hal_msp.cyclo ./Core/Src/stm32f4xx_hal_msp.d ./Core/Src/stm32f4xx_hal_msp.o ./Core/Src/stm32f4xx_hal_msp.su ./Core/Src/stm32f4xx_it.cyclo ./Core/Src/stm32f4xx_it.d ./Core/Src/stm32f4xx_it.o ./Core/Src/stm32f4xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f4xx.cyclo ./Core/Src/system_stm32f4xx.d ./Core/Src/system_stm32f4xx.o ./Core/Src/system_stm32f4xx.su
+	-$(RM) ./Core/Src/dashboard.cyclo ./Core/Src/dashboard.d ./Core/Src/dashboard.o ./Core/Src/dashboard.su ./Core/Src/dht11.cyclo ./Core/Src/dht11.d ./Core/Src/dht11.o ./Core/Src/dht11.su ./Core/Src/flash_log.cyclo ./Core/Src/flash_log.d ./Core/Src/flash_log.o ./Core/Src/flash_log.su ./Core/Src/fmt.cyclo ./Core/Src/fmt.d ./Core/Src/fmt.o ./Core/Src/fmt.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/mq2.cyclo ./Core/Src/mq2.d ./Core/Src/mq2.o ./Core/Src/mq2.su ./Core/Src/sample_log.cyclo ./Core/Src/sample_log.d ./Core/Src/sample_log.o ./Core/Src/sample_log.su ./Core/Src/ssd1306.cyclo ./Core/Src/ssd1306.d ./Core/Src/ssd1306.o ./Core/Src/ssd1306.su ./Core/Src/ssd1306_fonts.cyclo ./Core/Src/ssd1306_fonts.d ./Core/Src/ssd1306_fonts.o ./Core/Src/ssd1306_fonts.su ./Core/Src/ssd1306_fonts_dash.cyclo ./Core/Src/ssd1306_fonts_dash.d ./Core/Src/ssd1306_fonts_dash.o ./Core/Src/ssd1306_fonts_dash.su ./Core/Src/ssd1306_fonts_paged.cyclo ./Core/Src/ssd1306_fonts_paged.d ./Core/Src/ssd1306_fonts_paged.o ./Core/Src/ssd1306_fonts_paged.su ./Core/Src/ssd1306_host.cyclo ./Core/Src/ssd1306_host.d ./Core/Src/ssd1306_host.o ./Core/Src/ssd1306_host.su ./Core/Src/ssd1306_tests.cyclo ./Core/Src/ssd1306_tests.d ./Core/Src/ssd1306_tests.o ./Core/Src/ssd1306_tests.su ./Core/Src/ssd1306_widgets.cyclo ./Core/Src/ssd1306_widgets.d ./Core/Src/ssd1306_widgets.o ./Core/Src/ssd1306_widgets.su ./Core/Src/stm32f4xx_hal_msp.cyclo ./Core/Src/stm32f4xx_hal_msp.d ./Core/Src/stm32f4xx_hal_msp.o ./Core/Src/stm32f4xx_hal_msp.su ./Core/Src/stm32f4xx_it.cyclo ./Core/Src/stm32f4xx_it.d ./Core/Src/stm32f4xx_it.o ./Core/Src/stm32f4xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f4xx.cyclo ./Core/Src/system_stm32f4xx.d ./Core/Src/system_stm32f4xx.o ./Core/Src/system_stm32f4xx.su ./Core/Src/telemetry.cyclo ./Core/Src/telemetry.d ./Core/Src/telemetry.o ./Core/Src/telemetry.su ./Core/Src/uart_rx.cyclo ./Core/Src/uart_rx.d ./Core/Src/uart_rx.o ./Core/Src/uart_rx.su ./Core/Src/uart_tx.cyclo ./Core/Src/uart_tx.d ./Core/Src/uart_tx.o ./Core/Src/uart_tx.su
 
 .PHONY: clean-Core-2f-Src
 
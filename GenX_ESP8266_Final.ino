@@ -1,7 +1,8 @@
 #include <SoftwareSerial.h>
 #include <ESP8266WiFi.h>
-#include <FirebaseESP8266.h>
-#include <ArduinoJson.h>
+#include <WiFiClientSecure.h>
+#include <time.h>
+#include <sys/time.h>
 
 // Cấu hình WiFi
 #define WIFI_SSID "Iphone Harley"
@@ -11,127 +12,1194 @@
 #define FIREBASE_HOST "dht11-51c19-default-rtdb.asia-southeast1.firebasedatabase.app" // Không bao gồm https:// và / ở cuối
 #define FIREBASE_SECRET "ZwZqIXo3HqNmk4VaUTqbganscWPyDeJomTFmJsx0" // Sử dụng secret key thay vì auth token
 
+// Đẩy dữ liệu lên Firebase Realtime Database qua REST: mỗi request là một
+// PATCH gom nhiều bản ghi, kết nối TLS giữ lại cho request sau. Vòng lặp
+// chính không chờ phản hồi nên vẫn nhận UART trong lúc request đang chạy.
+// UPLOAD_TLS 0: HTTP thường đến tools/upload_server.py để thử trên máy tính.
+#define UPLOAD_TLS 1
+#if UPLOAD_TLS
+#define UPLOAD_HOST FIREBASE_HOST
+#define UPLOAD_PORT 443
+#else
+#define UPLOAD_HOST "192.168.1.100"  // Máy tính chạy tools/upload_server.py
+#define UPLOAD_PORT 8080
+#endif
+#define UPLOAD_QUEUE 128      // Điểm chờ đẩy lên, hơn số bản ghi STM32 gửi khi chưa có ACK (64)
+#define UPLOAD_BATCH 32       // Điểm tối đa trong một request
+#define UPLOAD_DELAY 1000     // ms gom điểm cho lô chưa đầy; cộng thời gian request phải dưới 5 s STM32 chờ ACK
+#define UPLOAD_TIMEOUT 10000  // ms chờ phản hồi, quá thì đóng kết nối
+#define UPLOAD_RETRY 3000     // ms chờ trước khi gửi lại sau request lỗi
+#define UPLOAD_BODY_MAX 2048  // Byte JSON mỗi request
+#define POINT_JSON_MAX 192    // Byte JSON dài nhất của một điểm
+
+// Lịch sử theo thời gian, mỗi thiết bị một nhánh /devices/<DEVICE_ID>:
+//   latest                 giá trị mới nhất {t, temp, humid, gas}
+//   raw/<bucket>/<t>       điểm thô, chỉ khi giá trị đổi, giữ HISTORY_RAW_KEEP giây
+//   avg/<t>                trung bình từ lần đọc t đến hết bucket {temp, humid, gas, n};
+//                          bucket nhiều hơn HISTORY_AVG_HOLD lần đọc thì tách thêm điểm
+//   unsynced/<Seq>         bản ghi không suy ra được giờ thực, t là ms của STM32
+// t và bucket là giây epoch UTC (bucket = t làm tròn xuống HISTORY_AVG_STEP) nên
+// khóa sắp theo thời gian, đọc một khoảng bằng orderBy="$key"&startAt="<giây>".
+// Lượng dữ liệu theo số lần giá trị đổi, không theo chu kỳ đọc cảm biến.
+#define DEVICE_ID ""              // Rỗng: "esp-<chip ID>"
+#define HISTORY_RAW_STEP 1        // s, hai điểm thô cách nhau ít nhất
+#define HISTORY_RAW_KEEP 3600     // s giữ điểm thô, 0: không ghi điểm thô
+#define HISTORY_AVG_STEP 60       // s mỗi điểm trung bình, chia hết HISTORY_RAW_KEEP
+#define HISTORY_RAW_DELETES 4     // Bucket thô quá hạn xóa tối đa mỗi điểm trung bình
+#define HISTORY_AVG_HOLD 32       // Lần đọc tối đa chờ trong điểm trung bình chưa đóng, dưới 64 bản ghi STM32 gửi khi chưa có ACK
+#define HISTORY_AVG_GRACE 10      // s sau khi bucket hết giờ thì đóng điểm trung bình dù chưa có bản ghi mới
+#define CLOCK_SESSIONS 4          // Số lần khởi động STM32 nhớ giờ
+#define CLOCK_SYNC_INTERVAL 60000 // ms giữa hai lần hỏi uptime STM32 để đối chiếu giờ
+
 // Cấu hình UART với STM32
-#define RX D2  // GPIO4 – từ STM32 TX
-#define TX D1  // GPIO5 – về STM32 RX
+// LINK_HW_UART 0: SoftwareSerial trên D2/D1, tối đa 115200 baud, mất byte
+//   khi WiFi/Firebase giữ CPU lâu
+// LINK_HW_UART 1: UART0 phần cứng đổi chân sang D7 (GPIO13, từ STM32 TX) /
+//   D8 (GPIO15, về STM32 RX), FIFO phần cứng + bộ đệm RX lớn, chạy 500000
+//   baud. Log chuyển sang UART1 (D4, chỉ có TX): không gõ lệnh được.
+// UART_LINK_BAUD trong Core/Src/main.c của STM32 phải bằng LINK_BAUD.
+#define LINK_HW_UART 0
+#if LINK_HW_UART
+#define LINK_BAUD 500000     // STM32 APB1 = 8 MHz: 500000 chia hết, 460800 lệch 2%
+#else
+#define LINK_BAUD 115200
+#endif
+#define LINK_RX_BUFFER 4096  // Byte, đủ cho ~20 frame BATCH đầy trong lúc chờ Firebase
+
+#define RX D2  // GPIO4 – từ STM32 TX (SoftwareSerial)
+#define TX D1  // GPIO5 – về STM32 RX (SoftwareSerial)
+
+#if LINK_HW_UART
+HardwareSerial& linkSerial = Serial;
+HardwareSerial& logSerial = Serial1;
+#else
+SoftwareSerial linkSerial(RX, TX);
+HardwareSerial& logSerial = Serial;
+#endif
+
+// Frame nhị phân với STM32 (Core/Inc/telemetry.h): COBS(payload | CRC16) 0x00
+#define TELEM_PROTOCOL_VERSION 2
+#define TELEM_TYPE_SAMPLE 0x1
+#define TELEM_TYPE_COMMAND 0x2
+#define TELEM_TYPE_ACK 0x3
+#define TELEM_TYPE_STATS 0x4
+#define TELEM_TYPE_BATCH 0x5
+#define TELEM_TYPE_TEXT 0xF
+#define TELEM_CMD_SET_INTERVAL 0x01
+#define TELEM_CMD_CALIBRATE 0x02
+#define TELEM_CMD_GET_STATS 0x03
+#define TELEM_CMD_ACK_SAMPLES 0x04
+#define TELEM_INTERVAL_DHT11 0
+#define TELEM_INTERVAL_MQ2 1
+#define TELEM_INTERVAL_UART 2
+#define TELEM_ACK_SIZE 4
+#define TELEM_COMMAND_MAX 11    // ACK_SAMPLES có ReceivedSeq là lệnh dài nhất
+#define TELEM_STATS_SIZE 52
+#define TELEM_FLAG_DHT11_OK 0x01
+#define TELEM_FLAG_MQ2_OK 0x02
+#define TELEM_FLAG_MQ2_CAL 0x04
+#define TELEM_FLAG_DHT11_NEW 0x40
+#define TELEM_FLAG_MQ2_NEW 0x80
+#define TELEM_BATCH_OLDEST 0x01
+#define TELEM_BATCH_LIVE 0x02
+#define TELEM_RECORD_SIZE 10
+#define TELEM_BATCH_MAX 16
+#define TELEM_PAYLOAD_MAX (7 + TELEM_BATCH_MAX * TELEM_RECORD_SIZE)
+#define TELEM_FRAME_MAX (TELEM_PAYLOAD_MAX + 2 + 1)   // Frame lớn nhất, không kể 0x00
+
+// Bộ tách frame tăng dần: giải COBS và tính CRC ngay khi từng byte đến,
+// không chép lại frame, không dùng String hay cấp phát heap
+struct FrameParser {
+  uint8_t payload[TELEM_PAYLOAD_MAX + 2];  // Payload + CRC16 đã giải COBS
+  size_t len;
+  uint8_t remaining;   // Byte dữ liệu còn lại của khối COBS, 0: byte kế tiếp là mã khối
+  bool zeroPending;    // Khối trước ngắn hơn 254 byte: có 0x00 nếu còn khối sau
+  bool started;        // Đã nhận byte nào của frame này
+  bool bad;            // Frame hỏng hoặc quá dài, bỏ đến 0x00
+  uint16_t crc;        // CRC16 của payload[0 .. len - 3]
+};
+FrameParser parser;
+
+// Thời gian tách frame (không kể xử lý frame) và heap, xem bằng lệnh "stats"
+uint32_t parseBytes = 0;
+uint32_t parseUs = 0;
+uint32_t parseMaxUs = 0;   // Lâu nhất cho một lần đọc hết byte đang chờ
+uint32_t heapMin = UINT32_MAX;
 
-SoftwareSerial mySerial(RX, TX);
-String inputBuffer = "";
+// Lỗi đường truyền UART với STM32
+uint32_t linkOverruns = 0;  // Bộ đệm RX tràn, mất byte
+uint32_t linkRxErrors = 0;  // Lỗi khung/parity (chỉ UART phần cứng)
 
-// Khởi tạo Firebase
-FirebaseData firebaseData;
-FirebaseAuth auth;
-FirebaseConfig config;
-FirebaseJson json;
+// Thống kê đường truyền
+uint32_t framesOk = 0;
+uint32_t framesBad = 0;
+uint32_t framesBadVersion = 0;  // Đúng CRC nhưng khác TELEM_PROTOCOL_VERSION
+uint32_t versionLogTime = 0;
+uint32_t samplesLost = 0;
+bool haveSeq = false;
+uint32_t nextSeq = 0;      // Bản ghi kế tiếp chờ nhận, các bản ghi trước đã vào hàng đợi hoặc đã đẩy lên
+
+// Lệnh gửi STM32, gõ trên Serial Monitor: "dht 5000", "mq2 1000", "uart 2000", "cal", "stats"
+uint8_t cmdSeq = 0;
+char consoleLine[32];
+size_t consoleLen = 0;
+
+// Giờ thực của bản ghi: NTP cho giờ của ESP, frame STATS cho uptime và BootSeq
+// của STM32. TimeMs của bản ghi có Seq >= BootSeq tính từ lúc STM32 khởi động.
+struct ClockSession {
+  uint32_t bootSeq;   // Bản ghi đầu tiên của lần chạy này
+  int64_t epochMs;    // Giờ thực (ms UTC) lúc STM32 khởi động
+};
+ClockSession sessions[CLOCK_SESSIONS];  // Tăng dần theo bootSeq
+uint8_t sessionCount = 0;
+bool clockStale = true;      // Phải hỏi uptime STM32 trước khi nhận bản ghi mới
+uint32_t clockSyncTime = 0;  // millis() lúc gửi GET_STATS gần nhất
+bool statsPrint = false;     // In frame STATS kế tiếp (lệnh "stats")
+bool haveLastRecord = false;
+uint32_t lastRecordSeq = 0;  // Bản ghi vừa đưa vào lịch sử, để phát hiện STM32 khởi động lại
+uint32_t lastRecordTime = 0;
+
+// Giá trị của một điểm lịch sử
+#define HISTORY_DHT 0x01  // Có temp, humid
+#define HISTORY_GAS 0x02  // Có gas
+struct HistoryValues {
+  int16_t tempX10;
+  uint16_t humidX10;
+  uint16_t gas;
+  uint8_t fields;     // HISTORY_DHT | HISTORY_GAS
+};
+HistoryValues current = {};   // Giá trị mới nhất đã biết
+HistoryValues lastRaw = {};   // Giá trị của điểm thô gần nhất
+uint32_t lastRawTime = 0;
+uint32_t avgBucket = 0;       // Bucket của điểm trung bình đang cộng dồn
+uint32_t avgFirstSeq = 0;     // Bản ghi đầu tiên trong điểm trung bình đang cộng dồn
+uint32_t avgFirstTime = 0;    // Giây epoch của bản ghi đó, khóa của điểm
+uint16_t avgRecords = 0;      // Số bản ghi đang cộng dồn, chưa xác nhận được
+bool historyLive = false;     // Frame gần nhất là dữ liệu mới, không phải gửi bù
+int32_t avgTempSum = 0;
+uint32_t avgHumidSum = 0;
+uint32_t avgGasSum = 0;
+uint16_t avgDhtCount = 0;
+uint16_t avgGasCount = 0;
+uint32_t rawDeleteFrom = 0;   // Bucket thô quá hạn kế tiếp cần xóa
+bool latestPending = false;   // "latest" chưa đẩy lên
+bool latestSending = false;
+HistoryValues latest = {};
+uint32_t latestTime = 0;
+char deviceId[24];
+
+// Hàng đợi điểm chờ đẩy lên Firebase. Chỉ xác nhận (ACK_SAMPLES) bản ghi có
+// điểm đã đẩy xong nên khi chưa gửi được, STM32 vẫn giữ bản ghi trong flash.
+enum PointKind : uint8_t { POINT_RAW, POINT_AVG, POINT_UNSYNCED };
+struct HistoryPoint {
+  uint32_t seq;       // Bản ghi tạo ra điểm này, bản ghi đầu tiên với điểm trung bình
+  uint32_t time;      // Giây epoch; ms của STM32 với POINT_UNSYNCED
+  HistoryValues v;
+  uint16_t count;     // Số lần đọc trong điểm trung bình
+  uint8_t kind;       // PointKind
+  uint8_t deletes;    // Điểm trung bình: số bucket thô quá hạn xóa từ deleteFrom
+  uint32_t deleteFrom;
+};
+HistoryPoint uploadQueue[UPLOAD_QUEUE];
+uint16_t queueHead = 0;      // Ô ghi kế tiếp
+uint16_t queueCount = 0;
+uint16_t queueSending = 0;   // Số điểm đầu hàng đợi nằm trong request đang chờ phản hồi
+uint16_t queuePeak = 0;
+uint32_t pendingSince = 0;   // millis() lúc có dữ liệu đầu tiên chờ đẩy
+
+// Request đang chạy, phản hồi đọc dần trong loop()
+enum UploadState { UPLOAD_IDLE, UPLOAD_STATUS, UPLOAD_HEADERS, UPLOAD_BODY };
+#if UPLOAD_TLS
+BearSSL::WiFiClientSecure uploadClient;
+BearSSL::Session uploadSession;  // Kết nối lại thì dùng lại phiên TLS, bắt tay nhanh hơn
+#else
+WiFiClient uploadClient;
+#endif
+UploadState uploadState = UPLOAD_IDLE;
+char uploadBody[UPLOAD_BODY_MAX];
+char respLine[96];           // Dòng header đang đọc, hoặc đầu body để in khi lỗi
+size_t respLen = 0;
+int respStatus = 0;
+long respRemaining = -1;     // Byte body còn lại, -1 nếu không có Content-Length
+bool respClose = false;      // Server đóng kết nối sau phản hồi này
+bool uploadReused = false;   // Request gửi trên kết nối của request trước
+uint32_t uploadStart = 0;
+uint32_t uploadFailTime = 0;
+bool uploadFailed = false;
+bool wifiConnected = false;
+
+// Thống kê đẩy dữ liệu, xem bằng lệnh "stats"
+uint32_t uploadRequests = 0;
+uint32_t uploadPoints = 0;
+uint32_t uploadErrors = 0;
+uint32_t uploadDropped = 0;  // Điểm bỏ vì hàng đợi đầy hoặc STM32 đếm lại Seq
+uint32_t historyRecords = 0; // Bản ghi đã đưa vào lịch sử
+uint32_t historyRaw = 0;     // Điểm thô, trung bình, chưa có giờ đã tạo
+uint32_t historyAvg = 0;
+uint32_t historyUnsynced = 0;
+uint32_t uploadConnects = 0;
+uint32_t uploadMaxMs = 0;
 
 // Biến lưu giá trị cảm biến
 float tempValue = 0.0;
 float humidValue = 0.0;
 float gasValue = 0.0;
 
+// CRC-16/CCITT-FALSE, giống TELEM_Crc16 bên STM32
+uint16_t crc16Update(uint16_t crc, uint8_t b) {
+  crc ^= (uint16_t)b << 8;
+  for (uint8_t i = 0; i < 8; i++) {
+    crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+  }
+  return crc;
+}
+
+uint16_t telemCrc16(const uint8_t* data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc = crc16Update(crc, *data++);
+  }
+  return crc;
+}
+
+// Mã hóa COBS, dst cần len + len / 254 + 1 byte. Trả về số byte (không có 0x00 cuối)
+size_t cobsEncode(const uint8_t* src, size_t len, uint8_t* dst) {
+  size_t codePos = 0, out = 1;
+  uint8_t code = 1;
+  for (size_t i = 0; i < len; i++) {
+    if (src[i] == 0) {
+      dst[codePos] = code;
+      codePos = out++;
+      code = 1;
+      continue;
+    }
+    dst[out++] = src[i];
+    if (++code == 0xFF) {
+      dst[codePos] = code;
+      codePos = out++;
+      code = 1;
+    }
+  }
+  dst[codePos] = code;
+  return out;
+}
+
+// Gửi một frame về STM32: payload + CRC16, mã hóa COBS, kết thúc bằng 0x00
+void telemSendFrame(const uint8_t* payload, size_t len) {
+  uint8_t raw[TELEM_PAYLOAD_MAX + 2];
+  uint8_t frame[TELEM_FRAME_MAX + 1];
+  if (len == 0 || len > TELEM_PAYLOAD_MAX) {
+    return;
+  }
+  memcpy(raw, payload, len);
+  uint16_t crc = telemCrc16(payload, len);
+  raw[len] = crc & 0xFF;
+  raw[len + 1] = crc >> 8;
+  size_t n = cobsEncode(raw, len + 2, frame);
+  frame[n++] = 0x00;
+  linkSerial.write(frame, n);
+}
+
+uint16_t getU16(const uint8_t* p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint32_t getU32(const uint8_t* p) {
+  return (uint32_t)getU16(p) | ((uint32_t)getU16(p + 2) << 16);
+}
+
+void parserReset() {
+  parser.len = 0;
+  parser.remaining = 0;
+  parser.zeroPending = false;
+  parser.started = false;
+  parser.bad = false;
+  parser.crc = 0xFFFF;
+}
+
+void parserPut(uint8_t b) {
+  if (parser.len >= sizeof(parser.payload)) {
+    parser.bad = true;
+    return;
+  }
+  // Hai byte cuối có thể là CRC nên CRC chậm hai byte
+  if (parser.len >= 2) {
+    parser.crc = crc16Update(parser.crc, parser.payload[parser.len - 2]);
+  }
+  parser.payload[parser.len++] = b;
+}
+
+// Đưa một byte vào bộ tách. Trả về số byte payload (không kể CRC) khi b kết
+// thúc một frame đúng, -1 khi kết thúc một frame hỏng, 0 nếu chưa hết frame.
+// Payload nằm trong parser.payload đến byte kế tiếp.
+int parserFeed(uint8_t b) {
+  if (b == 0x00) {
+    bool ok = !parser.bad && parser.remaining == 0 && parser.len >= 3 &&
+              parser.crc == getU16(&parser.payload[parser.len - 2]);
+    int result = ok ? (int)parser.len - 2 : (parser.started ? -1 : 0);
+    parserReset();
+    return result;
+  }
+  parser.started = true;
+  if (parser.bad) {
+    return 0;
+  }
+  if (parser.remaining == 0) {
+    // Byte mã khối: khối trước kết thúc bằng 0x00 nếu ngắn hơn 254 byte
+    if (parser.zeroPending) {
+      parserPut(0x00);
+    }
+    parser.remaining = b - 1;
+    parser.zeroPending = (b != 0xFF);
+  } else {
+    parserPut(b);
+    parser.remaining--;
+  }
+  return 0;
+}
+
+// Gửi lệnh TELEM_TYPE_COMMAND, args là phần sau opcode (có thể rỗng)
+void sendCommand(uint8_t opcode, const uint8_t* args, size_t argLen) {
+  uint8_t payload[TELEM_COMMAND_MAX];
+  if (3 + argLen > sizeof(payload)) {
+    return;
+  }
+  payload[0] = (TELEM_PROTOCOL_VERSION << 4) | TELEM_TYPE_COMMAND;
+  payload[1] = ++cmdSeq;
+  payload[2] = opcode;
+  memcpy(&payload[3], args, argLen);
+  telemSendFrame(payload, 3 + argLen);
+}
+
+void sendSetInterval(uint8_t target, uint16_t ms) {
+  uint8_t args[3] = { target, (uint8_t)(ms & 0xFF), (uint8_t)(ms >> 8) };
+  sendCommand(TELEM_CMD_SET_INTERVAL, args, sizeof(args));
+}
+
+// Một dòng lệnh từ Serial Monitor
+void handleConsoleLine(const char* line) {
+  char name[8];
+  unsigned long ms = 0;
+  int n = sscanf(line, "%7s %lu", name, &ms);
+  if (n < 1) {
+    return;
+  }
+  if (n == 2 && ms <= 0xFFFF && strcmp(name, "dht") == 0) {
+    sendSetInterval(TELEM_INTERVAL_DHT11, ms);
+  } else if (n == 2 && ms <= 0xFFFF && strcmp(name, "mq2") == 0) {
+    sendSetInterval(TELEM_INTERVAL_MQ2, ms);
+  } else if (n == 2 && ms <= 0xFFFF && strcmp(name, "uart") == 0) {
+    sendSetInterval(TELEM_INTERVAL_UART, ms);
+  } else if (strcmp(name, "cal") == 0) {
+    sendCommand(TELEM_CMD_CALIBRATE, NULL, 0);
+  } else if (strcmp(name, "stats") == 0) {
+    printEspStats();
+    statsPrint = true;
+    sendCommand(TELEM_CMD_GET_STATS, NULL, 0);
+  } else {
+    logSerial.println("❓ Lệnh: dht <ms> | mq2 <ms> | uart <ms> | cal | stats");
+    return;
+  }
+  logSerial.printf("📤 Lệnh #%u: %s\n", cmdSeq, line);
+}
+
 void setup() {
-  Serial.begin(115200);
-  mySerial.begin(115200);
+  logSerial.begin(115200);
+  parserReset();
+#if LINK_HW_UART
+  linkSerial.setRxBufferSize(LINK_RX_BUFFER);
+  linkSerial.begin(LINK_BAUD);
+  linkSerial.swap();  // UART0 sang GPIO13/GPIO15, chân USB không còn nối STM32
+#else
+  linkSerial.begin(LINK_BAUD, SWSERIAL_8N1, RX, TX, false, 1024);  // Đủ chứa 4 frame BATCH đầy (gửi bù) trong lúc chờ Firebase
+#endif
   
   // Kết nối WiFi
   WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-  Serial.print("🌐 Đang kết nối WiFi");
+  logSerial.print("🌐 Đang kết nối WiFi");
   
   while (WiFi.status() != WL_CONNECTED) {
-    Serial.print(".");
+    logSerial.print(".");
     delay(300);
   }
   
-  Serial.println();
-  Serial.print("📶 Đã kết nối WiFi, IP: ");
-  Serial.println(WiFi.localIP());
-  
-  // Cấu hình Firebase với legacy secret
-  config.host = FIREBASE_HOST;
-  config.signer.tokens.legacy_token = FIREBASE_SECRET;
-  
-  // Kết nối Firebase
-  Firebase.begin(&config, &auth);
-  Firebase.reconnectWiFi(true);
+  logSerial.println();
+  logSerial.print("📶 Đã kết nối WiFi, IP: ");
+  logSerial.println(WiFi.localIP());
   
-  Serial.println("🔥 Đã kết nối Firebase");
-  Serial.println("🔌 ESP sẵn sàng nhận dữ liệu...");
+  WiFi.setAutoReconnect(true);
+  wifiConnected = true;
+
+  // Giờ thực UTC cho khóa lịch sử, đồng bộ nền
+  configTime(0, 0, "pool.ntp.org", "time.google.com");
+  if (strlen(DEVICE_ID) > 0) {
+    snprintf(deviceId, sizeof(deviceId), "%s", DEVICE_ID);
+  } else {
+    snprintf(deviceId, sizeof(deviceId), "esp-%06x", ESP.getChipId());
+  }
+
+  // Kết nối đến server mở khi có dữ liệu đầu tiên và giữ cho các request sau
+#if UPLOAD_TLS
+  uploadClient.setInsecure();  // Không kiểm chứng chỉ, như thư viện Firebase khi không nạp CA
+  uploadClient.setSession(&uploadSession);
+  if (uploadClient.probeMaxFragmentLength(UPLOAD_HOST, UPLOAD_PORT, 1024)) {
+    uploadClient.setBufferSizes(1024, 1024);  // Server hỗ trợ MFLN: bớt ~15 KB heap
+  }
+#endif
+  logSerial.printf("🔥 Đẩy dữ liệu lên %s:%u/devices/%s, xác thực bằng legacy secret\n", UPLOAD_HOST, UPLOAD_PORT, deviceId);
+  logSerial.println("🔌 ESP sẵn sàng nhận dữ liệu...");
 }
 
 void loop() {
-  // Nhận UART từ STM32
-  while (mySerial.available()) {
-    char c = mySerial.read();
-    if (c == '\n') {
-      inputBuffer.trim();
-
-      // Kiểm tra và phân tích
-      if (inputBuffer.startsWith("DATA: ")) {
-        Serial.println("📥 Nhận được: " + inputBuffer);
-        parseAndPrint(inputBuffer);
-        
-        // Cập nhật JSON và gửi ngay lên Firebase
-        updateFirebaseJson();
-        sendToFirebase();
+  // Lệnh từ Serial Monitor, mỗi dòng một lệnh
+  while (logSerial.available()) {
+    char c = logSerial.read();
+    if (c == '\n' || c == '\r') {
+      consoleLine[consoleLen] = '\0';
+      if (consoleLen > 0) {
+        handleConsoleLine(consoleLine);
+      }
+      consoleLen = 0;
+    } else if (consoleLen < sizeof(consoleLine) - 1) {
+      consoleLine[consoleLen++] = c;
+    }
+  }
+
+  // Nhận frame từ STM32, mỗi frame kết thúc bằng byte 0x00
+  if (linkSerial.available()) {
+    uint32_t start = micros();
+    uint32_t spent = 0;
+    while (linkSerial.available()) {
+      int n = parserFeed(linkSerial.read());
+      parseBytes++;
+      if (n == 0) {
+        continue;
       }
+      spent += micros() - start;
+      if (n > 0) {
+        framesOk++;
+        handleFrame(parser.payload, n);
+      } else {
+        framesBad++;
+        logSerial.printf("⚠️  Frame hỏng, tổng %u frame hỏng\n", framesBad);
+      }
+      start = micros();
+    }
+    spent += micros() - start;
+    parseUs += spent;
+    if (spent > parseMaxUs) {
+      parseMaxUs = spent;
+    }
+  }
+
+  bool wifiNow = (WiFi.status() == WL_CONNECTED);
+  if (wifiNow != wifiConnected) {
+    wifiConnected = wifiNow;
+    logSerial.println(wifiNow ? "📶 WiFi đã kết nối lại" : "❌ WiFi ngắt kết nối, STM32 giữ bản ghi chờ gửi lại");
+  }
+  uploadPoll();
+  historyPoll();
+
+  // Đối chiếu giờ STM32: mỗi 2 giây khi chưa có giờ, sau đó mỗi CLOCK_SYNC_INTERVAL
+  if (millis() - clockSyncTime >= (clockStale ? 2000 : CLOCK_SYNC_INTERVAL)) {
+    clockRequest();
+  }
+
+  // Cờ lỗi tự xóa khi đọc, đếm mỗi lần loop thấy
+#if LINK_HW_UART
+  if (linkSerial.hasOverrun()) {
+    linkOverruns++;
+  }
+  if (linkSerial.hasRxError()) {
+    linkRxErrors++;
+  }
+#else
+  if (linkSerial.overflow()) {
+    linkOverruns++;
+  }
+#endif
 
-      inputBuffer = "";
-    } else {
-      inputBuffer += c;
+  uint32_t heap = ESP.getFreeHeap();
+  if (heap < heapMin) {
+    heapMin = heap;
+  }
+}
+
+// Payload đã kiểm CRC: kiểm tra version rồi xử lý theo loại frame
+void handleFrame(const uint8_t* frame, size_t n) {
+  if ((frame[0] >> 4) != TELEM_PROTOCOL_VERSION) {
+    // Firmware hai bên lệch nhau: không có giờ STM32 nên mọi bản ghi bị bỏ, báo mỗi 10 giây
+    framesBadVersion++;
+    if (framesBadVersion == 1 || millis() - versionLogTime >= 10000) {
+      versionLogTime = millis();
+      logSerial.printf("⚠️  STM32 dùng giao thức version %u, ESP cần version %u: nạp lại firmware cho khớp (đã bỏ %u frame)\n",
+                       frame[0] >> 4, TELEM_PROTOCOL_VERSION, framesBadVersion);
     }
+    return;
+  }
+
+  switch (frame[0] & 0x0F) {
+    case TELEM_TYPE_BATCH:
+      if (n >= 7 && frame[5] >= 1 && frame[5] <= TELEM_BATCH_MAX && n == 7 + frame[5] * TELEM_RECORD_SIZE) {
+        handleBatch(frame);
+      }
+      break;
+    case TELEM_TYPE_ACK:
+      if (n == TELEM_ACK_SIZE) {
+        static const char* const statusMsg[] = { "OK", "lệnh lạ", "sai tham số", "đang bận" };
+        logSerial.printf("✅ Lệnh #%u (0x%02X): %s\n", frame[1], frame[2],
+                      frame[3] < 4 ? statusMsg[frame[3]] : "?");
+      }
+      break;
+    case TELEM_TYPE_STATS:
+      if (n == TELEM_STATS_SIZE) {
+        handleStats(frame);
+      } else {
+        // Không đọc được BootSeq thì không có giờ STM32, bản ghi bị bỏ đến khi sửa
+        logSerial.printf("⚠️  Frame STATS %u byte, cần %u byte: bỏ qua, chưa có giờ STM32\n",
+                         (unsigned)n, TELEM_STATS_SIZE);
+      }
+      break;
+    case TELEM_TYPE_TEXT:
+      logSerial.print("💬 STM32: ");
+      logSerial.write(&frame[1], n - 1);
+      logSerial.println();
+      break;
+    default:
+      break;
   }
 }
 
-void parseAndPrint(String data) {
-  int tIdx = data.indexOf("TEMP=");
-  int hIdx = data.indexOf("HUMID=");
-  int gIdx = data.indexOf("GAS=");
+// Báo STM32: bản ghi trước uploadedSeq() đã đẩy lên, STM32 bỏ chúng khỏi bộ đệm;
+// bản ghi trước nextSeq đã nhận, STM32 không gửi lại dù chúng còn chờ đẩy lên
+void sendAckSamples() {
+  uint32_t seq = uploadedSeq();
+  uint8_t args[8] = { (uint8_t)seq, (uint8_t)(seq >> 8), (uint8_t)(seq >> 16), (uint8_t)(seq >> 24),
+                      (uint8_t)nextSeq, (uint8_t)(nextSeq >> 8), (uint8_t)(nextSeq >> 16), (uint8_t)(nextSeq >> 24) };
+  sendCommand(TELEM_CMD_ACK_SAMPLES, args, sizeof(args));
+}
+
+// Frame BATCH: nhiều bản ghi liên tiếp, đưa vào lịch sử chờ đẩy lên Firebase
+void handleBatch(const uint8_t* p) {
+  uint32_t firstSeq = getU32(&p[1]);
+  uint8_t count = p[5];
+  uint32_t endSeq = firstSeq + count;
+  bool live = p[6] & TELEM_BATCH_LIVE;
+  historyLive = live;
+
+  if (!haveSeq) {
+    // Frame đầu tiên sau khi ESP khởi động: nhận từ đây
+    haveSeq = true;
+    nextSeq = firstSeq;
+  } else if (firstSeq == 0 && nextSeq != 0) {
+    // STM32 khởi động lại, Seq đếm lại từ 0
+    logSerial.println("🔄 STM32 khởi động lại, đồng bộ lại Seq");
+    queueClear();
+    historyResetAvg();
+    nextSeq = 0;
+    haveLastRecord = false;
+    clockStale = true;
+  }
+  if (endSeq <= nextSeq) {
+    // Gửi lại vì ACK bị mất: đã có rồi, chỉ báo lại
+    sendAckSamples();
+    return;
+  }
+  if (clockStale) {
+    // Chưa biết giờ thực của bản ghi: bỏ frame, STM32 gửi lại sau 5 giây
+    return;
+  }
+  if (firstSeq > nextSeq) {
+    if (!(p[6] & TELEM_BATCH_OLDEST)) {
+      // Frame trước bị mất: bỏ, STM32 sẽ gửi lại
+      return;
+    }
+    // STM32 đã ghi đè bản ghi cũ khi bộ đệm đầy, các bản ghi này không còn nữa
+    samplesLost += firstSeq - nextSeq;
+    nextSeq = firstSeq;
+  }
+
+  uint32_t timeMs = 0;
+  uint8_t flags = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    const uint8_t* r = &p[7 + i * TELEM_RECORD_SIZE];
+    if (firstSeq + i < nextSeq) {
+      continue;
+    }
+    if (!historyAdd(firstSeq + i, r, live)) {
+      // STM32 đã khởi động lại từ bản ghi này: hỏi giờ mới, nhận tiếp khi STM32 gửi lại
+      logSerial.printf("🔄 STM32 khởi động lại từ bản ghi #%lu, hỏi lại giờ\n", (unsigned long)(firstSeq + i));
+      endSeq = firstSeq + i;
+      clockStale = true;
+      clockRequest();
+      break;
+    }
+    timeMs = getU32(&r[0]);
+    flags = r[4];
+    if (!live) {
+      continue;
+    }
+    // Giá trị hiển thị chỉ lấy từ lần đọc mới và không lỗi
+    if ((flags & TELEM_FLAG_DHT11_NEW) && (flags & TELEM_FLAG_DHT11_OK)) {
+      tempValue = (int16_t)getU16(&r[5]) / 10.0f;
+      humidValue = r[7];
+    }
+    if ((flags & TELEM_FLAG_MQ2_NEW) && (flags & TELEM_FLAG_MQ2_OK)) {
+      gasValue = getU16(&r[8]);
+    }
+  }
+  nextSeq = endSeq;
+  // Báo đã nhận ngay để STM32 không gửi lại; chỉ xác nhận phần đã đẩy, bản ghi
+  // còn trong hàng đợi hoặc điểm trung bình chưa đóng được xác nhận sau
+  sendAckSamples();
 
-  if (tIdx != -1 && hIdx != -1 && gIdx != -1) {
-    String temp = data.substring(tIdx + 5, data.indexOf("°", tIdx));
-    String humid = data.substring(hIdx + 6, data.indexOf("%", hIdx));
-    String gas = data.substring(gIdx + 4, data.indexOf("ppm", gIdx));
+  if (clockStale) {
+    return;
+  }
+  if (!live) {
+    // Bản ghi cũ STM32 gửi bù: không đổi giá trị đang hiển thị
+    logSerial.printf("📦 Gửi bù #%lu..#%lu\n", (unsigned long)firstSeq, (unsigned long)(endSeq - 1));
+    return;
+  }
 
-    // Chuyển đổi từ String sang float
-    tempValue = temp.toFloat();
-    humidValue = humid.toFloat();
-    gasValue = gas.toFloat();
+  logSerial.printf("📥 Bản ghi #%lu..#%lu, mới nhất lúc %lu ms, mất %u bản ghi\n",
+                (unsigned long)firstSeq, (unsigned long)(endSeq - 1), (unsigned long)timeMs, samplesLost);
+  logSerial.printf("🌡️  Nhiệt độ: %.1f°C%s\n", tempValue, (flags & TELEM_FLAG_DHT11_OK) ? "" : " (DHT11 lỗi)");
+  logSerial.printf("💧 Độ ẩm   : %.0f%%\n", humidValue);
+  logSerial.printf("🧪 Gas     : %.0f ppm%s\n", gasValue, (flags & TELEM_FLAG_MQ2_OK) ? "" : " (MQ2 lỗi)");
+  logSerial.println("——————————————");
+}
 
-    Serial.println("🌡️  Nhiệt độ: " + temp + "°C");
-    Serial.println("💧 Độ ẩm   : " + humid + "%");
-    Serial.println("🧪 Gas     : " + gas + " ppm");
-    Serial.println("——————————————");
+// Frame thống kê: trả lời lệnh "stats" hoặc lần đối chiếu giờ
+void handleStats(const uint8_t* p) {
+  clockUpdate(getU32(&p[40]), getU32(&p[2]));
+  if (!statsPrint) {
+    return;
   }
+  statsPrint = false;
+  logSerial.printf("📊 STM32 #%u: chạy %lu s, chu kỳ DHT11/MQ2/UART = %u/%u/%u ms, khởi động từ bản ghi #%lu\n", p[1],
+                (unsigned long)(getU32(&p[2]) / 1000), getU16(&p[6]), getU16(&p[8]), getU16(&p[10]),
+                (unsigned long)getU32(&p[40]));
+  logSerial.printf("   DHT11 %lu lần đọc, %lu lỗi\n", (unsigned long)getU32(&p[12]), (unsigned long)getU32(&p[16]));
+  logSerial.printf("   TX %lu frame, bỏ %lu, lỗi %lu; RX %lu frame, lỗi %lu\n",
+                (unsigned long)getU32(&p[20]), (unsigned long)getU32(&p[24]), (unsigned long)getU32(&p[28]),
+                (unsigned long)getU32(&p[32]), (unsigned long)getU32(&p[36]));
+  uint32_t readings = getU32(&p[44]);
+  uint32_t suppressed = getU32(&p[48]);
+  logSerial.printf("   Ghi %lu/%lu lần đọc, bỏ %lu lần không đổi (%lu%%)\n", (unsigned long)(readings - suppressed),
+                (unsigned long)readings, (unsigned long)suppressed,
+                (unsigned long)(readings ? (uint64_t)suppressed * 100 / readings : 0));
 }
 
-void updateFirebaseJson() {
-  // Xóa JSON cũ
-  json.clear();
-  
-  // Tạo cấu trúc JSON theo yêu cầu
-  FirebaseJson sensorJson;
-  sensorJson.add("temp", tempValue);
-  sensorJson.add("humid", humidValue);
-  sensorJson.add("gas", gasValue);
-  
-  json.add("sensor", sensorJson);
-  
-  // In JSON ra Serial để kiểm tra
-  String jsonStr;
-  json.toString(jsonStr, true);
-  Serial.println("📊 JSON: " + jsonStr);
+// Thống kê phía ESP, in ngay khi gõ "stats"
+void printEspStats() {
+  logSerial.printf("📶 ESP: %u frame tốt, %u hỏng, %u sai version, mất %u bản ghi\n", framesOk, framesBad,
+                   framesBadVersion, samplesLost);
+  logSerial.printf("🔌 UART %s %u baud: tràn bộ đệm %u lần, lỗi khung %u lần\n",
+                   LINK_HW_UART ? "phần cứng" : "phần mềm", LINK_BAUD, linkOverruns, linkRxErrors);
+  logSerial.printf("🔥 Firebase: %u request, %u điểm, %u lỗi, %u lần kết nối, lâu nhất %u ms\n",
+                   uploadRequests, uploadPoints, uploadErrors, uploadConnects, uploadMaxMs);
+  logSerial.printf("📦 Hàng đợi: %u/%u điểm (cao nhất %u), bỏ %u điểm\n",
+                   queueCount, UPLOAD_QUEUE, queuePeak, uploadDropped);
+  logSerial.printf("📈 Lịch sử: %u bản ghi thành %u điểm thô, %u trung bình, %u chưa có giờ; giờ STM32 %s\n",
+                   historyRecords, historyRaw, historyAvg, historyUnsynced, clockStale ? "chưa có" : "đã có");
+  logSerial.printf("⏱️  Tách frame: %u byte trong %u us, lâu nhất %u us một lần\n", parseBytes, parseUs, parseMaxUs);
+  logSerial.printf("🧠 Heap trống %u byte (thấp nhất %u), khối lớn nhất %u, phân mảnh %u%%\n",
+                ESP.getFreeHeap(), heapMin, ESP.getMaxFreeBlockSize(), ESP.getHeapFragmentation());
+}
+
+// Ô của bản ghi thứ i trong hàng đợi, tính từ bản ghi cũ nhất
+uint16_t queueIndex(uint16_t i) {
+  return (queueHead + UPLOAD_QUEUE - queueCount + i) % UPLOAD_QUEUE;
 }
 
-void sendToFirebase() {
-  if (WiFi.status() == WL_CONNECTED) {
-    // Gửi dữ liệu lên Firebase
-    if (Firebase.setJSON(firebaseData, "/", json)) {
-      Serial.println("🔥 Đã gửi dữ liệu lên Firebase");
-    } else {
-      Serial.println("❌ Lỗi Firebase: " + firebaseData.errorReason());
+// Bản ghi đầu chưa đẩy lên: bản ghi tạo ra điểm cũ nhất trong hàng đợi, hoặc nextSeq nếu rỗng
+uint32_t uploadedSeq() {
+  // Điểm trung bình mang Seq của bản ghi đầu tiên nên có thể nhỏ hơn điểm thô đứng trước
+  uint32_t seq = nextSeq;
+  if (avgRecords > 0 && avgFirstSeq < seq) {
+    seq = avgFirstSeq;
+  }
+  for (uint16_t i = 0; i < queueCount; i++) {
+    if (uploadQueue[queueIndex(i)].seq < seq) {
+      seq = uploadQueue[queueIndex(i)].seq;
+    }
+  }
+  return seq;
+}
+
+// Gọi trước khi thêm dữ liệu chờ đẩy: bắt đầu tính UPLOAD_DELAY
+void markPending() {
+  if (queueCount == 0 && !latestPending) {
+    pendingSince = millis();
+  }
+}
+
+// Thêm điểm vào hàng đợi. Đầy thì bỏ điểm cũ nhất chưa gửi, bản ghi của điểm
+// đó được xác nhận cùng các điểm sau nên STM32 cũng không gửi lại.
+void queuePush(const HistoryPoint& point) {
+  markPending();
+  if (queueCount == UPLOAD_QUEUE) {
+    // Dồn các điểm đang gửi lên một ô, đè lên điểm cũ nhất chưa gửi
+    for (uint16_t i = queueSending; i > 0; i--) {
+      uploadQueue[queueIndex(i)] = uploadQueue[queueIndex(i - 1)];
+    }
+    queueCount--;
+    uploadDropped++;
+  }
+  uploadQueue[queueHead] = point;
+  queueHead = (queueHead + 1) % UPLOAD_QUEUE;
+  queueCount++;
+  if (queueCount > queuePeak) {
+    queuePeak = queueCount;
+  }
+}
+
+// Bỏ mọi điểm đang chờ: Seq của STM32 đã đếm lại, không còn khớp
+void queueClear() {
+  if (uploadState != UPLOAD_IDLE) {
+    uploadClient.stop();
+    uploadState = UPLOAD_IDLE;
+  }
+  uploadDropped += queueCount;
+  queueCount = 0;
+  queueSending = 0;
+}
+
+// Giờ thực theo NTP, ms UTC; 0 nếu chưa đồng bộ
+int64_t epochMs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  if (tv.tv_sec < 1600000000) {
+    return 0;
+  }
+  return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+// Hỏi uptime và BootSeq của STM32 (trả lời bằng frame STATS)
+void clockRequest() {
+  clockSyncTime = millis();
+  if (epochMs() != 0) {
+    sendCommand(TELEM_CMD_GET_STATS, NULL, 0);
+  }
+}
+
+// Frame STATS vừa đến: ghi lại giờ khởi động của lần chạy hiện tại của STM32
+void clockUpdate(uint32_t bootSeq, uint32_t uptimeMs) {
+  int64_t now = epochMs();
+  if (now == 0) {
+    return;
+  }
+  int64_t bootMs = now - uptimeMs;
+  if (sessionCount > 0 && sessions[sessionCount - 1].bootSeq == bootSeq) {
+    // Cùng lần chạy: cập nhật để bù độ trôi giữa hai đồng hồ. Nếu đang hỏi vì
+    // TimeMs giảm thì STM32 không khởi động lại (HAL_GetTick quay vòng): nhận tiếp
+    sessions[sessionCount - 1].epochMs = bootMs;
+    if (clockStale) {
+      haveLastRecord = false;
     }
   } else {
-    Serial.println("❌ WiFi ngắt kết nối!");
+    if (sessionCount > 0 && bootSeq < sessions[sessionCount - 1].bootSeq) {
+      sessionCount = 0;  // STM32 bắt đầu nhật ký mới
+    }
+    if (sessionCount == CLOCK_SESSIONS) {
+      memmove(&sessions[0], &sessions[1], sizeof(sessions[0]) * (CLOCK_SESSIONS - 1));
+      sessionCount--;
+    }
+    sessions[sessionCount].bootSeq = bootSeq;
+    sessions[sessionCount].epochMs = bootMs;
+    sessionCount++;
+    logSerial.printf("🕒 STM32 khởi động lúc %lu (UTC), bản ghi từ #%lu\n",
+                     (unsigned long)(bootMs / 1000), (unsigned long)bootSeq);
+  }
+  clockStale = false;
+}
+
+// Lần chạy của STM32 chứa bản ghi seq, NULL nếu trước mọi lần chạy ESP biết
+const ClockSession* clockFind(uint32_t seq) {
+  for (int8_t i = sessionCount - 1; i >= 0; i--) {
+    if (seq >= sessions[i].bootSeq) {
+      return &sessions[i];
+    }
+  }
+  return NULL;
+}
+
+// Đóng điểm trung bình đang cộng dồn, kèm xóa các bucket thô đã quá hạn
+void historyCloseAvg() {
+  HistoryPoint point = {};
+  point.seq = avgFirstSeq;
+  point.time = avgFirstTime;
+  point.kind = POINT_AVG;
+  if (avgDhtCount > 0) {
+    point.v.tempX10 = avgTempSum / (int32_t)avgDhtCount;
+    point.v.humidX10 = avgHumidSum / avgDhtCount;
+    point.v.fields |= HISTORY_DHT;
+  }
+  if (avgGasCount > 0) {
+    point.v.gas = (avgGasSum + avgGasCount / 2) / avgGasCount;
+    point.v.fields |= HISTORY_GAS;
+  }
+  point.count = (avgDhtCount > avgGasCount) ? avgDhtCount : avgGasCount;
+
+  if (HISTORY_RAW_KEEP > 0) {
+    uint32_t expired = avgBucket - HISTORY_RAW_KEEP;  // Bucket thô mới nhất đã quá hạn
+    if (rawDeleteFrom == 0) {
+      rawDeleteFrom = expired - HISTORY_RAW_KEEP;     // ESP vừa khởi động: xóa lại cả giờ trước đó
+    }
+    point.deleteFrom = rawDeleteFrom;
+    while (rawDeleteFrom <= expired && point.deletes < HISTORY_RAW_DELETES) {
+      rawDeleteFrom += HISTORY_AVG_STEP;
+      point.deletes++;
+    }
+  }
+  queuePush(point);
+  historyAvg++;
+  historyResetAvg();
+}
+
+// Bỏ điểm trung bình đang cộng dồn
+void historyResetAvg() {
+  avgTempSum = 0;
+  avgHumidSum = 0;
+  avgGasSum = 0;
+  avgDhtCount = 0;
+  avgGasCount = 0;
+  avgRecords = 0;
+}
+
+// Dữ liệu mới mà bucket đã hết giờ từ lâu (deadband, không có bản ghi mới):
+// đóng điểm trung bình để đẩy lên và xác nhận, STM32 không phải gửi lại
+void historyPoll() {
+  if (avgRecords == 0 || !historyLive || clockStale) {
+    return;
+  }
+  if (epochMs() >= ((int64_t)avgBucket + HISTORY_AVG_STEP + HISTORY_AVG_GRACE) * 1000) {
+    historyCloseAvg();
+  }
+}
+
+// Đưa một bản ghi vào lịch sử: cộng vào bucket trung bình, tạo điểm thô nếu
+// giá trị đã đổi. Trả về false nếu TimeMs cho thấy STM32 đã khởi động lại mà
+// chưa có giờ của lần chạy mới (bản ghi chưa được dùng).
+bool historyAdd(uint32_t seq, const uint8_t* r, bool live) {
+  uint32_t timeMs = getU32(&r[0]);
+  uint8_t flags = r[4];
+  bool dht = (flags & TELEM_FLAG_DHT11_NEW) && (flags & TELEM_FLAG_DHT11_OK);
+  bool gas = (flags & TELEM_FLAG_MQ2_NEW) && (flags & TELEM_FLAG_MQ2_OK);
+  const ClockSession* session = clockFind(seq);
+
+  if (session != NULL && haveLastRecord && seq == lastRecordSeq + 1 && timeMs < lastRecordTime &&
+      session == clockFind(lastRecordSeq)) {
+    return false;
+  }
+  haveLastRecord = true;
+  lastRecordSeq = seq;
+  lastRecordTime = timeMs;
+  historyRecords++;
+
+  if (session == NULL) {
+    // Bản ghi từ lần chạy STM32 trước khi ESP có giờ (ví dụ mất điện cả hai)
+    HistoryPoint point = {};
+    point.seq = seq;
+    point.time = timeMs;
+    point.kind = POINT_UNSYNCED;
+    if (dht) {
+      point.v.tempX10 = (int16_t)getU16(&r[5]);
+      point.v.humidX10 = r[7] * 10;
+      point.v.fields |= HISTORY_DHT;
+    }
+    if (gas) {
+      point.v.gas = getU16(&r[8]);
+      point.v.fields |= HISTORY_GAS;
+    }
+    queuePush(point);
+    historyUnsynced++;
+    return true;
+  }
+
+  uint32_t sec = (uint32_t)((session->epochMs + timeMs) / 1000);
+  uint32_t bucket = sec - sec % HISTORY_AVG_STEP;
+  bool newLatest = false;
+  if (avgRecords > 0 && (bucket != avgBucket || (avgRecords >= HISTORY_AVG_HOLD && sec != avgFirstTime))) {
+    // Sang bucket mới, hoặc đã giữ đủ bản ghi chưa xác nhận: STM32 chỉ gửi
+    // tối đa 64 bản ghi chưa có ACK, chờ thêm thì không bao giờ sang bucket mới.
+    // Điểm mới phải khác giây để không ghi đè khóa của điểm vừa đóng.
+    historyCloseAvg();
+    newLatest = true;  // Điểm trung bình cũng làm nhịp cho "latest" khi giá trị không đổi
+  }
+  if ((dht || gas) && avgRecords++ == 0) {
+    avgBucket = bucket;
+    avgFirstSeq = seq;
+    avgFirstTime = sec;
+  }
+
+  if (dht) {
+    current.tempX10 = (int16_t)getU16(&r[5]);
+    current.humidX10 = r[7] * 10;
+    current.fields |= HISTORY_DHT;
+    avgTempSum += current.tempX10;
+    avgHumidSum += current.humidX10;
+    avgDhtCount++;
+  }
+  if (gas) {
+    current.gas = getU16(&r[8]);
+    current.fields |= HISTORY_GAS;
+    avgGasSum += current.gas;
+    avgGasCount++;
+  }
+
+  bool changed = current.fields != lastRaw.fields || current.tempX10 != lastRaw.tempX10 ||
+                 current.humidX10 != lastRaw.humidX10 || current.gas != lastRaw.gas;
+  if (changed && current.fields != 0 && sec - lastRawTime >= HISTORY_RAW_STEP) {
+    // Bản ghi gửi bù đã quá hạn giữ thì chỉ còn trong điểm trung bình
+    int64_t now = epochMs();
+    if (HISTORY_RAW_KEEP > 0 && (int64_t)sec * 1000 + (int64_t)HISTORY_RAW_KEEP * 1000 > now) {
+      HistoryPoint point = {};
+      point.seq = seq;
+      point.time = sec;
+      point.kind = POINT_RAW;
+      point.v = current;
+      queuePush(point);
+      historyRaw++;
+    }
+    lastRaw = current;
+    lastRawTime = sec;
+    newLatest = true;
+  }
+  if (live && newLatest) {
+    markPending();
+    latestPending = true;
+    latest = current;
+    latestTime = sec;
+  }
+  return true;
+}
+
+// Ghi các trường có trong v dạng "temp":..,"humid":..,"gas":.. (không có ngoặc)
+size_t historyFields(char* dst, size_t size, const HistoryValues& v) {
+  size_t n = 0;
+  const char* sep = "";
+  if (v.fields & HISTORY_DHT) {
+    n += snprintf(&dst[n], size - n, "\"temp\":%.1f,\"humid\":%.1f", v.tempX10 / 10.0f, v.humidX10 / 10.0f);
+    sep = ",";
+  }
+  if (v.fields & HISTORY_GAS) {
+    n += snprintf(&dst[n], size - n, "%s\"gas\":%u", sep, v.gas);
+  }
+  return n;
+}
+
+// Ghép JSON cho request kế tiếp, PATCH tại /devices/<id>: "latest" nếu có giá
+// trị mới và các điểm đầu hàng đợi (cập nhật nhiều nhánh trong một request).
+// Khóa theo thời gian nên request gửi lại chỉ ghi đè đúng điểm cũ, không tạo
+// bản trùng như push.
+size_t uploadBuildBody() {
+  size_t n = 0;
+  const size_t size = sizeof(uploadBody);
+  latestSending = latestPending;
+  latestPending = false;
+
+  uploadBody[n++] = '{';
+  if (latestSending) {
+    n += snprintf(&uploadBody[n], size - n, "\"latest\":{\"t\":%lu,", (unsigned long)latestTime);
+    n += historyFields(&uploadBody[n], size - n, latest);
+    n += snprintf(&uploadBody[n], size - n, "},");
+  }
+  for (queueSending = 0; queueSending < queueCount && queueSending < UPLOAD_BATCH; queueSending++) {
+    if (size - n < POINT_JSON_MAX) {
+      break;
+    }
+    const HistoryPoint& point = uploadQueue[queueIndex(queueSending)];
+    switch (point.kind) {
+      case POINT_RAW:
+        n += snprintf(&uploadBody[n], size - n, "\"raw/%lu/%lu\":{",
+                      (unsigned long)(point.time - point.time % HISTORY_AVG_STEP), (unsigned long)point.time);
+        break;
+      case POINT_AVG:
+        for (uint8_t i = 0; i < point.deletes; i++) {
+          n += snprintf(&uploadBody[n], size - n, "\"raw/%lu\":null,",
+                        (unsigned long)(point.deleteFrom + i * HISTORY_AVG_STEP));
+        }
+        n += snprintf(&uploadBody[n], size - n, "\"avg/%lu\":{\"n\":%u,", (unsigned long)point.time, point.count);
+        break;
+      default:
+        n += snprintf(&uploadBody[n], size - n, "\"unsynced/%010lu\":{\"t\":%lu,",
+                      (unsigned long)point.seq, (unsigned long)point.time);
+        break;
+    }
+    n += historyFields(&uploadBody[n], size - n, point.v);
+    if (uploadBody[n - 1] == ',') {
+      n--;  // Điểm không có trường nào
+    }
+    n += snprintf(&uploadBody[n], size - n, "},");
+  }
+  uploadBody[n - 1] = '}';  // Thay dấu phẩy cuối
+  return n;
+}
+
+// Đủ một lô, hoặc dữ liệu đầu tiên đã chờ UPLOAD_DELAY
+bool uploadReady() {
+  if ((queueCount == 0 && !latestPending) || !wifiConnected) {
+    return false;
+  }
+  uint32_t now = millis();
+  if (uploadFailed && now - uploadFailTime < UPLOAD_RETRY) {
+    return false;
+  }
+  return queueCount >= UPLOAD_BATCH || now - pendingSince >= UPLOAD_DELAY;
+}
+
+// Gửi request PATCH, phản hồi đọc sau trong uploadPoll()
+void uploadSend() {
+  size_t len = uploadBuildBody();
+  uploadStart = millis();
+  respLen = 0;
+  respStatus = 0;
+  respRemaining = -1;
+  respClose = false;
+
+  uploadReused = uploadClient.connected();
+  if (!uploadReused) {
+    // Kết nối mới: bắt tay TLS chặn vòng lặp ~1-2 giây, chỉ khi kết nối cũ đã đóng
+    uploadClient.stop();
+    uploadConnects++;
+    if (!uploadClient.connect(UPLOAD_HOST, UPLOAD_PORT)) {
+      uploadFinish(false, "không kết nối được server");
+      return;
+    }
+    uploadClient.setNoDelay(true);
+  }
+
+  char head[320];
+  int headLen = snprintf(head, sizeof(head),
+                         "PATCH /devices/%s.json?auth=%s&print=silent HTTP/1.1\r\n"
+                         "Host: %s\r\n"
+                         "Content-Type: application/json\r\n"
+                         "Content-Length: %u\r\n\r\n",
+                         deviceId, FIREBASE_SECRET, UPLOAD_HOST, (unsigned)len);
+  uploadState = UPLOAD_STATUS;
+  if (uploadClient.write((const uint8_t*)head, headLen) != (size_t)headLen ||
+      uploadClient.write((const uint8_t*)uploadBody, len) != len) {
+    uploadFinish(false, "gửi request lỗi");
+  }
+}
+
+// Kết thúc request: thành công thì bỏ các bản ghi đã đẩy khỏi hàng đợi và xác nhận với STM32
+void uploadFinish(bool ok, const char* reason) {
+  uint32_t ms = millis() - uploadStart;
+  uploadState = UPLOAD_IDLE;
+  if (!ok || respClose) {
+    uploadClient.stop();
+  }
+
+  if (ok) {
+    logSerial.printf("🔥 Đã đẩy %u điểm%s lên Firebase trong %lu ms\n", queueSending,
+                     latestSending ? " và giá trị mới nhất" : "", (unsigned long)ms);
+    uploadRequests++;
+    uploadPoints += queueSending;
+    if (ms > uploadMaxMs) {
+      uploadMaxMs = ms;
+    }
+    queueCount -= queueSending;
+    queueSending = 0;
+    latestSending = false;
+    uploadFailed = false;
+    sendAckSamples();
+    return;
+  }
+
+  queueSending = 0;
+  if (latestSending) {
+    latestPending = true;
+    latestSending = false;
+  }
+  if (uploadReused && respStatus == 0) {
+    // Server đã đóng kết nối cũ khi chưa trả lời: gửi lại ngay trên kết nối mới
+    uploadReused = false;
+    uploadClient.stop();
+    return;
+  }
+  uploadErrors++;
+  uploadFailed = true;
+  uploadFailTime = millis();
+  logSerial.printf("❌ Lỗi Firebase: %s, gửi lại sau %u ms\n", reason, UPLOAD_RETRY);
+}
+
+// Đã đọc hết phản hồi
+void uploadResponseDone() {
+  if (respStatus >= 200 && respStatus < 300) {
+    uploadFinish(true, NULL);
+    return;
+  }
+  char reason[128];
+  respLine[respLen] = '\0';
+  snprintf(reason, sizeof(reason), "HTTP %d %s", respStatus, (uploadState == UPLOAD_BODY) ? respLine : "");
+  uploadFinish(false, reason);
+}
+
+// Một dòng status hoặc header của phản hồi, đã bỏ "\r\n"
+void uploadHeaderLine() {
+  if (uploadState == UPLOAD_STATUS) {
+    if (sscanf(respLine, "HTTP/%*s %d", &respStatus) != 1) {
+      uploadFinish(false, "phản hồi không phải HTTP");
+      return;
+    }
+    uploadState = UPLOAD_HEADERS;
+  } else if (respLen == 0) {
+    // Hết header. Không có Content-Length thì không biết body dài bao nhiêu: bỏ kết nối
+    if (respRemaining < 0 && respStatus != 204) {
+      respClose = true;
+    }
+    if (respRemaining <= 0) {
+      uploadResponseDone();
+      return;
+    }
+    uploadState = UPLOAD_BODY;
+  } else if (strncasecmp(respLine, "Content-Length:", 15) == 0) {
+    respRemaining = atol(&respLine[15]);
+  } else if (strncasecmp(respLine, "Connection:", 11) == 0 && strstr(respLine, "close") != NULL) {
+    respClose = true;
+  }
+  respLen = 0;
+}
+
+// Gọi mỗi vòng loop(): gửi request khi đến lúc, hoặc đọc phần phản hồi đã đến
+void uploadPoll() {
+  if (uploadState == UPLOAD_IDLE) {
+    if (uploadReady()) {
+      uploadSend();
+    }
+    return;
+  }
+
+  while (uploadState != UPLOAD_IDLE && uploadClient.available()) {
+    char c = uploadClient.read();
+    if (uploadState == UPLOAD_BODY) {
+      if (respLen < sizeof(respLine) - 1) {
+        respLine[respLen++] = c;  // Giữ đầu body, Firebase trả {"error": ...} khi lỗi
+      }
+      if (--respRemaining == 0) {
+        uploadResponseDone();
+      }
+    } else if (c == '\n') {
+      if (respLen > 0 && respLine[respLen - 1] == '\r') {
+        respLen--;
+      }
+      respLine[respLen] = '\0';
+      uploadHeaderLine();
+    } else if (respLen < sizeof(respLine) - 1) {
+      respLine[respLen++] = c;
+    }
+  }
+
+  if (uploadState == UPLOAD_IDLE) {
+    return;
+  }
+  if (!uploadClient.connected()) {
+    uploadFinish(false, "server đóng kết nối");
+  } else if (millis() - uploadStart >= UPLOAD_TIMEOUT) {
+    uploadFinish(false, "quá thời gian chờ phản hồi");
   }
 }
 //HelloHello
@@ -0,0 +1,167 @@
+/*
+ * FMT vs snprintf on the host
+ *
+ * Checks that FMT_Fixed/FMT_Buffer print the same text as snprintf for
+ * random values, then times the lines the firmware builds with FMT:
+ *
+ *   FMT_BENCH,<case>,<calls>,<fmt ns per call>,<snprintf ns per call>
+ *
+ * Host timings only show the relative cost; on the Cortex-M4 newlib's
+ * snprintf is slower still and pulls in its own stack and heap use.
+ *
+ * Exits with 1 if any output differs.
+ */
+
+#include "fmt.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FMT_BENCH_CALLS     1000000u
+#define FMT_BENCH_CHECKS    200000u
+
+static volatile uint32_t fmt_bench_sink;
+
+static uint64_t fmt_bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t fmt_bench_rand(void) {
+    static uint32_t state = 0x12345678u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Reference: sign and magnitude apart, like FMT_Fixed
+static void fmt_bench_ref_fixed(char* buf, size_t size, int32_t value, uint8_t decimals, uint8_t width) {
+    char tmp[32];
+    const long long mag = llabs((long long)value);
+    long long scale = 1;
+    for (uint8_t i = 0; i < decimals; i++) {
+        scale *= 10;
+    }
+    if (decimals > 0) {
+        snprintf(tmp, sizeof(tmp), "%s%lld.%0*lld", value < 0 ? "-" : "",
+                 mag / scale, (int)decimals, mag % scale);
+    } else {
+        snprintf(tmp, sizeof(tmp), "%s%lld", value < 0 ? "-" : "", mag);
+    }
+    snprintf(buf, size, "%*s", (int)width, tmp);
+}
+
+static uint32_t fmt_bench_check(void) {
+    static const int32_t edges[] = { 0, 5, -5, 9, -9, 10, -10, INT32_MIN, INT32_MAX, -1 };
+    char got[32], want[32];
+    uint32_t bad = 0;
+
+    for (uint32_t n = 0; n < FMT_BENCH_CHECKS; n++) {
+        const uint32_t edge = n % 4 == 0 ? n / 4 % (sizeof(edges) / sizeof(edges[0])) : 0;
+        const int32_t value = n % 4 == 0 ? edges[edge] : (int32_t)fmt_bench_rand() >> (fmt_bench_rand() % 31);
+        const uint8_t decimals = fmt_bench_rand() % 5;
+        const uint8_t width = fmt_bench_rand() % 16;
+
+        FMT_Fixed(got, sizeof(got), value, decimals, width);
+        fmt_bench_ref_fixed(want, sizeof(want), value, decimals, width);
+        if (strcmp(got, want) != 0) {
+            if (bad++ < 10) {
+                printf("FMT_Fixed(%ld, %u, %u): '%s', snprintf '%s'\n",
+                       (long)value, decimals, width, got, want);
+            }
+        }
+    }
+
+    // FMT_Scale: half away from zero, saturation and NaN
+    static const struct { float Value; uint8_t Decimals; int32_t Want; } scales[] = {
+        { 25.36f, 1, 254 }, { -25.35f, 1, -254 }, { -0.45f, 1, -5 }, { -0.04f, 1, 0 },
+        { 1e10f, 1, INT32_MAX }, { -1e10f, 1, INT32_MIN }, { NAN, 1, 0 }, { -NAN, 3, 0 },
+    };
+    for (uint32_t i = 0; i < sizeof(scales) / sizeof(scales[0]); i++) {
+        const int32_t got_scale = FMT_Scale(scales[i].Value, scales[i].Decimals);
+        if (got_scale != scales[i].Want) {
+            bad++;
+            printf("FMT_Scale(%g, %u): %ld, expected %ld\n", (double)scales[i].Value,
+                   scales[i].Decimals, (long)got_scale, (long)scales[i].Want);
+        }
+    }
+    return bad;
+}
+
+/* OLED statistics line, as main.c builds it */
+
+static void fmt_bench_oled_fmt(uint32_t i) {
+    char buffer[80];
+    FMT_Buffer line;
+    FMT_Init(&line, buffer, sizeof(buffer));
+    FMT_PutStr(&line, "OLED: FPS=");
+    FMT_PutFixed(&line, (int32_t)(i % 3000), 2, 0);
+    FMT_PutStr(&line, ", BUS=");
+    FMT_PutFixed(&line, (int32_t)(i % 1000), 1, 0);
+    FMT_PutStr(&line, "%, BYTES=");
+    FMT_PutUint(&line, i * 7u, 0);
+    FMT_PutStr(&line, ", HEARTBEATS=");
+    FMT_PutUint(&line, i % 100, 0);
+    fmt_bench_sink += line.Len;
+}
+
+static void fmt_bench_oled_snprintf(uint32_t i) {
+    char buffer[80];
+    const uint32_t fps = i % 3000, bus = i % 1000;
+    fmt_bench_sink += (uint32_t)snprintf(buffer, sizeof(buffer),
+        "OLED: FPS=%lu.%02lu, BUS=%lu.%lu%%, BYTES=%lu, HEARTBEATS=%lu",
+        (unsigned long)(fps / 100), (unsigned long)(fps % 100),
+        (unsigned long)(bus / 10), (unsigned long)(bus % 10),
+        (unsigned long)(i * 7u), (unsigned long)(i % 100));
+}
+
+/* Value widget text: one float reading with one decimal */
+
+static void fmt_bench_value_fmt(uint32_t i) {
+    char text[16];
+    const float reading = (float)(i % 1000) * 0.1f - 20.0f;
+    fmt_bench_sink += FMT_Fixed(text, sizeof(text), FMT_Scale(reading, 1), 1, 0);
+}
+
+static void fmt_bench_value_snprintf(uint32_t i) {
+    char text[16];
+    const float reading = (float)(i % 1000) * 0.1f - 20.0f;
+    fmt_bench_sink += (uint32_t)snprintf(text, sizeof(text), "%.1f", (double)reading);
+}
+
+typedef struct {
+    const char* Name;
+    void (*Fmt)(uint32_t i);
+    void (*Snprintf)(uint32_t i);
+} FMT_Bench_t;
+
+static const FMT_Bench_t fmt_benches[] = {
+    { "OledStatsLine",  fmt_bench_oled_fmt,     fmt_bench_oled_snprintf },
+    { "ValueText",      fmt_bench_value_fmt,    fmt_bench_value_snprintf },
+};
+
+static uint64_t fmt_bench_time(void (*call)(uint32_t i)) {
+    const uint64_t start = fmt_bench_now();
+    for (uint32_t i = 0; i < FMT_BENCH_CALLS; i++) {
+        call(i);
+    }
+    return fmt_bench_now() - start;
+}
+
+int main(void) {
+    const uint32_t bad = fmt_bench_check();
+    printf("FMT_CHECK,%u,%s\n", FMT_BENCH_CHECKS, bad ? "FAIL" : "OK");
+
+    for (uint32_t i = 0; i < sizeof(fmt_benches) / sizeof(fmt_benches[0]); i++) {
+        const uint64_t fmt = fmt_bench_time(fmt_benches[i].Fmt);
+        const uint64_t libc = fmt_bench_time(fmt_benches[i].Snprintf);
+        printf("FMT_BENCH,%s,%u,%.1f,%.1f\n", fmt_benches[i].Name, FMT_BENCH_CALLS,
+               (double)fmt / FMT_BENCH_CALLS, (double)libc / FMT_BENCH_CALLS);
+    }
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,189 @@
+/*
+ * Sample log acknowledgements on the host
+ *
+ * Runs SLOG against a simulated ESP on a lossless or lossy link and checks
+ * what the STM32 puts on the wire. The ESP reports every frame as received
+ * right away and commits records only once their averaged point would be
+ * uploaded, up to a minute later, as GenX_ESP8266_Final.ino does.
+ *
+ *   sample_log_check
+ *
+ * One line per case:
+ *
+ *   SLOG_CHECK,<case>,<frames>,<records sent>,<retransmits>,<OK|FAIL>
+ *
+ * Exits with 1 if any case fails.
+ */
+
+#include "sample_log.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK_STEP_MS       10u
+#define CHECK_INTERVAL_MS   1000u       // UART send interval, main.c default
+#define CHECK_COMMIT_MS     70000u      // HISTORY_AVG_STEP + HISTORY_AVG_GRACE on the ESP
+
+static SLOG_Data check_log;
+static int check_failed;
+
+/* Simulated ESP: received and committed points, what it got on the wire */
+typedef struct {
+    uint32_t Received;          // nextSeq
+    uint32_t Committed;         // uploadedSeq()
+    uint32_t CommitAt;          // Time the held records get uploaded, 0 if none held
+    uint32_t Frames;
+    uint32_t RecordsSent;
+    uint32_t Duplicates;        // Records that arrived a second time
+    uint32_t FirstSeq;          // Of the last frame
+    uint8_t Legacy;             // Old ESP: one NextSeq, acks only after upload
+} Check_Esp_t;
+
+static void check_append(uint32_t time) {
+    TELEM_Record record;
+    memset(&record, 0, sizeof(record));
+    record.TimeMs = time;
+    SLOG_Append(&check_log, &record);
+}
+
+static void check_ack(Check_Esp_t* esp, uint32_t time) {
+    SLOG_Ack(&check_log, esp->Committed, esp->Legacy ? esp->Committed : esp->Received, time);
+}
+
+/* One link step: the STM32 sends what is due, the ESP takes it unless dropFrame */
+static void check_step(Check_Esp_t* esp, uint32_t time, uint8_t dropFrame, uint8_t dropAck) {
+    TELEM_Record records[TELEM_BATCH_MAX];
+    uint32_t firstSeq;
+    uint8_t flags;
+    uint8_t count;
+
+    while ((count = SLOG_NextBatch(&check_log, time, CHECK_INTERVAL_MS, records, &firstSeq, &flags)) > 0) {
+        esp->Frames++;
+        esp->RecordsSent += count;
+        esp->FirstSeq = firstSeq;
+        if (dropFrame) {
+            continue;
+        }
+        if (firstSeq > esp->Received) {
+            continue;           // A frame before this one was lost
+        }
+        const uint32_t endSeq = firstSeq + count;
+        esp->Duplicates += ((endSeq < esp->Received) ? endSeq : esp->Received) - firstSeq;
+        if (endSeq > esp->Received) {
+            esp->Received = endSeq;
+            if (esp->CommitAt == 0) {
+                esp->CommitAt = time + CHECK_COMMIT_MS;
+            }
+        }
+        if (!dropAck && !esp->Legacy) {
+            check_ack(esp, time);
+        }
+    }
+
+    if (esp->CommitAt != 0 && time >= esp->CommitAt) {
+        esp->Committed = esp->Received;
+        esp->CommitAt = 0;
+        check_ack(esp, time);
+    }
+}
+
+static void check_report(const char* name, const Check_Esp_t* esp, int ok) {
+    printf("SLOG_CHECK,%s,%lu,%lu,%lu,%s\n", name, (unsigned long)esp->Frames,
+           (unsigned long)esp->RecordsSent, (unsigned long)check_log.Stats.Retransmits, ok ? "OK" : "FAIL");
+    if (!ok) {
+        check_failed = 1;
+    }
+}
+
+/* Deadband: one record, then only the 60 s heartbeat. Nothing may be sent twice
+ * while the ESP holds the records in its open average. */
+static void check_quiet_minute(void) {
+    Check_Esp_t esp = { 0 };
+
+    SLOG_Init(&check_log, 0, 0, NULL);
+    for (uint32_t t = CHECK_STEP_MS; t <= 150000u; t += CHECK_STEP_MS) {
+        if (t == 1000u || t == 61000u || t == 121000u) {
+            check_append(t);
+        }
+        check_step(&esp, t, 0, 0);
+    }
+    check_report("QuietMinute", &esp,
+                 esp.Frames == 3 && esp.Duplicates == 0 && check_log.Stats.Retransmits == 0 &&
+                 SLOG_Pending(&check_log) == 1);
+}
+
+/* Old ESP firmware without ReceivedSeq: holding the ack makes the STM32 resend
+ * every SLOG_RETRY_TIMEOUT, as before. Shows what the quiet minute would cost. */
+static void check_quiet_minute_legacy(void) {
+    Check_Esp_t esp = { 0 };
+
+    esp.Legacy = 1;
+    SLOG_Init(&check_log, 0, 0, NULL);
+    for (uint32_t t = CHECK_STEP_MS; t <= 150000u; t += CHECK_STEP_MS) {
+        if (t == 1000u || t == 61000u || t == 121000u) {
+            check_append(t);
+        }
+        check_step(&esp, t, 0, 0);
+    }
+    check_report("QuietMinuteLegacy", &esp,
+                 check_log.Stats.Retransmits > 0 && SLOG_Pending(&check_log) == 1);
+}
+
+/* A lost frame is sent again once SLOG_RETRY_TIMEOUT passes without progress */
+static void check_lost_frame(void) {
+    Check_Esp_t esp = { 0 };
+
+    SLOG_Init(&check_log, 0, 0, NULL);
+    for (uint32_t t = CHECK_STEP_MS; t <= 20000u; t += CHECK_STEP_MS) {
+        if (t % 500u == 0 && t <= 3000u) {
+            check_append(t);
+        }
+        check_step(&esp, t, t < 2500u, 0);
+    }
+    check_report("LostFrame", &esp,
+                 esp.Received == 6 && check_log.Stats.Retransmits == 1 && esp.Duplicates == 0);
+}
+
+/* A lost received ACK resends from the received point, not from the held records */
+static void check_lost_ack(void) {
+    Check_Esp_t esp = { 0 };
+
+    SLOG_Init(&check_log, 0, 0, NULL);
+    for (uint32_t t = CHECK_STEP_MS; t <= 20000u; t += CHECK_STEP_MS) {
+        if (t % 500u == 0 && t <= 6000u) {
+            check_append(t);
+        }
+        check_step(&esp, t, 0, t > 3500u && t < 6500u);
+    }
+    // Records 0..5 were received with an ACK, 6..11 without: only those come again
+    check_report("LostAck", &esp,
+                 esp.Received == 12 && check_log.Stats.Retransmits == 1 && esp.Duplicates == 6 &&
+                 esp.FirstSeq == 6);
+}
+
+/* The committed point releases records, SLOG_Ack ignores values outside [acked, head] */
+static void check_commit(void) {
+    Check_Esp_t esp = { 0 };
+
+    SLOG_Init(&check_log, 100, 100, NULL);
+    for (uint32_t i = 0; i < 10; i++) {
+        check_append(i);
+    }
+    check_step(&esp, 1000u, 1, 0);
+    SLOG_Ack(&check_log, 104, 110, 1000u);
+    const int held = SLOG_Oldest(&check_log) == 104 && SLOG_Pending(&check_log) == 6;
+    SLOG_Ack(&check_log, 50, 200, 2000u);
+    const int stale = SLOG_Oldest(&check_log) == 104;
+    SLOG_Ack(&check_log, 110, 110, 3000u);
+    check_report("Commit", &esp, held && stale && SLOG_Pending(&check_log) == 0 &&
+                 check_log.Stats.Retransmits == 0);
+}
+
+int main(void) {
+    check_quiet_minute();
+    check_quiet_minute_legacy();
+    check_lost_frame();
+    check_lost_ack();
+    check_commit();
+    return check_failed ? 1 : 0;
+}
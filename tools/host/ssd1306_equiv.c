@@ -0,0 +1,187 @@
+/*
+ * Page-at-a-time drawing against per-pixel references
+ *
+ * ssd1306_FillRectangle, ssd1306_DrawBitmap and ssd1306_DrawBitmapPaged
+ * write whole page bytes. Here they run on random rectangles and bitmaps,
+ * partly off screen, next to a reference that sets one pixel at a time in
+ * a separate buffer, as the library did before. Every call is followed by
+ * a compare of the two buffers, and every few calls the screen is flushed
+ * to check that the dirty tracking sent every changed byte to the panel.
+ *
+ * The references clip at the screen edge. The old DrawBitmap passed x + i
+ * to DrawPixel as uint8_t, so columns past 255 wrapped around to the left;
+ * that is not reproduced.
+ *
+ *   ssd1306_equiv [iterations] [seed]
+ *
+ * Exits with 1 on the first mismatch.
+ */
+
+#include "ssd1306.h"
+#include "ssd1306_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EQUIV_BUFFER_SIZE   (SSD1306_WIDTH * SSD1306_HEIGHT / 8)
+#define EQUIV_BITMAP_MAX    (32 * 256)      // 255 x 255 bits, either layout
+#define EQUIV_FLUSH_EVERY   16
+
+static uint8_t equiv_ref[EQUIV_BUFFER_SIZE];
+static uint8_t equiv_bitmap[EQUIV_BITMAP_MAX];
+static uint32_t equiv_state;
+
+static uint32_t equiv_rand(void) {
+    equiv_state ^= equiv_state << 13;
+    equiv_state ^= equiv_state >> 17;
+    equiv_state ^= equiv_state << 5;
+    return equiv_state;
+}
+
+// Mostly on or just past the screen, sometimes anywhere in 0..255
+static uint8_t equiv_coord(uint16_t limit) {
+    return (uint8_t)(equiv_rand() % 4 ? equiv_rand() % (limit + 12) : equiv_rand() % 256);
+}
+
+static uint8_t equiv_size(uint16_t limit) {
+    return (uint8_t)(equiv_rand() % 4 ? equiv_rand() % (limit + 1) : equiv_rand() % 256);
+}
+
+static void equiv_random_bitmap(size_t len) {
+    // Zero bytes are a separate path in DrawBitmap, make them common
+    for (size_t i = 0; i < len; i++) {
+        equiv_bitmap[i] = (equiv_rand() % 3) ? (uint8_t)equiv_rand() : 0;
+    }
+}
+
+/* References: one pixel at a time */
+
+static void equiv_ref_pixel(int x, int y, SSD1306_COLOR color) {
+    if (x < 0 || x >= SSD1306_WIDTH || y < 0 || y >= SSD1306_HEIGHT) {
+        return;
+    }
+    if (color == White) {
+        equiv_ref[x + (y / 8) * SSD1306_WIDTH] |= 1 << (y % 8);
+    } else {
+        equiv_ref[x + (y / 8) * SSD1306_WIDTH] &= ~(1 << (y % 8));
+    }
+}
+
+static void equiv_ref_fill_rectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color) {
+    const int x_start = (x1 <= x2) ? x1 : x2;
+    const int x_end = (x1 <= x2) ? x2 : x1;
+    const int y_start = (y1 <= y2) ? y1 : y2;
+    const int y_end = (y1 <= y2) ? y2 : y1;
+
+    for (int y = y_start; y <= y_end; y++) {
+        for (int x = x_start; x <= x_end; x++) {
+            equiv_ref_pixel(x, y, color);
+        }
+    }
+}
+
+static void equiv_ref_draw_bitmap(uint8_t x, uint8_t y, const uint8_t* bitmap, uint8_t w, uint8_t h, SSD1306_COLOR color) {
+    const int byte_width = (w + 7) / 8;
+
+    if (x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT) {
+        return;
+    }
+    for (int j = 0; j < h; j++) {
+        for (int i = 0; i < w; i++) {
+            if (bitmap[j * byte_width + i / 8] & (0x80 >> (i % 8))) {
+                equiv_ref_pixel(x + i, y + j, color);
+            }
+        }
+    }
+}
+
+static void equiv_ref_draw_bitmap_paged(uint8_t x, uint8_t y, const uint8_t* pages, uint8_t w, uint8_t h, SSD1306_COLOR color) {
+    const SSD1306_COLOR background = (color == White) ? Black : White;
+
+    if (x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT) {
+        return;
+    }
+    for (int j = 0; j < h; j++) {
+        for (int i = 0; i < w; i++) {
+            const uint8_t on = (pages[(j / 8) * w + i] >> (j % 8)) & 1;
+            equiv_ref_pixel(x + i, y + j, on ? color : background);
+        }
+    }
+}
+
+/* One random call on both sides */
+
+static void equiv_step(char* what, size_t size) {
+    const SSD1306_COLOR color = (equiv_rand() & 1) ? White : Black;
+    const uint32_t op = equiv_rand() % 16;
+
+    if (op < 6) {
+        const uint8_t x1 = equiv_coord(SSD1306_WIDTH), y1 = equiv_coord(SSD1306_HEIGHT);
+        const uint8_t x2 = equiv_coord(SSD1306_WIDTH), y2 = equiv_coord(SSD1306_HEIGHT);
+        snprintf(what, size, "FillRectangle(%u, %u, %u, %u, %d)", x1, y1, x2, y2, color);
+        ssd1306_FillRectangle(x1, y1, x2, y2, color);
+        equiv_ref_fill_rectangle(x1, y1, x2, y2, color);
+    } else if (op < 11) {
+        const uint8_t x = equiv_coord(SSD1306_WIDTH), y = equiv_coord(SSD1306_HEIGHT);
+        const uint8_t w = equiv_size(SSD1306_WIDTH), h = equiv_size(SSD1306_HEIGHT);
+        equiv_random_bitmap((size_t)((w + 7) / 8) * h);
+        snprintf(what, size, "DrawBitmap(%u, %u, %u x %u, %d)", x, y, w, h, color);
+        ssd1306_DrawBitmap(x, y, equiv_bitmap, w, h, color);
+        equiv_ref_draw_bitmap(x, y, equiv_bitmap, w, h, color);
+    } else if (op < 15) {
+        const uint8_t x = equiv_coord(SSD1306_WIDTH), y = equiv_coord(SSD1306_HEIGHT);
+        const uint8_t w = equiv_size(SSD1306_WIDTH), h = equiv_size(SSD1306_HEIGHT);
+        equiv_random_bitmap((size_t)w * ((h + 7) / 8));
+        snprintf(what, size, "DrawBitmapPaged(%u, %u, %u x %u, %d)", x, y, w, h, color);
+        ssd1306_DrawBitmapPaged(x, y, equiv_bitmap, w, h, color);
+        equiv_ref_draw_bitmap_paged(x, y, equiv_bitmap, w, h, color);
+    } else {
+        // Start over now and then, so both colors draw on mixed content
+        snprintf(what, size, "Fill(%d)", color);
+        ssd1306_Fill(color);
+        memset(equiv_ref, color == White ? 0xFF : 0x00, sizeof(equiv_ref));
+    }
+}
+
+static int equiv_report(const char* where, uint32_t n, const char* what, const uint8_t* got) {
+    for (size_t i = 0; i < EQUIV_BUFFER_SIZE; i++) {
+        if (got[i] != equiv_ref[i]) {
+            printf("%s differs after call %lu, %s: x %u page %u is 0x%02x, expected 0x%02x\n",
+                   where, (unsigned long)n, what, (unsigned)(i % SSD1306_WIDTH),
+                   (unsigned)(i / SSD1306_WIDTH), got[i], equiv_ref[i]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 200000u;
+    equiv_state = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 0x2545F491u;
+    char what[64];
+
+    if (equiv_state == 0) {
+        equiv_state = 1;
+    }
+
+    ssd1306_HostReset();
+    ssd1306_Init();
+    memset(equiv_ref, 0, sizeof(equiv_ref));
+
+    for (uint32_t n = 1; n <= iterations; n++) {
+        equiv_step(what, sizeof(what));
+        if (equiv_report("Screenbuffer", n, what, ssd1306_GetBuffer())) {
+            return 1;
+        }
+        if (n % EQUIV_FLUSH_EVERY == 0) {
+            ssd1306_UpdateScreen();
+            if (equiv_report("Panel", n, what, ssd1306_HostGetRAM())) {
+                return 1;
+            }
+        }
+    }
+
+    printf("EQUIV,%lu,OK\n", (unsigned long)iterations);
+    return 0;
+}
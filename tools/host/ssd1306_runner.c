@@ -0,0 +1,209 @@
+/*
+ * SSD1306 screens on the host
+ *
+ * Runs the library tests and the OLED dashboard against the emulated panel
+ * of ssd1306_host.c, writes what the panel shows as PBM and compares it with
+ * the checked-in image of the same name:
+ *
+ *   ssd1306_runner <golden dir> <output dir> [--update]
+ *
+ * One line per screen:
+ *
+ *   SCREEN,<name>,<transactions>,<bus bytes>,<OK|DIFF|MISSING|UPDATED>
+ *
+ * Bus figures count everything the screen put on the I2C bus, from a panel
+ * that already shows the previous screen of the same group. --update copies
+ * the new images over the golden ones; review them before committing.
+ *
+ * Exits with 1 if any screen differs from its golden image.
+ */
+
+#include "ssd1306.h"
+#include "ssd1306_host.h"
+#include "ssd1306_tests.h"
+#include "dashboard.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RUNNER_PATH_MAX     512
+#define RUNNER_PBM_MAX      2048
+
+static const char* runner_golden;
+static const char* runner_output;
+static int runner_update;
+static int runner_failed;
+
+static long runner_read(const char* path, uint8_t* buf, size_t size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return -1;
+    }
+    const size_t n = fread(buf, 1, size, f);
+    fclose(f);
+    return (long)n;
+}
+
+static int runner_write(const char* path, const uint8_t* buf, size_t len) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+    const size_t n = fwrite(buf, 1, len, f);
+    return (fclose(f) == 0 && n == len) ? 0 : -1;
+}
+
+/* Writes the panel image and checks it against the golden one */
+static void runner_check(const char* name) {
+    static uint8_t image[RUNNER_PBM_MAX];
+    static uint8_t golden[RUNNER_PBM_MAX];
+    char path[RUNNER_PATH_MAX];
+    SSD1306_HostBusStats_t stats;
+    const char* result;
+
+    ssd1306_HostGetBusStats(&stats);
+
+    snprintf(path, sizeof(path), "%s/%s.pbm", runner_output, name);
+    if (ssd1306_HostWritePBM(path) != 0) {
+        fprintf(stderr, "cannot write %s\n", path);
+        exit(2);
+    }
+    const long len = runner_read(path, image, sizeof(image));
+
+    snprintf(path, sizeof(path), "%s/%s.pbm", runner_golden, name);
+    if (runner_update) {
+        if (runner_write(path, image, (size_t)len) != 0) {
+            fprintf(stderr, "cannot write %s\n", path);
+            exit(2);
+        }
+        result = "UPDATED";
+    } else {
+        const long golden_len = runner_read(path, golden, sizeof(golden));
+        if (golden_len < 0) {
+            result = "MISSING";
+            runner_failed = 1;
+        } else if (golden_len != len || memcmp(golden, image, (size_t)len) != 0) {
+            result = "DIFF";
+            runner_failed = 1;
+        } else {
+            result = "OK";
+        }
+    }
+
+    printf("SCREEN,%s,%lu,%lu,%s\n", name,
+           (unsigned long)stats.Transactions, (unsigned long)stats.BusBytes, result);
+    ssd1306_HostResetBusStats();
+}
+
+/* Library tests, each from a freshly initialised panel */
+
+typedef struct {
+    const char* Name;
+    void (*Run)(void);
+} Runner_Test_t;
+
+// ssd1306_TestFPS, _TestFrameTime and _TestBenchmark draw wall clock timings
+static const Runner_Test_t runner_tests[] = {
+    { "TestBorder",             ssd1306_TestBorder },
+    { "TestFonts1",             ssd1306_TestFonts1 },
+    { "TestFonts2",             ssd1306_TestFonts2 },
+    { "TestFonts3",             ssd1306_TestFonts3 },
+    { "TestLine",               ssd1306_TestLine },
+    { "TestRectangle",          ssd1306_TestRectangle },
+    { "TestRectangleFill",      ssd1306_TestRectangleFill },
+    { "TestRectangleInvert",    ssd1306_TestRectangleInvert },
+    { "TestCircle",             ssd1306_TestCircle },
+    { "TestArc",                ssd1306_TestArc },
+    { "TestGauge",              ssd1306_TestGauge },
+    { "TestPolyline",           ssd1306_TestPolyline },
+    { "TestDrawBitmap",         ssd1306_TestDrawBitmap },
+    { "TestBehoa",              ssd1306_TestBehoa },
+};
+
+static void runner_start(void) {
+    ssd1306_HostReset();
+    ssd1306_Init();
+    ssd1306_HostResetBusStats();
+}
+
+static void runner_run_tests(void) {
+    for (size_t i = 0; i < sizeof(runner_tests) / sizeof(runner_tests[0]); i++) {
+        runner_start();
+        runner_tests[i].Run();
+        ssd1306_UpdateScreen();
+        runner_check(runner_tests[i].Name);
+    }
+}
+
+/* Dashboard, the same layout and rendering as the firmware */
+
+static void runner_dashboard_step(DASH_Data* dash, const char* name, uint8_t events,
+                                  const DASH_Readings* readings) {
+    DASH_Render(dash, events, readings);
+    ssd1306_UpdateScreen();
+    runner_check(name);
+}
+
+static void runner_run_dashboard(void) {
+    static DASH_Data dash;
+    DASH_Readings readings = { 0 };
+
+    runner_start();
+    DASH_Init(&dash);
+    ssd1306_UpdateScreen();
+    runner_check("DashboardInit");
+
+    // Four minutes of readings: DHT11 every 2 s, MQ2 every second
+    for (uint32_t t = 0; t < 240; t++) {
+        if (t % 2 == 0) {
+            DASH_PushTemperature(&dash, 24.0f + (float)(t % 40) * 0.1f);
+        }
+        DASH_PushGas(&dash, 180.0f + (float)((t * 7) % 150));
+    }
+    readings.Climate = DASH_CLIMATE_OK;
+    readings.Temperature = 25.3f;
+    readings.Humidity = 60.2f;
+    readings.GasOk = 1;
+    readings.Gas = 245.0f;
+    readings.GasLevel = 0;
+    runner_dashboard_step(&dash, "DashboardReadings", DASH_EVENT_ALL, &readings);
+
+    // One new gas reading only repaints the gas row and its plot
+    DASH_PushGas(&dash, 252.0f);
+    readings.Gas = 252.0f;
+    runner_dashboard_step(&dash, "DashboardGas", DASH_EVENT_GAS, &readings);
+
+    for (uint8_t i = 0; i < DASH_TREND_GAS_DECIMATION; i++) {
+        DASH_PushGas(&dash, 1250.0f);
+    }
+    readings.Gas = 1250.0f;
+    readings.GasLevel = 2;
+    runner_dashboard_step(&dash, "DashboardAlarm", DASH_EVENT_GAS | DASH_EVENT_ALARM, &readings);
+
+    // Shorted or saturated MQ2: far above the int16_t history range, the plot stays at the top
+    for (uint8_t i = 0; i < DASH_TREND_GAS_DECIMATION; i++) {
+        DASH_PushGas(&dash, 100000.0f);
+    }
+    readings.Gas = 100000.0f;
+    runner_dashboard_step(&dash, "DashboardOverrange", DASH_EVENT_GAS | DASH_EVENT_ALARM, &readings);
+
+    readings.Climate = DASH_CLIMATE_ERROR;
+    readings.GasOk = 0;
+    runner_dashboard_step(&dash, "DashboardError", DASH_EVENT_ALL, &readings);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3 || (argc == 4 && strcmp(argv[3], "--update") != 0) || argc > 4) {
+        fprintf(stderr, "usage: %s <golden dir> <output dir> [--update]\n", argv[0]);
+        return 2;
+    }
+    runner_golden = argv[1];
+    runner_output = argv[2];
+    runner_update = (argc == 4);
+
+    runner_run_tests();
+    runner_run_dashboard();
+
+    return runner_failed ? 1 : 0;
+}
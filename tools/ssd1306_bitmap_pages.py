@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""
+Convert a bitmap into the SSD1306 page format for ssd1306_DrawBitmapPaged.
+
+The panel stores 8 vertical pixels per byte. The output splits the image
+into ceil(height / 8) bands, each stored as one byte per column with bit 0
+holding the top row of the band:
+
+    pages[band * width + column]
+
+The input is either a PBM image (P1 or P4; black pixels, which PBM stores
+as 1, become lit pixels) or a horizontal, MSB-first array from a C file,
+as LCD Assistant and image2cpp write them for ssd1306_DrawBitmap:
+
+    python3 tools/ssd1306_bitmap_pages.py logo.pbm -n logo_pages
+    python3 tools/ssd1306_bitmap_pages.py Core/Src/ssd1306_tests.c \\
+        --array github_logo_64x64 --size 64x64
+"""
+
+import argparse
+import os
+import re
+import sys
+
+
+def read_pbm(path):
+    """PBM file to (width, height, rows of 0/1)."""
+    with open(path, "rb") as f:
+        data = f.read()
+
+    tokens = []
+    pos = 0
+    # Magic, width and height, skipping comments
+    while len(tokens) < 3:
+        m = re.compile(rb"\s*(#[^\n]*\n\s*)*(\S+)").match(data, pos)
+        if not m:
+            sys.exit("%s: truncated PBM header" % path)
+        tokens.append(m.group(2))
+        pos = m.end()
+    magic, width, height = tokens[0], int(tokens[1]), int(tokens[2])
+
+    if magic == b"P4":
+        pos += 1                                # Single whitespace before the raster
+        stride = (width + 7) // 8
+        raster = data[pos:pos + stride * height]
+        if len(raster) < stride * height:
+            sys.exit("%s: truncated PBM raster" % path)
+        rows = [[(raster[y * stride + x // 8] >> (7 - x % 8)) & 1 for x in range(width)]
+                for y in range(height)]
+    elif magic == b"P1":
+        bits = [int(b) for b in re.findall(rb"[01]", data[pos:])]
+        if len(bits) < width * height:
+            sys.exit("%s: truncated PBM raster" % path)
+        rows = [bits[y * width:(y + 1) * width] for y in range(height)]
+    else:
+        sys.exit("%s: only P1 and P4 PBM files are supported" % path)
+    return width, height, rows
+
+
+def read_c_array(path, name, width, height):
+    """Horizontal MSB-first C array to rows of 0/1."""
+    with open(path) as f:
+        source = f.read()
+    m = re.search(r"\b%s\s*\[\s*\d*\s*\]\s*=\s*\{(.*?)\};" % re.escape(name), source, re.S)
+    if not m:
+        sys.exit("array %s not found in %s" % (name, path))
+    body = re.sub(r"/\*.*?\*/|//[^\n]*", "", m.group(1), flags=re.S)
+    data = [int(v, 0) for v in re.findall(r"0[xX][0-9A-Fa-f]+|\d+", body)]
+
+    stride = (width + 7) // 8
+    if len(data) < stride * height:
+        sys.exit("array %s has %d bytes, %dx%d needs %d" % (name, len(data), width, height, stride * height))
+    return [[(data[y * stride + x // 8] >> (7 - x % 8)) & 1 for x in range(width)]
+            for y in range(height)]
+
+
+def to_pages(rows, width, height):
+    out = []
+    for band in range((height + 7) // 8):
+        for col in range(width):
+            byte = 0
+            for bit in range(8):
+                y = band * 8 + bit
+                if y < height and rows[y][col]:
+                    byte |= 1 << bit
+            out.append(byte)
+    return out
+
+
+def render(name, pages, width, height, source):
+    lines = [
+        "// %dx%d, from %s by tools/ssd1306_bitmap_pages.py" % (width, height, source),
+        "const unsigned char %s[] = {" % name,
+    ]
+    for band in range((height + 7) // 8):
+        row = pages[band * width:(band + 1) * width]
+        for i in range(0, width, 16):
+            lines.append("    " + ", ".join("0x%02X" % b for b in row[i:i + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("input", help="PBM image, or C file with --array")
+    parser.add_argument("-n", "--name", help="C array name (default: from the input)")
+    parser.add_argument("-a", "--array", help="read this horizontal array from a C file")
+    parser.add_argument("-s", "--size", help="WxH of --array")
+    parser.add_argument("-o", "--output", help="file to write (default: stdout)")
+    args = parser.parse_args()
+
+    if args.array:
+        if not args.size or not re.match(r"^\d+x\d+$", args.size):
+            sys.exit("--array needs --size WxH")
+        width, height = (int(v) for v in args.size.split("x"))
+        rows = read_c_array(args.input, args.array, width, height)
+        name = args.name or args.array + "_pages"
+        source = args.array
+    else:
+        width, height, rows = read_pbm(args.input)
+        name = args.name or re.sub(r"\W", "_", os.path.splitext(os.path.basename(args.input))[0]) + "_pages"
+        source = os.path.basename(args.input)
+
+    if width > 255 or height > 255:
+        sys.exit("bitmaps are limited to 255x255")
+
+    text = render(name, to_pages(rows, width, height), width, height, source)
+    if args.output:
+        with open(args.output, "w", newline="\n") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()
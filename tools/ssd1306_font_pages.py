@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Convert the row-major fonts of Core/Src/ssd1306_fonts.c into page-aligned
+column bytes for the fast glyph blitter in ssd1306_WriteChar.
+
+In the source fonts every glyph row is a uint16_t and bit 15 is the
+leftmost pixel. The SSD1306 RAM stores 8 vertical pixels per byte, so the
+output splits each glyph into ceil(height / 8) bands. Each band is stored
+as one byte per column, with bit 0 holding the top row of the band:
+
+    data[((ch - 32) * bands + band) * width + column]
+
+Run it again whenever a font in ssd1306_fonts.c changes:
+
+    python3 tools/ssd1306_font_pages.py
+"""
+
+import argparse
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_INPUT = os.path.join(ROOT, "Core", "Src", "ssd1306_fonts.c")
+DEFAULT_OUTPUT = os.path.join(ROOT, "Core", "Src", "ssd1306_fonts_paged.c")
+
+ARRAY_RE = re.compile(r"static\s+const\s+uint16_t\s+(\w+)\s*\[\]\s*=\s*\{(.*?)\};", re.S)
+FONT_RE = re.compile(r"const\s+SSD1306_Font_t\s+(Font_(\w+))\s*=\s*\{\s*(\d+)\s*,\s*(\d+)\s*,\s*(\w+)\s*,")
+FIRST_CHAR = 32
+
+
+def strip_comments(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    return re.sub(r"//[^\n]*", "", text)
+
+
+def parse_fonts(source):
+    arrays = {}
+    for name, body in ARRAY_RE.findall(source):
+        arrays[name] = [int(v, 16) for v in re.findall(r"0x[0-9A-Fa-f]+", strip_comments(body))]
+
+    fonts = []
+    for font, size, width, height, array in FONT_RE.findall(source):
+        if array not in arrays:
+            sys.exit("font data %s of %s not found" % (array, font))
+        fonts.append({
+            "font": font,
+            "guard": "SSD1306_INCLUDE_FONT_" + size,
+            "array": array,
+            "width": int(width),
+            "height": int(height),
+            "rows": arrays[array],
+        })
+    return fonts
+
+
+def glyph_pages(rows, width, height):
+    """One glyph (height rows of 16 bits) to bands of column bytes."""
+    out = []
+    for band in range((height + 7) // 8):
+        for col in range(width):
+            byte = 0
+            for bit in range(8):
+                y = band * 8 + bit
+                if y < height and (rows[y] << col) & 0x8000:
+                    byte |= 1 << bit
+            out.append(byte)
+    return out
+
+
+def render(fonts, input_name):
+    lines = [
+        "/*",
+        " * Page-aligned column bytes of the fonts in %s." % input_name,
+        " * Generated by tools/ssd1306_font_pages.py, do not edit.",
+        " */",
+        "",
+        '#include "ssd1306_fonts.h"',
+        "",
+    ]
+    for f in fonts:
+        width, height = f["width"], f["height"]
+        glyphs = len(f["rows"]) // height
+        lines.append("#ifdef %s" % f["guard"])
+        lines.append("const uint8_t %s_Pages [] = {" % f["array"])
+        for g in range(glyphs):
+            data = glyph_pages(f["rows"][g * height:(g + 1) * height], width, height)
+            ch = chr(FIRST_CHAR + g)
+            # A trailing backslash would splice the next line into the comment
+            label = {" ": "sp", "\\": "backslash"}.get(ch, ch)
+            lines.append(",".join("0x%02X" % b for b in data) + ",  // " + label)
+        lines.append("};")
+        lines.append("#endif")
+        lines.append("")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("-i", "--input", default=DEFAULT_INPUT, help="ssd1306_fonts.c to read")
+    parser.add_argument("-o", "--output", default=DEFAULT_OUTPUT, help="C file to write")
+    args = parser.parse_args()
+
+    with open(args.input) as f:
+        fonts = parse_fonts(f.read())
+    if not fonts:
+        sys.exit("no fonts found in " + args.input)
+
+    with open(args.output, "w", newline="\n") as f:
+        f.write(render(fonts, os.path.basename(args.input)))
+    for font in fonts:
+        print("%-12s %2dx%-2d -> %d bytes" % (font["font"], font["width"], font["height"],
+              len(font["rows"]) // font["height"] * font["width"] * ((font["height"] + 7) // 8)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,320 @@
+#!/usr/bin/env python3
+"""
+Build a font holding only the characters a UI draws, with Vietnamese letters.
+
+Takes one font of Core/Src/ssd1306_fonts.c and keeps the glyphs of the
+characters given with --chars and --chars-from, in the page format of
+tools/ssd1306_font_pages.py. The glyphs are listed by code point in a
+sorted table, which ssd1306_WriteString looks up after decoding UTF-8:
+
+    page_data[(index * bands + band) * width + column]
+
+Letters that are not in the source font are composed from their base
+letter (unicodedata NFD) and the marks below, drawn into the blank rows
+above and below the base, which is moved down if the top rows are short.
+A letter that does not fit into the cell is an error.
+
+    grave, acute, hook above, tilde     huyen, sac, hoi, nga
+    dot below                           nang
+    circumflex, breve, horn             a^ e^ o^, a(, o+ u+
+    stroke                              Dd
+
+Run it again whenever the strings of the UI change:
+
+    python3 tools/ssd1306_font_subset.py --font Font_7x10 --name Font_7x10_Dash \\
+        --chars-from tools/fonts/dashboard.txt -o Core/Src/ssd1306_fonts_dash.c
+"""
+
+import argparse
+import os
+import re
+import sys
+import unicodedata
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from ssd1306_font_pages import DEFAULT_INPUT, FIRST_CHAR, parse_fonts, strip_comments  # noqa: E402
+
+INITIALIZER_RE = re.compile(r"const\s+SSD1306_Font_t\s+(\w+)\s*=\s*\{([^}]*)\}")
+WIDTHS_RE = re.compile(r"static\s+const\s+uint8_t\s+(\w+)\s*\[\]\s*=\s*\{(.*?)\};", re.S)
+
+# Marks at scale 1, "#" is a lit pixel
+MARKS = {
+    "̀": ["#.", ".#"],             # Grave
+    "́": [".#", "#."],             # Acute
+    "̉": ["##", ".#"],             # Hook above
+    "̃": [".#.#", "#.#."],         # Tilde
+    "̂": [".#.", "#.#"],           # Circumflex
+    "̆": ["#.#", ".#."],           # Breve
+    "̣": ["#"],                    # Dot below
+}
+VOWEL_MARKS = ("̂", "̆")
+TONE_MARKS = ("̀", "́", "̉", "̃")
+HORN = "̛"
+DOT_BELOW = "̣"
+# Not decomposed by NFD: base letter and a stroke through the stem
+STROKED = {"Đ": "D", "đ": "d"}
+
+
+def font_widths(source, font):
+    """Per-glyph widths of a proportional font, None for monospaced ones."""
+    text = strip_comments(source)
+    m = next((m for m in INITIALIZER_RE.finditer(text) if m.group(1) == font), None)
+    fields = [f.strip() for f in m.group(2).split(",")] if m else []
+    if len(fields) < 4 or fields[3] == "NULL":
+        return None
+    for name, body in WIDTHS_RE.findall(text):
+        if name == fields[3]:
+            return [int(v, 0) for v in re.findall(r"0[xX][0-9A-Fa-f]+|\d+", body)]
+    sys.exit("widths %s of %s not found" % (fields[3], font))
+
+
+def glyph_pixels(font, index, width):
+    height = font["height"]
+    rows = font["rows"][index * height:(index + 1) * height]
+    return [[(row << x) & 0x8000 != 0 for x in range(width)] for row in rows]
+
+
+def scaled(mark, scale):
+    return [[c == "#" for c in line for _ in range(scale)] for line in mark for _ in range(scale)]
+
+
+def ink_box(pix):
+    """(top, bottom, left, right) of the lit pixels."""
+    rows = [y for y, row in enumerate(pix) if any(row)]
+    cols = [x for x in range(len(pix[0])) if any(row[x] for row in pix)]
+    return rows[0], rows[-1], cols[0], cols[-1]
+
+
+def paste(pix, mark, x, y):
+    for dy, row in enumerate(mark):
+        for dx, on in enumerate(row):
+            if on and 0 <= y + dy < len(pix) and 0 <= x + dx < len(pix[0]):
+                pix[y + dy][x + dx] = True
+
+
+def add_stroke(pix, base, scale):
+    """Bar through the stem of D or d."""
+    top, bottom, left, right = ink_box(pix)
+    counts = [sum(row[x] for row in pix) for x in range(len(pix[0]))]
+    stems = [x for x in range(left, right + 1) if counts[x] == max(counts)]
+    stem = stems[-1] if base == "d" else stems[0]
+    y = top + scale if base == "d" else (top + bottom) // 2
+    for x in range(max(0, stem - scale), min(len(pix[0]), stem + scale + 1)):
+        for dy in range(scale):
+            pix[y + dy][x] = True
+
+
+def compose(base_pix, base, marks, height, scale, label):
+    pix = [row[:] for row in base_pix]
+    width = len(pix[0])
+
+    above = [m for m in marks if m in VOWEL_MARKS] + [m for m in marks if m in TONE_MARKS]
+    below = DOT_BELOW in marks
+    if base in "ij" and above:
+        # The dot of i and j makes way for the tone mark
+        top = ink_box(pix)[0]
+        while any(pix[top]):
+            pix[top] = [False] * width
+            top += 1
+
+    top, bottom, left, right = ink_box(pix)
+    centre = (left + right + 1) // 2
+
+    # Marks above: vowel mark and tone side by side if they fit, else stacked
+    parts = [scaled(MARKS[m], scale) for m in above]
+    block = []
+    if len(parts) == 2 and len(parts[0][0]) + len(parts[1][0]) <= width:
+        tall = max(len(p) for p in parts)
+        block_w = len(parts[0][0]) + len(parts[1][0])
+        block = [[False] * block_w for _ in range(tall)]
+        paste(block, parts[0], 0, tall - len(parts[0]))
+        paste(block, parts[1], len(parts[0][0]), 0)
+    else:
+        for p in reversed(parts):
+            block_w = max(len(p[0]), len(block[0]) if block else 0)
+            block = [r + [False] * (block_w - len(r)) for r in p] + \
+                    [r + [False] * (block_w - len(r)) for r in block]
+    horn = HORN in marks
+
+    # Rows taken above and below the base. A blank row between the marks
+    # and the base is dropped before the base is moved off its baseline.
+    layouts = []
+    for gap_above in (scale, 0):
+        for gap_below in (scale, 0):
+            above_rows = len(block) + gap_above if block else (scale if horn else 0)
+            below_rows = scale + gap_below if below else 0
+            shift = max(0, above_rows - top)
+            if bottom + shift + below_rows < height:
+                layouts.append((shift, -gap_above, -gap_below, above_rows, below_rows))
+    if not layouts:
+        sys.exit("%s does not fit into the %d rows of the font" % (label, height))
+    shift, _, _, need_above, need_below = min(layouts)
+
+    # Move the base down if the rows above are short
+    if shift:
+        pix = [[False] * width for _ in range(shift)] + pix[:height - shift]
+        top += shift
+        bottom += shift
+
+    if block:
+        x = min(max(0, centre - len(parts[0][0]) // 2), width - len(block[0]))
+        paste(pix, block, x, top - need_above)
+    if horn:
+        # Tail at the top right, beside the tone mark
+        x = min(right + 1, width - scale)
+        y = top - scale if top >= scale else top
+        paste(pix, [[True] * scale] * (2 * scale), x, y)
+    if below:
+        paste(pix, scaled(MARKS[DOT_BELOW], scale), centre - scale // 2, bottom + 1 + need_below - scale)
+    if label[0] in STROKED:
+        add_stroke(pix, base, scale)
+    return pix
+
+
+def build_glyph(font, widths, cp):
+    """(pixels, width) of a code point, composed if the font lacks it."""
+    ch = chr(cp)
+    glyphs = len(font["rows"]) // font["height"]
+    if FIRST_CHAR <= cp < FIRST_CHAR + glyphs:
+        width = widths[cp - FIRST_CHAR] if widths else font["width"]
+        return glyph_pixels(font, cp - FIRST_CHAR, width), width
+
+    label = "%s (U+%04X)" % (ch, cp)
+    if ch in STROKED:
+        base, marks = STROKED[ch], ""
+    else:
+        decomposed = unicodedata.normalize("NFD", ch)
+        base, marks = decomposed[0], decomposed[1:]
+        if not marks or not FIRST_CHAR <= ord(base) < FIRST_CHAR + glyphs:
+            sys.exit("%s is not in %s and cannot be composed" % (label, font["font"]))
+        unknown = [m for m in marks if m not in MARKS and m != HORN]
+        if unknown:
+            sys.exit("%s: mark U+%04X is not supported" % (label, ord(unknown[0])))
+
+    width = widths[ord(base) - FIRST_CHAR] if widths else font["width"]
+    scale = max(1, font["height"] // 12)
+    pix = compose(glyph_pixels(font, ord(base) - FIRST_CHAR, width), base, marks,
+                  font["height"], scale, label)
+    return pix, width
+
+
+def pixel_pages(pix, width, height):
+    out = []
+    for band in range((height + 7) // 8):
+        for x in range(width):
+            byte = 0
+            for bit in range(8):
+                y = band * 8 + bit
+                if y < height and x < len(pix[y]) and pix[y][x]:
+                    byte |= 1 << bit
+            out.append(byte)
+    return out
+
+
+def read_chars(args):
+    chars = set(args.chars or "")
+    for path in args.chars_from or []:
+        with open(path, encoding="utf-8") as f:
+            for line in f:
+                if not line.startswith("#"):
+                    chars.update(line.rstrip("\r\n"))
+    chars = {unicodedata.normalize("NFC", c) for c in chars}
+    for c in sorted(chars):
+        if ord(c) < FIRST_CHAR or ord(c) > 0xFFFF:
+            sys.exit("U+%04X cannot be drawn" % ord(c))
+    return sorted(chars)
+
+
+def render(font, name, guard, chars, glyphs, widths, source):
+    array = name.replace("Font_", "Font", 1)
+    lines = [
+        "/*",
+        " * %s: %d glyphs of %s for %s." % (name, len(chars), font["font"], source),
+        " * Generated by tools/ssd1306_font_subset.py, do not edit.",
+        " */",
+        "",
+        '#include "ssd1306_fonts.h"',
+        "",
+        "#ifdef %s" % guard,
+        "static const uint16_t %s_Codepoints[] = {" % array,
+    ]
+    for i in range(0, len(chars), 8):
+        lines.append("    " + ", ".join("0x%04X" % ord(c) for c in chars[i:i + 8]) + ",")
+    lines.append("};")
+    lines.append("")
+    lines.append("static const uint8_t %s_Pages[] = {" % array)
+    for c, (pix, width) in zip(chars, glyphs):
+        label = {" ": "sp", "\\": "backslash"}.get(c, c)
+        data = pixel_pages(pix, font["width"], font["height"])
+        lines.append(",".join("0x%02X" % b for b in data) + ",  // " + label)
+    lines.append("};")
+    if widths:
+        lines.append("")
+        lines.append("static const uint8_t %s_Widths[] = {" % array)
+        lines.append("    " + ", ".join(str(width) for _, width in glyphs) + ",")
+        lines.append("};")
+    lines.append("")
+    lines.append("const SSD1306_Font_t %s = {%d, %d, NULL, %s, %s_Pages, %s_Codepoints, %d};" % (
+        name, font["width"], font["height"], (array + "_Widths") if widths else "NULL",
+        array, array, len(chars)))
+    lines.append("#endif")
+    return "\n".join(lines) + "\n"
+
+
+def preview(chars, glyphs, height):
+    for c, (pix, width) in zip(chars, glyphs):
+        print("%s U+%04X" % (c, ord(c)))
+        for y in range(height):
+            print("  " + "".join("#" if pix[y][x] else "." for x in range(width)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("-i", "--input", default=DEFAULT_INPUT, help="ssd1306_fonts.c to read")
+    parser.add_argument("-f", "--font", required=True, help="source font, e.g. Font_7x10")
+    parser.add_argument("-n", "--name", required=True, help="name of the new font, e.g. Font_7x10_Dash")
+    parser.add_argument("-c", "--chars", help="characters to keep")
+    parser.add_argument("--chars-from", action="append",
+                        help="UTF-8 text file with the characters to keep, lines starting with # are skipped")
+    parser.add_argument("-o", "--output", help="C file to write (default: stdout)")
+    parser.add_argument("-p", "--preview", action="store_true", help="print the glyphs instead")
+    args = parser.parse_args()
+
+    m = re.match(r"^Font_(\w+?)_(\w+)$", args.name)
+    if not m:
+        sys.exit("--name must look like Font_<size>_<Suffix>")
+    guard = "SSD1306_INCLUDE_FONT_%s_%s" % (m.group(1), m.group(2).upper())
+
+    with open(args.input, encoding="utf-8") as f:
+        source = f.read()
+    font = next((f for f in parse_fonts(source) if f["font"] == args.font), None)
+    if not font:
+        sys.exit("%s not found in %s" % (args.font, args.input))
+    widths = font_widths(source, args.font)
+
+    chars = read_chars(args)
+    if not chars:
+        sys.exit("no characters given, use --chars or --chars-from")
+    glyphs = [build_glyph(font, widths, ord(c)) for c in chars]
+
+    if args.preview:
+        preview(chars, glyphs, font["height"])
+        return
+
+    described = ", ".join(os.path.basename(p) for p in args.chars_from or []) or "--chars"
+    text = render(font, args.name, guard, chars, glyphs, widths, described)
+    if args.output:
+        with open(args.output, "w", encoding="utf-8", newline="\n") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+    full = len(font["rows"]) // font["height"]
+    bands = (font["height"] + 7) // 8
+    print("%s: %d of %d glyphs, %d bytes (%s: %d bytes of rows + %d of pages)" % (
+        args.name, len(chars), full, len(chars) * (font["width"] * bands + 2),
+        args.font, len(font["rows"]) * 2, full * font["width"] * bands), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
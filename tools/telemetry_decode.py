@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+"""
+Decode the binary UART5 telemetry of the STM32 (Core/Inc/telemetry.h).
+
+Every frame is COBS(payload | CRC16) followed by 0x00. The payload starts
+with a header byte, protocol version in the high nibble and frame type in
+the low nibble. Records of BATCH frames (and legacy SAMPLE frames) are
+printed as CSV, one row per record; text, ACK and STATS frames as "# ..."
+comment lines. Captures of protocol version 1 (the STM32 before BootSeq was
+added to STATS) still decode. Retransmitted records are printed once:
+
+    seq,time_ms,temp_c,humidity,gas_ppm,dht11_ok,mq2_ok,mq2_cal,level
+
+Read a capture file, stdin, or a serial port (needs pyserial):
+
+    python3 tools/telemetry_decode.py capture.bin
+    python3 tools/telemetry_decode.py --port /dev/ttyUSB0 --baud 115200
+"""
+
+import argparse
+import struct
+import sys
+
+PROTOCOL_VERSION = 2
+VERSIONS = (1, PROTOCOL_VERSION)  # Decodable, BATCH and SAMPLE are the same in both
+TYPE_SAMPLE = 0x1
+TYPE_ACK = 0x3
+TYPE_STATS = 0x4
+TYPE_BATCH = 0x5
+TYPE_TEXT = 0xF
+
+FLAG_DHT11_OK = 0x01
+FLAG_MQ2_OK = 0x02
+FLAG_MQ2_CAL = 0x04
+BATCH_OLDEST = 0x01
+LEVELS = ("NORMAL", "WARNING", "DANGER")
+
+SAMPLE = struct.Struct("<BHIBhBH")
+BATCH = struct.Struct("<BIBB")
+RECORD = struct.Struct("<IBhBH")
+ACK = struct.Struct("<BBBB")
+STATS = struct.Struct("<BBIHHHIIIIIIIIII")
+STATS_V1 = struct.Struct("<BBIHHHIIIIIII")
+STATUS = ("OK", "UNKNOWN", "BAD_ARG", "BUSY")
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as TELEM_Crc16."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        i += 1
+        if code == 0 or i + code - 1 > len(data):
+            raise ValueError("bad COBS block")
+        out += data[i:i + code - 1]
+        i += code - 1
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def decode_frame(frame):
+    """Payload of one frame (without the 0x00), or raise ValueError."""
+    raw = cobs_decode(frame)
+    if len(raw) < 3:
+        raise ValueError("frame too short")
+    payload, crc = raw[:-2], raw[-2] | raw[-1] << 8
+    if crc16(payload) != crc:
+        raise ValueError("CRC mismatch")
+    return payload
+
+
+def record_row(seq, time_ms, flags, temp, humidity, gas):
+    level = (flags >> 4) & 0x03
+    return "%d,%d,%.1f,%d,%d,%d,%d,%d,%s" % (
+        seq, time_ms, temp / 10.0, humidity, gas,
+        bool(flags & FLAG_DHT11_OK), bool(flags & FLAG_MQ2_OK), bool(flags & FLAG_MQ2_CAL),
+        LEVELS[level] if level < len(LEVELS) else level)
+
+
+def batch_records(payload):
+    """(first_seq, batch_flags, records) of a BATCH payload, or None if malformed."""
+    if len(payload) < BATCH.size:
+        return None
+    _, first_seq, count, batch_flags = BATCH.unpack_from(payload)
+    if count == 0 or len(payload) != BATCH.size + count * RECORD.size:
+        return None
+    records = [RECORD.unpack_from(payload, BATCH.size + i * RECORD.size) for i in range(count)]
+    return first_seq, batch_flags, records
+
+
+def describe(payload):
+    version, ftype = payload[0] >> 4, payload[0] & 0x0F
+    if version not in VERSIONS:
+        return "# unknown protocol version %d" % version
+    if ftype == TYPE_TEXT:
+        return "# " + payload[1:].decode("utf-8", "replace").rstrip("\r\n")
+    if ftype == TYPE_SAMPLE and len(payload) == SAMPLE.size:
+        _, seq, time_ms, flags, temp, humidity, gas = SAMPLE.unpack(payload)
+        return record_row(seq, time_ms, flags, temp, humidity, gas)
+    if ftype == TYPE_ACK and len(payload) == ACK.size:
+        _, seq, opcode, status = ACK.unpack(payload)
+        return "# ack seq=%d opcode=0x%02X %s" % (seq, opcode, STATUS[status] if status < len(STATUS) else status)
+    if ftype == TYPE_STATS and version == PROTOCOL_VERSION and len(payload) == STATS.size:
+        (_, seq, uptime, dht_ms, mq2_ms, uart_ms, reads, read_errors,
+         tx, tx_dropped, tx_errors, rx, rx_errors, boot_seq, readings, suppressed) = STATS.unpack(payload)
+        return ("# stats seq=%d uptime=%ds intervals=%d/%d/%dms dht11=%d/%d errors "
+                "tx=%d dropped=%d errors=%d rx=%d errors=%d boot_seq=%d readings=%d suppressed=%d (%.0f%%)" % (
+                    seq, uptime // 1000, dht_ms, mq2_ms, uart_ms, reads, read_errors,
+                    tx, tx_dropped, tx_errors, rx, rx_errors, boot_seq, readings, suppressed,
+                    100.0 * suppressed / readings if readings else 0.0))
+    # Version 1 firmware also sent 44 and 52 byte STATS under the same header: print the common part
+    if ftype == TYPE_STATS and version == 1 and len(payload) >= STATS_V1.size:
+        (_, seq, uptime, dht_ms, mq2_ms, uart_ms, reads, read_errors,
+         tx, tx_dropped, tx_errors, rx, rx_errors) = STATS_V1.unpack_from(payload)
+        return ("# stats v1 seq=%d uptime=%ds intervals=%d/%d/%dms dht11=%d/%d errors "
+                "tx=%d dropped=%d errors=%d rx=%d errors=%d, %d bytes" % (
+                    seq, uptime // 1000, dht_ms, mq2_ms, uart_ms, reads, read_errors,
+                    tx, tx_dropped, tx_errors, rx, rx_errors, len(payload)))
+    return "# unknown frame type %d, %d bytes" % (ftype, len(payload))
+
+
+def frames(stream):
+    """Bytes between 0x00 delimiters, read as they arrive."""
+    buf = bytearray()
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            break
+        if chunk[0] == 0:
+            if buf:
+                yield bytes(buf)
+            buf.clear()
+        else:
+            buf += chunk
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("input", nargs="?", help="capture file (default: stdin)")
+    parser.add_argument("-p", "--port", help="serial port to read instead")
+    parser.add_argument("-b", "--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    if args.port:
+        import serial  # pyserial
+        stream = serial.Serial(args.port, args.baud)
+    elif args.input:
+        stream = open(args.input, "rb")
+    else:
+        stream = sys.stdin.buffer
+
+    print("seq,time_ms,temp_c,humidity,gas_ppm,dht11_ok,mq2_ok,mq2_cal,level")
+    good = bad = 0
+    last_seq = None
+    next_seq = None
+    for frame in frames(stream):
+        try:
+            payload = decode_frame(frame)
+        except ValueError as e:
+            bad += 1
+            print("# dropped %d bytes: %s" % (len(frame), e), file=sys.stderr)
+            continue
+        good += 1
+        version, ftype = payload[0] >> 4, payload[0] & 0x0F
+        batch = batch_records(payload) if version in VERSIONS and ftype == TYPE_BATCH else None
+        if batch:
+            first_seq, batch_flags, records = batch
+            if first_seq == 0 or next_seq is None:
+                next_seq = first_seq  # first batch seen, or the STM32 restarted
+            if first_seq > next_seq:
+                # The gap is final only when the sender no longer holds the records,
+                # otherwise an earlier frame was lost and will be sent again
+                if not batch_flags & BATCH_OLDEST:
+                    continue
+                print("# %d records overwritten before seq %d" % (first_seq - next_seq, first_seq),
+                      file=sys.stderr)
+                next_seq = first_seq
+            for i, record in enumerate(records):
+                if first_seq + i >= next_seq:
+                    print(record_row(first_seq + i, *record), flush=True)
+            next_seq = max(next_seq, first_seq + len(records))
+            continue
+        if version in VERSIONS and ftype == TYPE_SAMPLE and len(payload) == SAMPLE.size:
+            seq = SAMPLE.unpack(payload)[1]
+            if last_seq is not None and seq != (last_seq + 1) & 0xFFFF:
+                print("# %d samples missing before seq %d" % ((seq - last_seq - 1) & 0xFFFF, seq),
+                      file=sys.stderr)
+            last_seq = seq
+        print(describe(payload), flush=True)
+    print("# %d frames, %d dropped" % (good, bad), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
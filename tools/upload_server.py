@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""
+Local stand-in for the Firebase Realtime Database REST API used by the ESP.
+
+Keeps the database as one JSON tree in memory and answers the requests the
+ESP sends, over plain HTTP with keep-alive, so the upload queue can be
+tested without a Firebase project (set UPLOAD_TLS 0 and UPLOAD_HOST in
+GenX_ESP8266_Final.ino to this machine):
+
+    PATCH /<path>.json   multi-path update, keys may contain "/"
+    PUT   /<path>.json   replace the node
+    GET   /<path>.json   read the node
+    ?print=silent        answer 204 without echoing the data
+
+Faults can be injected to exercise the retry path:
+
+    python3 tools/upload_server.py --port 8080 --delay 0.3 --fail 0.1 --drop 0.05
+"""
+
+import argparse
+import json
+import random
+import sys
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlsplit
+
+
+class Database:
+    def __init__(self):
+        self.root = {}
+
+    @staticmethod
+    def split(path):
+        return [part for part in path.strip("/").split("/") if part]
+
+    def get(self, path):
+        node = self.root
+        for key in self.split(path):
+            if not isinstance(node, dict) or key not in node:
+                return None
+            node = node[key]
+        return node
+
+    def set(self, path, value):
+        keys = self.split(path)
+        if not keys:
+            self.root = value if isinstance(value, dict) else {}
+            return
+        node = self.root
+        for key in keys[:-1]:
+            if not isinstance(node.get(key), dict):
+                node[key] = {}
+            node = node[key]
+        if value is None:
+            node.pop(keys[-1], None)
+        else:
+            node[keys[-1]] = value
+
+    def update(self, path, values):
+        for key, value in values.items():
+            self.set(path.rstrip("/") + "/" + key, value)
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # keep-alive, as the ESP reuses its connection
+    server_version = "upload_server"
+
+    def log_message(self, fmt, *args):
+        pass
+
+    def reply(self, status, body=None):
+        data = b"" if body is None else json.dumps(body).encode()
+        self.send_response(status)
+        if data:
+            self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+
+    def request_path(self):
+        url = urlsplit(self.path)
+        path = url.path[:-len(".json")] if url.path.endswith(".json") else url.path
+        return path, parse_qs(url.query)
+
+    def fault(self, query):
+        """Answer with an injected fault instead of the request, True if so."""
+        opts = self.server.opts
+        if opts.auth and query.get("auth", [""])[0] != opts.auth:
+            self.reply(401, {"error": "Permission denied"})
+            return True
+        time.sleep(opts.delay)
+        if random.random() < opts.drop:
+            self.close_connection = True  # no answer: the client must time out or see the close
+            self.server.stats["dropped"] += 1
+            return True
+        if random.random() < opts.fail:
+            self.reply(500, {"error": "injected failure"})
+            self.server.stats["failed"] += 1
+            return True
+        return False
+
+    def write(self, method):
+        path, query = self.request_path()
+        start = time.monotonic()
+        body = self.rfile.read(int(self.headers.get("Content-Length", 0)))
+        if self.fault(query):
+            return
+        try:
+            value = json.loads(body)
+        except ValueError as e:
+            self.reply(400, {"error": "Invalid data; %s" % e})
+            return
+        if method == "PATCH":
+            if not isinstance(value, dict):
+                self.reply(400, {"error": "Invalid data; PATCH needs an object"})
+                return
+            self.server.db.update(path, value)
+        else:
+            self.server.db.set(path, value)
+
+        stats = self.server.stats
+        stats["requests"] += 1
+        stats["bytes"] += len(body)
+        keys = len(value) if isinstance(value, dict) else 1
+        print("%s %s %d keys %d bytes %.0f ms" % (
+            method, path or "/", keys, len(body), (time.monotonic() - start) * 1000), flush=True)
+        if query.get("print", [""])[0] == "silent":
+            self.reply(204)
+        else:
+            self.reply(200, value)
+        if self.server.opts.dump:
+            with open(self.server.opts.dump, "w") as f:
+                json.dump(self.server.db.root, f, indent=1, sort_keys=True)
+
+    def do_PATCH(self):
+        self.write("PATCH")
+
+    def do_PUT(self):
+        self.write("PUT")
+
+    def do_GET(self):
+        path, _ = self.request_path()
+        self.reply(200, self.server.db.get(path))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("-p", "--port", type=int, default=8080)
+    parser.add_argument("--auth", help="required ?auth= value (FIREBASE_SECRET)")
+    parser.add_argument("--delay", type=float, default=0.0, help="seconds before answering")
+    parser.add_argument("--fail", type=float, default=0.0, help="probability of a 500 answer")
+    parser.add_argument("--drop", type=float, default=0.0, help="probability of closing without an answer")
+    parser.add_argument("--dump", help="write the database to this JSON file after every write")
+    args = parser.parse_args()
+
+    server = ThreadingHTTPServer((args.host, args.port), Handler)
+    server.opts = args
+    server.db = Database()
+    server.stats = {"requests": 0, "bytes": 0, "failed": 0, "dropped": 0}
+    print("listening on %s:%d" % (args.host, args.port), file=sys.stderr)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    print("# %(requests)d writes, %(bytes)d bytes, %(failed)d failed, %(dropped)d dropped" % server.stats,
+          file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()